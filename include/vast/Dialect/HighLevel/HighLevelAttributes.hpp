@@ -18,3 +18,28 @@ VAST_UNRELAX_WARNINGS
 
 #define GET_ATTRDEF_CLASSES
 #include "vast/Dialect/HighLevel/HighLevelAttributes.h.inc"
+
+namespace vast::hl
+{
+    // Qualifiers do not survive type lowering, the ones relevant to the llvm
+    // lowering are kept on the operations as unit attributes.
+    constexpr llvm::StringLiteral volatile_attr_name = "hl.volatile";
+    constexpr llvm::StringLiteral const_attr_name = "hl.const";
+
+    // Loop pragmas (`#pragma clang loop`, `#pragma unroll`) attached to loop
+    // operations as a dictionary keyed by the clang option name.
+    constexpr llvm::StringLiteral loop_hints_attr_name = "hl.loop_hints";
+
+    // Expected weights of the taken and not taken edge of a conditional
+    // operation derived from `[[likely]]`, `[[unlikely]]` or `__builtin_expect`,
+    // or measured by a profile. Weights of `hl.switch` start with the default
+    // destination, followed by cases in the order of their appearance.
+    constexpr llvm::StringLiteral branch_weights_attr_name = "hl.branch_weights";
+
+    // Number of calls of a function measured by a profile.
+    constexpr llvm::StringLiteral entry_count_attr_name = "hl.entry_count";
+
+    constexpr std::uint32_t likely_branch_weight   = 2000;
+    constexpr std::uint32_t unlikely_branch_weight = 1;
+
+} // namespace vast::hl
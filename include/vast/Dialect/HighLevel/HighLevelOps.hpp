@@ -10,6 +10,7 @@
 
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Interfaces/InferTypeOpInterface.h>
+#include <mlir/Interfaces/LoopLikeInterface.h>
 
 namespace vast::hl
 {
@@ -82,3 +83,15 @@ namespace vast::hl
 
 #define GET_OP_CLASSES
 #include "vast/Dialect/HighLevel/HighLevel.h.inc"
+
+namespace vast::hl
+{
+    // Returns the loop or the switch that is left by `hl.break` or continued
+    // by `hl.continue`.
+    mlir::Operation *jump_target(mlir::Operation *jump);
+
+    // Returns the constant value of the case label extended or truncated to
+    // `width` bits, if it is known.
+    std::optional< llvm::APInt > case_value(CaseOp op, unsigned width);
+
+} // namespace vast::hl
@@ -127,6 +127,12 @@ namespace vast::hl
 
     using generic_types = util::type_list< LValueType, PointerType >;
 
+    using qualified_types = util::concat<
+        scalar_types, util::type_list<
+            VoidType, PointerType, ArrayType, RecordType, EnumType, TypedefType, ElaboratedType
+        >
+    >;
+
     /* integer types */
     enum class IntegerKind { Char, Short, Int, Long, LongLong, Int128 };
 
@@ -169,6 +175,10 @@ namespace vast::hl
 
     bool isHighLevelType(mlir::Type type);
 
+    bool isConstQualified(mlir::Type type);
+    bool isVolatileQualified(mlir::Type type);
+    bool isRestrictQualified(mlir::Type type);
+
     static inline mlir::Type to_std_float_type(mlir::Type ty) {
         using fty = mlir::FloatType;
         auto ctx = ty.getContext();
@@ -25,6 +25,22 @@ namespace vast::hl
 
     std::unique_ptr< mlir::Pass > createHLToSCFPass();
 
+    std::unique_ptr< mlir::Pass > createHLToCFPass();
+
+    std::unique_ptr< mlir::Pass > createHLToAffinePass();
+
+    std::unique_ptr< mlir::Pass > createHLVectorizePass();
+
+    std::unique_ptr< mlir::Pass > createHLLICMPass();
+
+    std::unique_ptr< mlir::Pass > createHLInlinePass();
+
+    std::unique_ptr< mlir::Pass > createHLSCCPPass();
+
+    std::unique_ptr< mlir::Pass > createHLProfileAnnotatePass();
+
+    std::unique_ptr< mlir::Pass > createHLInstrumentPass();
+
     std::unique_ptr< mlir::Pass > createLLVMDumpPass();
 
     std::unique_ptr< mlir::Pass > createExportFnInfoPass();
@@ -0,0 +1,25 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#ifndef VAST_RUNTIME_PROFILE_H
+#define VAST_RUNTIME_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Writes counters of a module instrumented by `vast-hl-instrument` as a text
+// instrumentation profile, which can be merged by `llvm-profdata` and read by
+// `vast-hl-profile-annotate`.
+//
+// `counters` and `names` are the `<prefix>_counters` and `<prefix>_names`
+// globals of the module. If `path` is null, the profile is written to the file
+// given by the `VAST_PROFILE_FILE` environment variable, or `default.proftext`.
+//
+// Returns zero on success.
+int __vast_prof_write(const char *path, const unsigned long long *counters, const char *names);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // VAST_RUNTIME_PROFILE_H
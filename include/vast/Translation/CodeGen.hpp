@@ -13,6 +13,9 @@ VAST_RELAX_WARNINGS
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/MLIRContext.h>
 #include <mlir/InitAllDialects.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/MemoryBuffer.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
@@ -26,6 +29,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Translation/DataLayout.hpp"
 #include "vast/Translation/CodeGenMeta.hpp"
+#include "vast/Translation/CodeGenStreamer.hpp"
 
 namespace vast::hl
 {
@@ -49,9 +53,10 @@ namespace vast::hl
     struct CodeGenBase
     {
         using MetaGenerator = typename CodeGenVisitor::MetaGeneratorType;
+        using Profiler      = typename CodeGenVisitor::ProfilerType;
 
-        CodeGenBase(MContext *mctx, MetaGenerator &meta)
-            : _mctx(mctx), _meta(meta), _cgctx(nullptr), _module(nullptr)
+        CodeGenBase(MContext *mctx, MetaGenerator &meta, Profiler &profiler)
+            : _mctx(mctx), _meta(meta), _profiler(profiler), _cgctx(nullptr), _module(nullptr)
         {
             detail::codegen_context_setup(*_mctx);
         }
@@ -66,6 +71,58 @@ namespace vast::hl
             return freeze();
         }
 
+        //
+        // Prints the module to `os` while it is emitted, so that it never
+        // holds bodies of all functions at once. The header of the module
+        // depends on the data layout of the whole unit, hence the printed
+        // body is buffered in a temporary file until the end.
+        //
+        LogicalResult emit_module_streamed(clang::ASTUnit *unit, llvm::raw_ostream &os) {
+            mlir::OpPrintingFlags flags;
+            // Locations would be printed as aliases local to each operation.
+            if (flags.shouldPrintDebugInfo()) {
+                llvm::errs() << "error: streamed module cannot be printed with debug info\n";
+                return mlir::failure();
+            }
+            flags.useLocalScope();
+
+            int fd;
+            llvm::SmallString< 128 > path;
+            if (auto ec = llvm::sys::fs::createTemporaryFile("vast-stream", "mlir", fd, path)) {
+                llvm::errs() << "error: unable to create temporary file: " << ec.message() << "\n";
+                return mlir::failure();
+            }
+            llvm::FileRemover remover(path);
+
+            {
+                llvm::raw_fd_ostream body(fd, /* shouldClose */ true);
+                CodeGenStreamer streamer(body, flags);
+
+                setup_codegen(unit->getASTContext());
+                StreamingContext sctx{ *_visitor, streamer, *_cgctx, mlir::success() };
+                visit_root_decls(unit, &sctx, process_streamed_root_decl);
+
+                if (mlir::failed(sctx.result) || mlir::failed(streamer.flush(*_cgctx)))
+                    return mlir::failure();
+            }
+
+            auto printed = llvm::MemoryBuffer::getFile(path);
+            if (!printed) {
+                llvm::errs() << "error: unable to read temporary file: " << printed.getError().message() << "\n";
+                return mlir::failure();
+            }
+
+            auto mod = freeze();
+            CodeGenStreamer::finish(mod.get(), printed.get()->getBuffer(), os);
+            return mlir::success();
+        }
+
+        // Emits the definition of the function as a declaration, takes
+        // effect only if called before the first emitted declaration.
+        void emit_as_declaration(const clang::FunctionDecl *decl) {
+            _declared_only.insert(decl);
+        }
+
         void append_to_module(clang::ASTUnit *unit) { append_impl(unit); }
 
         void append_to_module(clang::Decl *decl) { append_impl(decl); }
@@ -110,6 +167,7 @@ namespace vast::hl
             _module = { Module::create(mlir::UnknownLoc::get(_mctx)) };
 
             _cgctx = std::make_unique< CodeGenContext >(*_mctx, actx, _module);
+            _cgctx->declared_only = std::move(_declared_only);
 
             _scope = std::unique_ptr< CodegenScope >( new CodegenScope{
                 .typedefs   = _cgctx->typedefs,
@@ -120,7 +178,7 @@ namespace vast::hl
                 .globs      = _cgctx->vars
             });
 
-            _visitor = std::make_unique< CodeGenVisitor >(*_cgctx, _meta);
+            _visitor = std::make_unique< CodeGenVisitor >(*_cgctx, _meta, _profiler);
         }
 
         template< typename AST >
@@ -131,24 +189,65 @@ namespace vast::hl
 
         static bool process_root_decl(void * context, const clang::Decl *decl) {
             CodeGenVisitor &visitor = *static_cast<CodeGenVisitor*>(context);
-            return visitor.Visit(decl), true;
+            return visit_root_decl(visitor, decl), true;
+        }
+
+        static void visit_root_decl(CodeGenVisitor &visitor, const clang::Decl *decl) {
+            auto top_level = visitor.profiler.profile_top_level(decl);
+            auto scope     = visitor.profiler.profile(decl);
+            visitor.Visit(decl);
+        }
+
+        struct StreamingContext {
+            CodeGenVisitor &visitor;
+            CodeGenStreamer &streamer;
+            CodeGenContext &cgctx;
+            LogicalResult result;
+        };
+
+        static bool process_streamed_root_decl(void * context, const clang::Decl *decl) {
+            auto &sctx = *static_cast< StreamingContext * >(context);
+            visit_root_decl(sctx.visitor, decl);
+            sctx.result = sctx.streamer.stream(sctx.cgctx);
+            return mlir::succeeded(sctx.result);
+        }
+
+        // Declarations of a precompiled preamble are not local to the unit,
+        // hence units with an external source are visited in the lexical
+        // order of all their declarations.
+        static void visit_root_decls(
+            clang::ASTUnit *unit, void *context, clang::ASTUnit::DeclVisitorFn fn
+        ) {
+            auto &actx = unit->getASTContext();
+            if (!actx.getExternalSource()) {
+                unit->visitLocalTopLevelDecls(context, fn);
+                return;
+            }
+
+            for (auto decl : actx.getTranslationUnitDecl()->decls()) {
+                if (!decl->isImplicit() && !fn(context, decl))
+                    return;
+            }
         }
 
         void process(clang::ASTUnit *unit, CodeGenVisitor &visitor) {
-            unit->visitLocalTopLevelDecls(&visitor, process_root_decl);
+            visit_root_decls(unit, &visitor, process_root_decl);
         }
 
         void process(clang::Decl *decl, CodeGenVisitor &visitor) {
-            visitor.Visit(decl);
+            visit_root_decl(visitor, decl);
         }
 
         MContext *_mctx;
         MetaGenerator &_meta;
+        Profiler &_profiler;
 
         std::unique_ptr< CodeGenContext > _cgctx;
         std::unique_ptr< CodegenScope >   _scope;
         std::unique_ptr< CodeGenVisitor > _visitor;
 
+        llvm::DenseSet< const clang::FunctionDecl * > _declared_only;
+
         OwningModuleRef _module;
     };
 
@@ -162,21 +261,23 @@ namespace vast::hl
     // DefaultCodeGen
     //
     // Uses `DefaultMetaGenerator` and `DefaultCodeGenVisitorMixin`
-    // with `DefaultFallBack` for the generation.
+    // with `DefaultFallBack` for the generation. The codegen is not profiled
+    // unless `CodeGenProfiler` is given.
     //
     template<
         template< typename >
         typename VisitorConfig = DefaultCodeGenVisitorConfig,
-        typename MetaGenerator = DefaultMetaGenerator
+        typename MetaGenerator = DefaultMetaGenerator,
+        typename Profiler = NoProfiler
     >
     struct DefaultCodeGen
     {
-        using Visitor = CodeGenVisitor< VisitorConfig, MetaGenerator >;
+        using Visitor = CodeGenVisitor< VisitorConfig, MetaGenerator, Profiler >;
 
         using Base = CodeGenBase< Visitor >;
 
         DefaultCodeGen(AContext *actx, MContext *mctx)
-            : meta(actx, mctx), codegen(mctx, meta)
+            : meta(actx, mctx), codegen(mctx, meta, profiler)
         {}
 
         OwningModuleRef emit_module(clang::ASTUnit *unit) {
@@ -187,7 +288,16 @@ namespace vast::hl
             return codegen.emit_module(decl);
         }
 
+        LogicalResult emit_module_streamed(clang::ASTUnit *unit, llvm::raw_ostream &os) {
+            return codegen.emit_module_streamed(unit, os);
+        }
+
+        void emit_as_declaration(const clang::FunctionDecl *decl) {
+            codegen.emit_as_declaration(decl);
+        }
+
         MetaGenerator meta;
+        Profiler profiler;
         CodeGenBase< Visitor > codegen;
     };
 
@@ -6,6 +6,7 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
+#include <llvm/ADT/DenseSet.h>
 #include <llvm/ADT/ScopedHashTable.h>
 #include <mlir/IR/MLIRContext.h>
 #include <mlir/IR/Value.h>
@@ -58,6 +59,14 @@ namespace vast::hl
         using LabelTable = ScopedValueTable< const clang::LabelDecl*, LabelDeclOp >;
         LabelTable labels;
 
+        // Functions whose bodies were printed by the streamed codegen and
+        // released, they are not emitted again.
+        llvm::DenseSet< Operation * > released;
+
+        // Function definitions emitted as declarations, e.g., unchanged
+        // functions of a unit whose module is updated incrementally.
+        llvm::DenseSet< const clang::FunctionDecl * > declared_only;
+
         size_t anonymous_count = 0;
         llvm::DenseMap< const clang::TagDecl *, std::string > tag_names;
 
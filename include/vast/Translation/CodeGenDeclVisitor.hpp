@@ -134,15 +134,17 @@ namespace vast::hl {
                 auto type = visit(decl->getFunctionType()).template cast< mlir::FunctionType >();
                 // make function header, that will be later filled with function body
                 // or returned as declaration in the case of external function
-                return make< mlir::func::FuncOp >(loc, decl->getName(), type);
+                auto fn = make< mlir::func::FuncOp >(loc, decl->getName(), type);
+                attach_attributes(decl /* from */, fn /* to */);
+                return fn;
             });
 
-            if (!is_definition) {
+            if (!is_definition || context().declared_only.contains(decl)) {
                 fn.setVisibility( mlir::func::FuncOp::Visibility::Private );
                 return fn;
             }
 
-            if (fn.empty()) {
+            if (fn.empty() && !context().released.contains(fn)) {
                 emit_function_body(fn);
             }
 
@@ -203,6 +205,8 @@ namespace vast::hl {
                     var.setThreadStorageClass(tsc);
                 }
 
+                attach_attributes(decl /* from */, var /* to */);
+
                 return var;
             }).getDefiningOp();
         }
@@ -243,25 +247,49 @@ namespace vast::hl {
             }
         }
 
-        static inline std::string parse_annotation(AContext &ctx, const clang::Attr *attr) {
-            // Clang does not provide a nicer interface :(
-            std::string buff; llvm::raw_string_ostream stream(buff);
-            auto policy = ctx.getPrintingPolicy();
-            attr->printPretty(stream, policy);
-            llvm::StringRef ref(buff);
-            ref.consume_front(" __attribute__((annotate(\"");
-            ref.consume_back("\")))");
-            return ref.str();
+        template< typename Attr, typename... Args >
+        void attach(auto &to, Args &&...args) {
+            to->setAttr(Attr::getMnemonic(), Attr::get(&mcontext(), std::forward< Args >(args)...));
         }
 
         void attach_attributes(const clang::Decl *from, auto &to) {
             if (!from->hasAttrs())
                 return;
 
-            auto &actx = acontext();
+            llvm::SmallVector< mlir::Attribute, 2 > annotations;
             for (auto attr: from->getAttrs()) {
-                auto annot = mlir::StringAttr::get(to->getContext(), parse_annotation(actx, attr));
-                to->setAttr("annotation", AnnotationAttr::get(annot));
+                switch (attr->getKind()) {
+                    case clang::attr::Annotate: {
+                        auto annot = clang::cast< clang::AnnotateAttr >(attr)->getAnnotation();
+                        annotations.push_back(AnnotationAttr::get(&mcontext(), annot));
+                        break;
+                    }
+                    case clang::attr::AlwaysInline: attach< AlwaysInlineAttr >(to); break;
+                    case clang::attr::NoInline:     attach< NoInlineAttr >(to); break;
+                    case clang::attr::Hot:          attach< HotAttr >(to); break;
+                    case clang::attr::Cold:         attach< ColdAttr >(to); break;
+                    case clang::attr::NoReturn:
+                    case clang::attr::C11NoReturn:  attach< NoReturnAttr >(to); break;
+                    case clang::attr::Pure:         attach< PureAttr >(to); break;
+                    case clang::attr::Const:        attach< ConstAttr >(to); break;
+                    case clang::attr::Section: {
+                        auto name = clang::cast< clang::SectionAttr >(attr)->getName();
+                        attach< SectionAttr >(to, name);
+                        break;
+                    }
+                    default: break;
+                }
+            }
+
+            // the strictest of the `aligned` attributes wins
+            if (auto align = from->getMaxAlignment()) {
+                attach< AlignedAttr >(to, acontext().toCharUnitsFromBits(align).getQuantity());
+            }
+
+            if (annotations.size() == 1) {
+                to->setAttr(AnnotationAttr::getMnemonic(), annotations.front());
+            } else if (!annotations.empty()) {
+                to->setAttr(AnnotationAttr::getMnemonic(), mlir::ArrayAttr::get(&mcontext(), annotations));
             }
         }
 
@@ -0,0 +1,173 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/Decl.h>
+#include <clang/AST/Stmt.h>
+#include <clang/AST/Type.h>
+#include <mlir/IR/Builders.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/Allocator.h>
+#include <llvm/Support/StringSaver.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // NoProfiler
+    //
+    // Default profiling policy of the codegen, all of its hooks are empty and
+    // are optimized away.
+    //
+    struct NoProfiler {
+        static constexpr bool enabled = false;
+
+        struct scope {};
+
+        scope profile(const auto &) { return {}; }
+        scope profile_top_level(const clang::Decl *) { return {}; }
+    };
+
+    //
+    // CodeGenProfiler
+    //
+    // Records wall time and the number of emitted operations per visited
+    // clang node class and per top-level declaration. Time and operations of
+    // a node exclude its nested nodes, top-level declarations include them.
+    //
+    // Operations are counted by listening to the builder of the codegen,
+    // and are attributed to the innermost visited node.
+    //
+    struct CodeGenProfiler : mlir::OpBuilder::Listener {
+        static constexpr bool enabled = true;
+
+        using clock      = std::chrono::steady_clock;
+        using time_point = clock::time_point;
+        using duration   = clock::duration;
+
+        struct node_stats {
+            uint64_t count = 0;
+            duration time  = {};
+            uint64_t ops   = 0;
+        };
+
+        struct decl_stats {
+            std::string name;
+            duration time;
+            uint64_t ops;
+        };
+
+        struct phase_stats {
+            std::string name;
+            duration time;
+        };
+
+        struct trace_event {
+            std::string name;
+            llvm::StringRef category;
+            time_point start;
+            duration time;
+            uint64_t ops;
+        };
+
+        struct frame {
+            time_point start;
+            duration nested_time = {};
+            uint64_t ops = 0;
+            uint64_t nested_ops = 0;
+        };
+
+        //
+        // scope
+        //
+        // Measures a single visit of a node from its construction to
+        // destruction.
+        //
+        struct scope {
+            scope(CodeGenProfiler &profiler, llvm::StringRef name, llvm::StringRef category)
+                : profiler(&profiler), name(name), category(category)
+            {
+                profiler.frames.push_back({ clock::now() });
+            }
+
+            scope(scope &&other)
+                : profiler(std::exchange(other.profiler, nullptr))
+                , name(other.name), category(other.category)
+            {}
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+            scope &operator=(scope &&) = delete;
+
+            ~scope() {
+                if (profiler)
+                    profiler->leave(name, category);
+            }
+
+            CodeGenProfiler *profiler;
+            llvm::StringRef name;
+            llvm::StringRef category;
+        };
+
+        scope profile(const clang::Stmt *stmt) {
+            return { *this, stmt->getStmtClassName(), "stmt" };
+        }
+
+        scope profile(const clang::Decl *decl) {
+            return { *this, decl->getDeclKindName(), "decl" };
+        }
+
+        scope profile(const clang::Type *type) {
+            return { *this, type->getTypeClassName(), "type" };
+        }
+
+        scope profile(clang::QualType type) {
+            return { *this, type.isNull() ? "Null" : type->getTypeClassName(), "type" };
+        }
+
+        scope profile_top_level(const clang::Decl *decl) {
+            auto named = clang::dyn_cast< clang::NamedDecl >(decl);
+            auto name  = named ? names.save(named->getNameAsString()) : decl->getDeclKindName();
+            return { *this, name, "top-level" };
+        }
+
+        // Records a phase outside of the codegen, e.g., parsing of the source.
+        void record_phase(llvm::StringRef name, time_point start, time_point end);
+
+        void notifyOperationInserted(Operation *) override {
+            if (!frames.empty())
+                ++frames.back().ops;
+        }
+
+        // Prints tables of phases, node classes and top-level declarations
+        // sorted by their time.
+        void print_summary(llvm::raw_ostream &os) const;
+
+        // Writes chrome `trace_event` json, which can be loaded by
+        // `chrome://tracing` or perfetto.
+        void write_trace(llvm::raw_ostream &os) const;
+
+        llvm::StringMap< node_stats > nodes;
+        std::vector< decl_stats > decls;
+        std::vector< phase_stats > phases;
+        std::vector< trace_event > events;
+
+      private:
+        void leave(llvm::StringRef name, llvm::StringRef category);
+
+        llvm::SmallVector< frame > frames;
+        llvm::BumpPtrAllocator allocator;
+        llvm::StringSaver names{ allocator };
+    };
+
+} // namespace vast::hl
@@ -5,14 +5,21 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <clang/AST/Attr.h>
 #include <clang/AST/StmtVisitor.h>
+#include <clang/Basic/Builtins.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallVector.h>
 VAST_UNRELAX_WARNINGS
 
+#include <utility>
+
 #include "vast/Translation/CodeGenMeta.hpp"
 #include "vast/Translation/CodeGenBuilder.hpp"
 #include "vast/Translation/CodeGenVisitorBase.hpp"
 #include "vast/Translation/CodeGenVisitorLens.hpp"
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 
@@ -31,6 +38,7 @@ namespace vast::hl {
         using LensType::derived;
         using LensType::context;
         using LensType::mcontext;
+        using LensType::acontext;
 
         using LensType::meta_location;
 
@@ -69,9 +77,52 @@ namespace vast::hl {
         // Binary Operations
         //
 
+        // Binary operators that are emitted by this mixin, i.e., their left
+        // operand is emitted first by `visit_lhs`.
+        static bool chained(const clang::BinaryOperator *op) {
+            switch (op->getOpcode()) {
+                case clang::BO_PtrMemD:
+                case clang::BO_PtrMemI:
+                case clang::BO_Cmp:
+                    return false;
+                default:
+                    return true;
+            }
+        }
+
+        //
+        // Emits the left operand of a binary operator. Left-deep chains of
+        // operators, e.g., `a + b + c + ...`, are emitted iteratively from
+        // the innermost operand, so that the recursion does not grow with
+        // the length of the chain. Every operator of the chain is still
+        // visited through the lens with its left operand already emitted.
+        //
+        Value visit_lhs(const clang::BinaryOperator *op) {
+            auto lhs = op->getLHS();
+            if (emitted_lhs.first == lhs) {
+                return std::exchange(emitted_lhs, {}).second;
+            }
+
+            llvm::SmallVector< const clang::BinaryOperator *, 8 > chain;
+            const clang::Expr *leaf = lhs;
+            while (auto bin = clang::dyn_cast< clang::BinaryOperator >(leaf)) {
+                if (!chained(bin))
+                    break;
+                chain.push_back(bin);
+                leaf = bin->getLHS();
+            }
+
+            auto result = visit(leaf)->getResult(0);
+            for (auto bin : llvm::reverse(chain)) {
+                emitted_lhs = { bin->getLHS(), result };
+                result = visit(bin)->getResult(0);
+            }
+            return result;
+        }
+
         template< typename Op >
         Operation* VisitBinOp(const clang::BinaryOperator *op) {
-            auto lhs = visit(op->getLHS())->getResult(0);
+            auto lhs = visit_lhs(op);
             auto rhs = visit(op->getRHS())->getResult(0);
             return make< Op >(meta_location(op), lhs, rhs);
         }
@@ -88,7 +139,7 @@ namespace vast::hl {
 
         template< Predicate pred >
         Operation* VisitCmp(const clang::BinaryOperator *op) {
-            auto lhs = visit(op->getLHS())->getResult(0);
+            auto lhs = visit_lhs(op);
             auto rhs = visit(op->getRHS())->getResult(0);
             auto res = visit(op->getType());
             return make< CmpOp >(meta_location(op), res, pred, lhs, rhs);
@@ -172,14 +223,14 @@ namespace vast::hl {
         }
 
         Operation* VisitBinLAnd(const clang::BinaryOperator *op) {
-            auto lhs = visit(op->getLHS())->getResult(0);
+            auto lhs = visit_lhs(op);
             auto rhs = visit(op->getRHS())->getResult(0);
             auto ty  = visit(op->getType());
             return make< BinLAndOp >(meta_location(op), ty, lhs, rhs);
         }
 
         Operation* VisitBinLOr(const clang::BinaryOperator *op) {
-            auto lhs = visit(op->getLHS())->getResult(0);
+            auto lhs = visit_lhs(op);
             auto rhs = visit(op->getRHS())->getResult(0);
             auto ty  = visit(op->getType());
             return make< BinLOrOp >(meta_location(op), ty, lhs, rhs);
@@ -234,7 +285,7 @@ namespace vast::hl {
         }
 
         Operation* VisitBinComma(const clang::BinaryOperator *op) {
-            auto lhs = visit(op->getLHS())->getResult(0);
+            auto lhs = visit_lhs(op);
             auto rhs = visit(op->getRHS())->getResult(0);
             auto ty  = visit(op->getType());
             return make< BinComma >(meta_location(op), ty, lhs, rhs);
@@ -324,7 +375,114 @@ namespace vast::hl {
         // Operation* VisitCoyieldExpr(const clang::CoyieldExpr *expr)
         // Operation* VisitDependentCoawaitExpr(const clang::DependentCoawaitExpr *expr)
 
-        // Operation* VisitAttributedStmt(const clang::AttributedStmt *stmt)
+        //
+        // Attributed Statements
+        //
+
+        static mlir::StringRef loop_hint_state(const clang::LoopHintAttr *hint) {
+            switch (hint->getState()) {
+                case clang::LoopHintAttr::Enable:        return "enable";
+                case clang::LoopHintAttr::Disable:       return "disable";
+                case clang::LoopHintAttr::Full:          return "full";
+                case clang::LoopHintAttr::AssumeSafety:  return "assume_safety";
+                case clang::LoopHintAttr::FixedWidth:    return "fixed";
+                case clang::LoopHintAttr::ScalableWidth: return "scalable";
+                case clang::LoopHintAttr::Numeric:       break;
+            }
+            VAST_UNREACHABLE("unexpected loop hint state");
+        }
+
+        mlir::DictionaryAttr make_loop_hints(llvm::ArrayRef< const clang::Attr * > attrs) {
+            auto &bld = op_builder();
+
+            mlir::NamedAttrList hints;
+            for (auto attr : attrs) {
+                auto hint = clang::dyn_cast< clang::LoopHintAttr >(attr);
+                if (!hint)
+                    continue;
+
+                auto name = clang::LoopHintAttr::getOptionName(hint->getOption());
+                if (auto value = hint->getValue()) {
+                    auto count = value->EvaluateKnownConstInt(acontext());
+                    hints.set(name, bld.getI32IntegerAttr(count.getExtValue()));
+                    // `vectorize_width(N, scalable)`
+                    if (hint->getState() == clang::LoopHintAttr::ScalableWidth)
+                        hints.set("vectorize_scalable", bld.getStringAttr("enable"));
+                } else {
+                    hints.set(name, bld.getStringAttr(loop_hint_state(hint)));
+                }
+            }
+
+            if (hints.empty())
+                return {};
+            return hints.getDictionary(&mcontext());
+        }
+
+        // Loops with an init statement are wrapped in a scope.
+        static Operation* hinted_loop(Operation *op) {
+            if (!op)
+                return nullptr;
+            if (mlir::isa< ForOp, WhileOp, DoOp >(op))
+                return op;
+            if (auto scope = mlir::dyn_cast< ScopeOp >(op)) {
+                auto &body = scope.getBody();
+                if (!body.empty() && !body.back().empty())
+                    return hinted_loop(&body.back().back());
+            }
+            return nullptr;
+        }
+
+        Operation* VisitAttributedStmt(const clang::AttributedStmt *stmt) {
+            auto op = visit(stmt->getSubStmt());
+            if (auto hints = make_loop_hints(stmt->getAttrs())) {
+                if (auto loop = hinted_loop(op))
+                    loop->setAttr(loop_hints_attr_name, hints);
+            }
+            return op;
+        }
+
+        //
+        // Branch Hints
+        //
+
+        // Expected value of condition of form `__builtin_expect(cond, value)`.
+        std::optional< bool > expected_value(const clang::Expr *cond) {
+            auto call = clang::dyn_cast< clang::CallExpr >(cond->IgnoreParenImpCasts());
+            if (!call || call->getBuiltinCallee() != clang::Builtin::BI__builtin_expect)
+                return std::nullopt;
+
+            clang::Expr::EvalResult result;
+            if (!call->getArg(1)->EvaluateAsInt(result, acontext()))
+                return std::nullopt;
+            return result.Val.getInt().getBoolValue();
+        }
+
+        // Returns whether the edge guarded by `cond` is expected to be taken.
+        std::optional< bool > expected_branch(const clang::Expr *cond, clang::Stmt::Likelihood lh) {
+            switch (lh) {
+                case clang::Stmt::LH_Likely:   return true;
+                case clang::Stmt::LH_Unlikely: return false;
+                case clang::Stmt::LH_None:     return expected_value(cond);
+            }
+            VAST_UNREACHABLE("unexpected branch likelihood");
+        }
+
+        void attach_branch_weights(Operation *op, std::optional< bool > taken) {
+            if (!taken)
+                return;
+
+            auto likely   = int32_t(likely_branch_weight);
+            auto unlikely = int32_t(unlikely_branch_weight);
+            auto weights  = *taken
+                ? llvm::SmallVector< int32_t, 2 >{ likely, unlikely }
+                : llvm::SmallVector< int32_t, 2 >{ unlikely, likely };
+            op->setAttr(branch_weights_attr_name, op_builder().getI32ArrayAttr(weights));
+        }
+
+        void attach_loop_branch_weights(Operation *op, const clang::Expr *cond, const clang::Stmt *body) {
+            if (cond)
+                attach_branch_weights(op, expected_branch(cond, clang::Stmt::getLikelihood(body)));
+        }
 
         //
         // Cast Operations
@@ -587,13 +745,17 @@ namespace vast::hl {
         Operation* VisitDoStmt(const clang::DoStmt *stmt) {
             auto cond_builder = make_cond_builder(stmt->getCond());
             auto body_builder = make_region_builder(stmt->getBody());
-            return make< DoOp >(meta_location(stmt), body_builder, cond_builder);
+            auto op = make< DoOp >(meta_location(stmt), body_builder, cond_builder);
+            attach_loop_branch_weights(op, stmt->getCond(), stmt->getBody());
+            return op;
         }
 
         Operation* VisitWhileStmt(const clang::WhileStmt *stmt) {
             auto cond_builder = make_cond_builder(stmt->getCond());
             auto body_builder = make_region_builder(stmt->getBody());
-            return make< WhileOp >(meta_location(stmt), cond_builder, body_builder);
+            auto op = make< WhileOp >(meta_location(stmt), cond_builder, body_builder);
+            attach_loop_branch_weights(op, stmt->getCond(), stmt->getBody());
+            return op;
         }
 
         // Operation* VisitCXXCatchStmt(const clang::CXXCatchStmt *stmt)
@@ -608,8 +770,11 @@ namespace vast::hl {
             auto make_loop_op = [&] {
                 auto incr = make_region_builder(stmt->getInc());
                 auto body = make_region_builder(stmt->getBody());
-                if (auto cond = stmt->getCond())
-                    return make< ForOp >(loc, make_cond_builder(cond), incr, body);
+                if (auto cond = stmt->getCond()) {
+                    auto op = make< ForOp >(loc, make_cond_builder(cond), incr, body);
+                    attach_loop_branch_weights(op, cond, stmt->getBody());
+                    return op;
+                }
                 return make< ForOp >(loc, make_yield_true(), incr, body);
             };
 
@@ -636,12 +801,16 @@ namespace vast::hl {
         }
 
         Operation* VisitIfStmt(const clang::IfStmt *stmt) {
-            return this->template make_operation< IfOp >()
+            auto op = this->template make_operation< IfOp >()
                 .bind(meta_location(stmt))
                 .bind(make_cond_builder(stmt->getCond()))
                 .bind(make_region_builder(stmt->getThen()))
                 .bind_if(stmt->getElse(), make_region_builder(stmt->getElse()))
                 .freeze();
+
+            auto lh = clang::Stmt::getLikelihood(stmt->getThen(), stmt->getElse());
+            attach_branch_weights(op, expected_branch(stmt->getCond(), lh));
+            return op;
         }
 
         //
@@ -851,6 +1020,9 @@ namespace vast::hl {
 
             return make< InitListExpr >(meta_location(expr), ty, elements);
         }
+
+        // Left operand of the next visited operator of a chain.
+        std::pair< const clang::Expr *, Value > emitted_lhs;
     };
 
 } // namespace vast::hl
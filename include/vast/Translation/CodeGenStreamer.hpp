@@ -0,0 +1,53 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Common.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/OperationSupport.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Translation/CodeGenContext.hpp"
+
+namespace vast::hl
+{
+    //
+    // CodeGenStreamer
+    //
+    // Prints top-level operations of the module as soon as they are emitted
+    // and releases bodies of printed functions. Printed operations are kept
+    // in the module as declarations, so that symbols and tables of the codegen
+    // remain valid.
+    //
+    // Operations are printed as the body of the module, i.e., without its
+    // header, which is printed by `finish` once the data layout is known.
+    //
+    struct CodeGenStreamer {
+        CodeGenStreamer(llvm::raw_ostream &body, mlir::OpPrintingFlags flags)
+            : body(body), flags(flags)
+        {}
+
+        // Prints operations appended to the module since the last call.
+        LogicalResult stream(CodeGenContext &ctx);
+
+        // Prints operations that were inserted before already printed ones.
+        LogicalResult flush(CodeGenContext &ctx);
+
+        // Prints the module header followed by the printed body.
+        static void finish(Module mod, llvm::StringRef printed_body, llvm::raw_ostream &os);
+
+      private:
+        LogicalResult print(CodeGenContext &ctx, Operation *op);
+
+        llvm::raw_ostream &body;
+        mlir::OpPrintingFlags flags;
+
+        Operation *last = nullptr;
+        llvm::DenseSet< Operation * > printed;
+    };
+
+} // namespace vast::hl
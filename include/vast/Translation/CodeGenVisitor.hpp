@@ -9,6 +9,7 @@
 #include "vast/Translation/CodeGenTypeVisitor.hpp"
 #include "vast/Translation/CodeGenVisitorBase.hpp"
 #include "vast/Translation/CodeGenFallBackVisitor.hpp"
+#include "vast/Translation/CodeGenProfiler.hpp"
 
 namespace vast::hl
 {
@@ -40,20 +41,33 @@ namespace vast::hl
     //
     // `MetaGenerator` takes care of attaching location metadata to generated mlir primitives.
     //
-    template< template< typename > class CodeGenVisitorMixin, MetaGeneratorLike MetaGenerator >
+    // `Profiler` measures visits of nodes, `NoProfiler` compiles to nothing.
+    //
+    template<
+        template< typename > class CodeGenVisitorMixin,
+        MetaGeneratorLike MetaGenerator,
+        typename Profiler = NoProfiler
+    >
     struct CodeGenVisitor
-        : CodeGenVisitorMixin< CodeGenVisitor< CodeGenVisitorMixin, MetaGenerator > >
+        : CodeGenVisitorMixin< CodeGenVisitor< CodeGenVisitorMixin, MetaGenerator, Profiler > >
         , CodeGenVisitorBaseWithBuilder< MetaGenerator >
     {
         using BaseType          = CodeGenVisitorBaseWithBuilder< MetaGenerator >;
-        using MixinType         = CodeGenVisitorMixin< CodeGenVisitor< CodeGenVisitorMixin, MetaGenerator > >;
+        using MixinType         = CodeGenVisitorMixin< CodeGenVisitor< CodeGenVisitorMixin, MetaGenerator, Profiler > >;
         using MetaGeneratorType = MetaGenerator;
+        using ProfilerType      = Profiler;
 
-        CodeGenVisitor(CodeGenContext &ctx, MetaGenerator &gen)
-            : BaseType(ctx, gen)
-        {}
+        CodeGenVisitor(CodeGenContext &ctx, MetaGenerator &gen, Profiler &profiler)
+            : BaseType(ctx, gen), profiler(profiler)
+        {
+            if constexpr (Profiler::enabled) {
+                this->_builder.setListener(&profiler);
+            }
+        }
 
         using MixinType::Visit;
+
+        Profiler &profiler;
     };
 
 } // namespace vast::hl
@@ -6,8 +6,11 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/DeclVisitor.h>
+#include <clang/Basic/Stack.h>
 VAST_UNRELAX_WARNINGS
 
+#include <type_traits>
+
 #include "vast/Translation/CodeGenMeta.hpp"
 #include "vast/Translation/CodeGenVisitorBase.hpp"
 #include "vast/Translation/Util.hpp"
@@ -48,8 +51,30 @@ namespace vast::hl {
             return meta_gen().get(token).location();
         }
 
+        //
+        // Every nested node is visited through the lens, hence it is the
+        // single place to measure them with the profiler of the codegen.
+        //
+        // Statements and declarations nest arbitrarily deep, e.g., in
+        // generated code, hence their visit continues on a new stack once
+        // the current one is nearly exhausted. It requires the tool to note
+        // the bottom of the stack by `clang::noteBottomOfStack`.
+        //
         template< typename Token >
-        auto visit(Token token) { return derived().Visit(token); }
+        auto visit(Token token) {
+            auto scope = derived().profiler.profile(token);
+            if constexpr (std::is_convertible_v< Token, const clang::Stmt * >
+                       || std::is_convertible_v< Token, const clang::Decl * >
+            ) {
+                decltype(derived().Visit(token)) result = {};
+                clang::runWithSufficientStackSpace([] {}, [&] {
+                    result = derived().Visit(token);
+                });
+                return result;
+            } else {
+                return derived().Visit(token);
+            }
+        }
 
         template< typename Token >
         Type visit_as_lvalue_type(Token token) { return derived().VisitLValueType(token); }
@@ -0,0 +1,84 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/ASTUnit.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/VirtualFileSystem.h>
+VAST_UNRELAX_WARNINGS
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // CachingFileSystem
+    //
+    // Remembers status and contents of files read through it, so that
+    // translation units of a single process stat and read every header
+    // once. Files are assumed not to change during the process. Files under
+    // `uncached` prefix, e.g., precompiled headers, are passed through.
+    //
+    struct CachingFileSystem : llvm::vfs::ProxyFileSystem {
+        CachingFileSystem(llvm::IntrusiveRefCntPtr< llvm::vfs::FileSystem > fs, std::string uncached)
+            : ProxyFileSystem(std::move(fs)), uncached(std::move(uncached))
+        {}
+
+        llvm::ErrorOr< llvm::vfs::Status > status(const llvm::Twine &path) override;
+
+        llvm::ErrorOr< std::unique_ptr< llvm::vfs::File > >
+        openFileForRead(const llvm::Twine &path) override;
+
+      private:
+        bool is_cached(llvm::StringRef path) const;
+
+        std::string uncached;
+        llvm::StringMap< llvm::ErrorOr< llvm::vfs::Status > > statuses;
+        llvm::StringMap< std::unique_ptr< llvm::MemoryBuffer > > contents;
+    };
+
+    //
+    // PreambleCache
+    //
+    // Builds clang ast of a source like `buildASTFromCodeWithArgs`, but shares
+    // the file system cache among all built units, and reuses a precompiled
+    // header of the preamble of the source, i.e., of its leading includes
+    // and macros. Precompiled preambles are stored in `directory` keyed by
+    // the text of the preamble, compiler options and working directory, so
+    // that they are reused by later invocations of the tool as well.
+    //
+    // Without a directory, the preamble is parsed as part of the source.
+    //
+    struct PreambleCache {
+        explicit PreambleCache(std::string directory);
+
+        std::unique_ptr< clang::ASTUnit > build_ast(
+            llvm::StringRef code, const std::vector< std::string > &args,
+            llvm::StringRef filename = "input.cc"
+        );
+
+      private:
+        // Returns path to the precompiled preamble, empty if it cannot be built.
+        std::string precompiled_preamble(
+            llvm::StringRef preamble, const std::vector< std::string > &args,
+            llvm::StringRef filename, bool rebuild
+        );
+
+        std::unique_ptr< clang::ASTUnit > parse(
+            llvm::StringRef code, const std::vector< std::string > &args, llvm::StringRef filename,
+            bool *stale_preamble
+        );
+
+        std::string directory;
+        std::string working_directory;
+        llvm::IntrusiveRefCntPtr< CachingFileSystem > fs;
+        llvm::StringMap< std::string > built;
+    };
+
+} // namespace vast::hl
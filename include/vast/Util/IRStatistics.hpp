@@ -0,0 +1,247 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Operation.h>
+#include <mlir/Pass/Pass.h>
+#include <mlir/Pass/PassInstrumentation.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include <sys/resource.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vast::util
+{
+    // Peak resident set size of the process in kilobytes.
+    static inline uint64_t peak_rss_kb() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+    #if defined(__APPLE__)
+        return uint64_t(usage.ru_maxrss) / 1024;
+    #else
+        return uint64_t(usage.ru_maxrss);
+    #endif
+    }
+
+    //
+    // ir_snapshot
+    //
+    // Number of operations nested in an operation per dialect and per
+    // operation name, and the peak memory of the process at the time.
+    //
+    struct ir_snapshot {
+        uint64_t ops = 0;
+        uint64_t peak_rss_kb = 0;
+        llvm::StringMap< uint64_t > dialects;
+        llvm::StringMap< uint64_t > names;
+    };
+
+    static inline ir_snapshot take_snapshot(mlir::Operation *root) {
+        ir_snapshot snapshot;
+        root->walk([&] (mlir::Operation *op) {
+            auto name = op->getName();
+            ++snapshot.ops;
+            ++snapshot.dialects[name.getDialectNamespace()];
+            ++snapshot.names[name.getStringRef()];
+        });
+        snapshot.peak_rss_kb = peak_rss_kb();
+        return snapshot;
+    }
+
+    enum class ir_statistics_format { text, json };
+
+    //
+    // ir_statistics
+    //
+    // Snapshots of the ir before and after passes, collected by instrumentations
+    // of possibly several pass managers (e.g., one per chunk of a split input),
+    // and reported as a single document.
+    //
+    struct ir_statistics {
+        struct pass_record {
+            std::string argument;
+            ir_snapshot before;
+            ir_snapshot after;
+            bool failed = false;
+        };
+
+        void record(pass_record &&rec) {
+            std::lock_guard< std::mutex > lock(mutex);
+            records.push_back(std::move(rec));
+        }
+
+        void print(llvm::raw_ostream &os, ir_statistics_format format) const {
+            if (format == ir_statistics_format::json) {
+                print_json(os);
+            } else {
+                print_text(os);
+            }
+            os.flush();
+        }
+
+      private:
+        static int64_t delta(uint64_t before, uint64_t after) {
+            return int64_t(after) - int64_t(before);
+        }
+
+        // Keys of both maps in sorted order.
+        static std::vector< llvm::StringRef > keys(
+            const llvm::StringMap< uint64_t > &before, const llvm::StringMap< uint64_t > &after
+        ) {
+            llvm::StringSet<> set;
+            for (const auto &entry : before) {
+                set.insert(entry.first());
+            }
+            for (const auto &entry : after) {
+                set.insert(entry.first());
+            }
+
+            std::vector< llvm::StringRef > result;
+            for (const auto &entry : set) {
+                result.push_back(entry.first());
+            }
+            llvm::sort(result);
+            return result;
+        }
+
+        static void print_counts(
+            llvm::raw_ostream &os, llvm::StringRef kind, const llvm::StringMap< uint64_t > &before,
+            const llvm::StringMap< uint64_t > &after, bool changed_only
+        ) {
+            for (auto key : keys(before, after)) {
+                auto from = before.lookup(key);
+                auto to   = after.lookup(key);
+                if (changed_only && from == to) {
+                    continue;
+                }
+                os << llvm::format("  %-8s %-40s %10llu %10llu %+10lld\n",
+                    kind.str().c_str(), key.str().c_str(),
+                    (unsigned long long)from, (unsigned long long)to, (long long)delta(from, to)
+                );
+            }
+        }
+
+        void print_text(llvm::raw_ostream &os) const {
+            os << llvm::format("%-32s %10s %10s %10s %14s %14s\n",
+                "pass", "ops before", "ops after", "delta", "peak rss KB", "after KB"
+            );
+
+            for (const auto &record : records) {
+                os << llvm::format("%-32s %10llu %10llu %+10lld %14llu %14llu%s\n",
+                    record.argument.c_str(),
+                    (unsigned long long)record.before.ops, (unsigned long long)record.after.ops,
+                    (long long)delta(record.before.ops, record.after.ops),
+                    (unsigned long long)record.before.peak_rss_kb,
+                    (unsigned long long)record.after.peak_rss_kb,
+                    record.failed ? " (failed)" : ""
+                );
+                print_counts(os, "dialect", record.before.dialects, record.after.dialects, false);
+                print_counts(os, "op", record.before.names, record.after.names, true);
+            }
+        }
+
+        static llvm::json::Object to_json(const llvm::StringMap< uint64_t > &counts) {
+            llvm::json::Object result;
+            for (const auto &entry : counts) {
+                result[entry.first()] = int64_t(entry.second);
+            }
+            return result;
+        }
+
+        static llvm::json::Object to_json(const ir_snapshot &snapshot) {
+            return llvm::json::Object{
+                { "ops", int64_t(snapshot.ops) },
+                { "peak_rss_kb", int64_t(snapshot.peak_rss_kb) },
+                { "dialects", to_json(snapshot.dialects) },
+                { "names", to_json(snapshot.names) }
+            };
+        }
+
+        void print_json(llvm::raw_ostream &os) const {
+            llvm::json::Array passes;
+            for (const auto &record : records) {
+                passes.push_back(llvm::json::Object{
+                    { "pass", record.argument },
+                    { "failed", record.failed },
+                    { "before", to_json(record.before) },
+                    { "after", to_json(record.after) }
+                });
+            }
+
+            os << llvm::formatv("{0:2}", llvm::json::Value(std::move(passes))) << "\n";
+        }
+
+        std::mutex mutex;
+        std::vector< pass_record > records;
+    };
+
+    //
+    // ir_statistics_instrumentation
+    //
+    // Takes snapshots of the ir before and after every pass and records them
+    // into the shared statistics. Passes without a command line argument,
+    // such as adaptors of nested pass managers, are skipped.
+    //
+    struct ir_statistics_instrumentation : mlir::PassInstrumentation {
+        explicit ir_statistics_instrumentation(ir_statistics &stats) : stats(stats) {}
+
+        void runBeforePass(mlir::Pass *pass, mlir::Operation *op) override {
+            if (pass->getArgument().empty()) {
+                return;
+            }
+
+            auto snapshot = take_snapshot(op);
+            std::lock_guard< std::mutex > lock(mutex);
+            pending[{ pass, op }] = std::move(snapshot);
+        }
+
+        void runAfterPass(mlir::Pass *pass, mlir::Operation *op) override {
+            finish(pass, op, false);
+        }
+
+        void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *op) override {
+            finish(pass, op, true);
+        }
+
+      private:
+        void finish(mlir::Pass *pass, mlir::Operation *op, bool failed) {
+            if (pass->getArgument().empty()) {
+                return;
+            }
+
+            auto snapshot = take_snapshot(op);
+            std::lock_guard< std::mutex > lock(mutex);
+            auto before = pending.find({ pass, op });
+            if (before == pending.end()) {
+                return;
+            }
+
+            stats.record({
+                pass->getArgument().str(), std::move(before->second), std::move(snapshot), failed
+            });
+            pending.erase(before);
+        }
+
+        ir_statistics &stats;
+
+        std::mutex mutex;
+        llvm::DenseMap< std::pair< mlir::Pass *, mlir::Operation * >, ir_snapshot > pending;
+    };
+
+} // namespace vast::util
@@ -0,0 +1,296 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/BuiltinTypes.h>
+#include <mlir/IR/Location.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/IR/SubElementInterfaces.h>
+#include <mlir/Pass/PassInstrumentation.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/IRStatistics.hpp"
+
+#include <string>
+#include <vector>
+
+namespace vast::util
+{
+    //
+    // memory_report
+    //
+    // Breaks down what a module keeps alive in its context: distinct uniqued
+    // types, attributes and locations per kind with the number of their uses
+    // by operations, and operations per dialect with estimated size of their
+    // storage. Uniqued storage itself is not exposed by the context, hence
+    // its kinds are ranked by the number of distinct instances.
+    //
+    struct memory_report {
+        struct uniqued_stats {
+            uint64_t distinct = 0;
+            uint64_t uses = 0;
+        };
+
+        struct op_stats {
+            uint64_t ops = 0;
+            uint64_t bytes = 0;
+        };
+
+        llvm::StringMap< uniqued_stats > types;
+        llvm::StringMap< uniqued_stats > attrs;
+        llvm::StringMap< uniqued_stats > locations;
+        llvm::StringMap< op_stats > dialects;
+
+        uint64_t data_layout_entries = 0;
+        uint64_t peak_rss_kb = 0;
+        uint64_t malloc_bytes = 0;
+
+        explicit memory_report(mlir::Operation *root) {
+            root->walk([&] (mlir::Operation *op) { collect(op); });
+
+            if (auto spec = root->getAttrOfType< mlir::DataLayoutSpecAttr >(
+                    mlir::DLTIDialect::kDataLayoutAttrName))
+            {
+                data_layout_entries = spec.getEntries().size();
+            }
+
+            peak_rss_kb  = util::peak_rss_kb();
+            malloc_bytes = llvm::sys::Process::GetMallocUsage();
+        }
+
+        void print(llvm::raw_ostream &os) const {
+            os << llvm::format("%-40s %14llu\n", "peak rss KB", (unsigned long long)peak_rss_kb);
+            os << llvm::format("%-40s %14llu\n", "malloc bytes", (unsigned long long)malloc_bytes);
+            os << llvm::format("%-40s %14llu\n", "data layout entries", (unsigned long long)data_layout_entries);
+
+            print_ops(os);
+            print_uniqued(os, "type", types);
+            print_uniqued(os, "attribute", attrs);
+            print_uniqued(os, "location", locations);
+        }
+
+      private:
+        // Rough size of the storage of an operation, its operands, results,
+        // regions, blocks and successors, excluding uniqued objects.
+        static uint64_t storage_bytes(mlir::Operation *op) {
+            constexpr uint64_t result_bytes   = 3 * sizeof(void *);
+            constexpr uint64_t argument_bytes = 4 * sizeof(void *);
+
+            uint64_t bytes = sizeof(mlir::Operation)
+                + op->getNumOperands() * sizeof(mlir::OpOperand)
+                + op->getNumResults() * result_bytes
+                + op->getNumSuccessors() * sizeof(mlir::BlockOperand)
+                + op->getNumRegions() * sizeof(mlir::Region);
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    bytes += sizeof(mlir::Block) + block.getNumArguments() * argument_bytes;
+                }
+            }
+            return bytes;
+        }
+
+        // Kind of a uniqued object by its printed form, e.g., `hl.lvalue` of
+        // `!hl.lvalue<!hl.int>`.
+        template< typename Object >
+        static std::string printed_kind(Object object, llvm::StringRef dialect) {
+            std::string text;
+            llvm::raw_string_ostream os(text);
+            object.print(os);
+
+            auto name = llvm::StringRef(os.str()).ltrim("!#").take_until([] (char c) {
+                return c == '<' || c == ' ' || c == '(' || c == '"';
+            });
+
+            if (name.startswith(dialect.str() + ".")) {
+                return name.str();
+            }
+            return (dialect + "." + name).str();
+        }
+
+        static std::string kind(mlir::Type type) {
+            if (type.isa< mlir::IntegerType >()) {
+                return "builtin.integer";
+            }
+            return printed_kind(type, type.getDialect().getNamespace());
+        }
+
+        static std::string kind(mlir::Attribute attr) {
+            return llvm::TypeSwitch< mlir::Attribute, std::string >(attr)
+                .Case< mlir::FileLineColLoc >([] (auto) { return "loc.file_line_col"; })
+                .Case< mlir::FusedLoc >([] (auto) { return "loc.fused"; })
+                .Case< mlir::NameLoc >([] (auto) { return "loc.name"; })
+                .Case< mlir::CallSiteLoc >([] (auto) { return "loc.call_site"; })
+                .Case< mlir::OpaqueLoc >([] (auto) { return "loc.opaque"; })
+                .Case< mlir::UnknownLoc >([] (auto) { return "loc.unknown"; })
+                .Case< mlir::IntegerAttr >([] (auto) { return "builtin.integer"; })
+                .Case< mlir::FloatAttr >([] (auto) { return "builtin.float"; })
+                .Case< mlir::StringAttr >([] (auto) { return "builtin.string"; })
+                .Case< mlir::ArrayAttr >([] (auto) { return "builtin.array"; })
+                .Case< mlir::DictionaryAttr >([] (auto) { return "builtin.dictionary"; })
+                .Case< mlir::TypeAttr >([] (auto) { return "builtin.type"; })
+                .Case< mlir::UnitAttr >([] (auto) { return "builtin.unit"; })
+                .Case< mlir::SymbolRefAttr >([] (auto) { return "builtin.symbol_ref"; })
+                .Case< mlir::ElementsAttr >([] (auto) { return "builtin.elements"; })
+                .Default([] (mlir::Attribute attr) {
+                    return printed_kind(attr, attr.getDialect().getNamespace());
+                });
+        }
+
+        template< typename Object >
+        void use(Object object, llvm::StringMap< uniqued_stats > &kinds) {
+            if (!object) {
+                return;
+            }
+
+            auto [it, inserted] = seen.try_emplace(object.getAsOpaquePointer(), nullptr);
+            if (!inserted) {
+                ++it->second->uses;
+                return;
+            }
+
+            auto stats = it->second = &kinds[kind(object)];
+            ++stats->distinct;
+            ++stats->uses;
+            // Invalidates `it`.
+            nested(object);
+        }
+
+        // Records objects nested in a uniqued one, such as the element type
+        // of `!hl.lvalue` or the metadata of a fused location.
+        void nested(mlir::Type type) {
+            if (auto elements = type.dyn_cast< mlir::SubElementTypeInterface >()) {
+                elements.walkSubElements(
+                    [&] (mlir::Attribute attr) { distinct(attr); },
+                    [&] (mlir::Type sub) { distinct(sub); }
+                );
+            }
+        }
+
+        void nested(mlir::Attribute attr) {
+            if (auto elements = attr.dyn_cast< mlir::SubElementAttrInterface >()) {
+                elements.walkSubElements(
+                    [&] (mlir::Attribute sub) { distinct(sub); },
+                    [&] (mlir::Type type) { distinct(type); }
+                );
+            }
+        }
+
+        // Nested objects are walked recursively by the interface, they are
+        // counted without their uses.
+        template< typename Object >
+        void distinct(Object object) {
+            auto [it, inserted] = seen.try_emplace(object.getAsOpaquePointer(), nullptr);
+            if (inserted) {
+                it->second = &kinds_of(object)[kind(object)];
+                ++it->second->distinct;
+            }
+        }
+
+        llvm::StringMap< uniqued_stats > &kinds_of(mlir::Type) { return types; }
+
+        llvm::StringMap< uniqued_stats > &kinds_of(mlir::Attribute attr) {
+            return attr.isa< mlir::LocationAttr >() ? locations : attrs;
+        }
+
+        void collect(mlir::Operation *op) {
+            auto &stats = dialects[op->getName().getDialectNamespace()];
+            ++stats.ops;
+            stats.bytes += storage_bytes(op);
+
+            use(mlir::Attribute(op->getLoc()), locations);
+            use(mlir::Attribute(op->getAttrDictionary()), attrs);
+
+            for (auto type : op->getResultTypes()) {
+                use(type, types);
+            }
+
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto arg : block.getArguments()) {
+                        use(arg.getType(), types);
+                        use(mlir::Attribute(arg.getLoc()), locations);
+                    }
+                }
+            }
+        }
+
+        void print_ops(llvm::raw_ostream &os) const {
+            std::vector< const llvm::StringMapEntry< op_stats > * > sorted;
+            for (const auto &entry : dialects) {
+                sorted.push_back(&entry);
+            }
+            llvm::sort(sorted, [] (const auto *lhs, const auto *rhs) {
+                return lhs->second.bytes > rhs->second.bytes;
+            });
+
+            os << llvm::format("\n%-40s %14s %14s\n", "dialect", "ops", "est. bytes");
+            for (const auto *entry : sorted) {
+                os << llvm::format("%-40s %14llu %14llu\n", entry->first().str().c_str(),
+                    (unsigned long long)entry->second.ops, (unsigned long long)entry->second.bytes
+                );
+            }
+        }
+
+        static void print_uniqued(
+            llvm::raw_ostream &os, llvm::StringRef what, const llvm::StringMap< uniqued_stats > &kinds
+        ) {
+            std::vector< const llvm::StringMapEntry< uniqued_stats > * > sorted;
+            for (const auto &entry : kinds) {
+                sorted.push_back(&entry);
+            }
+            llvm::sort(sorted, [] (const auto *lhs, const auto *rhs) {
+                if (lhs->second.distinct != rhs->second.distinct)
+                    return lhs->second.distinct > rhs->second.distinct;
+                return lhs->first() < rhs->first();
+            });
+
+            os << llvm::format("\n%-40s %14s %14s\n", what.str().c_str(), "distinct", "uses");
+            for (const auto *entry : sorted) {
+                os << llvm::format("%-40s %14llu %14llu\n", entry->first().str().c_str(),
+                    (unsigned long long)entry->second.distinct, (unsigned long long)entry->second.uses
+                );
+            }
+        }
+
+        llvm::DenseMap< const void *, uniqued_stats * > seen;
+    };
+
+    //
+    // memory_report_instrumentation
+    //
+    // Reports memory of the top-level operation once the pass manager is
+    // done, i.e., after the last pass of the pipeline.
+    //
+    struct memory_report_instrumentation : mlir::PassInstrumentation {
+        explicit memory_report_instrumentation(llvm::raw_ostream &os) : os(os) {}
+
+        ~memory_report_instrumentation() override {
+            if (root) {
+                memory_report(root).print(os);
+            }
+        }
+
+        void runAfterPass(mlir::Pass *, mlir::Operation *op) override {
+            if (!op->getParentOp()) {
+                root = op;
+            }
+        }
+
+        llvm::raw_ostream &os;
+        mlir::Operation *root = nullptr;
+    };
+
+} // namespace vast::util
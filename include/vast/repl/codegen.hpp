@@ -8,21 +8,55 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
 #include <clang/Frontend/ASTUnit.h>
 #include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
 #include <mlir/IR/Builders.h>
+#include <mlir/Support/LogicalResult.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/repl/common.hpp"
 #include "vast/Translation/CodeGen.hpp"
 
 #include <filesystem>
+#include <optional>
 
 namespace vast::repl::codegen {
 
+    // Parses the source with a precompiled preamble, so that later reparses
+    // of the unit reuse it unless its includes change.
     std::unique_ptr< clang::ASTUnit > ast_from_source(const std::string &source);
 
+    // Parses a new version of the source in place of the previous one.
+    void reparse(clang::ASTUnit &unit, const std::string &source);
+
     // TODO(Heno): return buffer
     std::string get_source(std::filesystem::path source);
 
-    owning_module_ref emit_module(const std::string &source, MContext *ctx);
+    owning_module_ref emit_module(clang::ASTUnit &unit, MContext *ctx);
+
+    //
+    // Summary of the source from which a module was emitted. The skeleton
+    // covers the source without bodies of its functions together with the
+    // state of included files, bodies are hashed per function.
+    //
+    struct fingerprint {
+        std::uint64_t skeleton = 0;
+        llvm::StringMap< std::uint64_t > bodies;
+    };
+
+    fingerprint take_fingerprint(clang::ASTUnit &unit);
+
+    // Returns functions whose bodies differ, or nothing if the skeleton
+    // differs and the module has to be emitted anew.
+    std::optional< llvm::StringSet<> > changed_functions(
+        const fingerprint &before, const fingerprint &after
+    );
+
+    // Emits the given functions of the unit again and replaces their
+    // previous versions in the module. Fails without changing the module if
+    // any of the functions is missing in either version.
+    mlir::LogicalResult emit_functions(
+        clang::ASTUnit &unit, MContext *ctx, Module mod, const llvm::StringSet<> &names
+    );
 
 } // namespace vast::repl::codegen
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "vast/repl/common.hpp"
+#include "vast/repl/codegen.hpp"
 
 namespace vast::repl {
 
@@ -15,8 +16,14 @@ namespace vast::repl {
 
         std::optional< std::string > source;
 
+        // Unit of the loaded source, reparsed when the source is loaded again.
+        std::unique_ptr< clang::ASTUnit > unit;
+
         MContext &ctx;
         owning_module_ref mod;
+
+        // Source from which the module was emitted.
+        codegen::fingerprint emitted;
     };
 
 } // namespace vast::repl
@@ -10,6 +10,8 @@
 #include <mlir/IR/TypeSupport.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/DialectImplementation.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/Transforms/InliningUtils.h>
 
 #include <llvm/ADT/TypeSwitch.h>
 #include <llvm/Support/ErrorHandling.h>
@@ -21,6 +23,76 @@
 
 namespace vast::hl
 {
+    // Inlining of direct calls (`hl.call`) to functions defined in the module.
+    //
+    // Parameters of functions are lvalues, hence call arguments are materialized
+    // as variables initialized by the argument value. Only functions that
+    // return at the end of their body are inlined. Return from nested regions
+    // would need to be rewritten to structured control flow first.
+    //
+    // The interface decides only whether a call can be inlined, whether it pays
+    // off is decided by `vast-hl-inline`.
+    struct HighLevelInlinerInterface : mlir::DialectInlinerInterface
+    {
+        using mlir::DialectInlinerInterface::DialectInlinerInterface;
+
+        static bool returns_value(Operation *callable)
+        {
+            auto &body = callable->getRegion(0);
+            if (body.empty() || body.back().empty())
+                return false;
+            auto ret = mlir::dyn_cast< ReturnOp >(body.back().back());
+            return ret && ret.getNumOperands() != 0;
+        }
+
+        bool isLegalToInline(Operation *call, Operation *callable, bool) const final
+        {
+            if (!mlir::isa< CallOp >(call) || callable->getNumRegions() != 1)
+                return false;
+
+            if (!callable->getRegion(0).hasOneBlock())
+                return false;
+
+            if (callable->hasAttr(NoInlineAttr::getMnemonic()))
+                return false;
+
+            // Results of calls to void functions have nothing to be replaced by.
+            return returns_value(callable) || call->use_empty();
+        }
+
+        bool isLegalToInline(Region *, Region *, bool, mlir::BlockAndValueMapping &) const final
+        {
+            return true;
+        }
+
+        bool isLegalToInline(Operation *op, Region *, bool, mlir::BlockAndValueMapping &) const final
+        {
+            if (mlir::isa< ReturnOp >(op))
+                return mlir::isa< mlir::FunctionOpInterface >(op->getParentOp());
+            return !mlir::isa< UnreachableOp >(op);
+        }
+
+        void handleTerminator(Operation *op, llvm::ArrayRef< Value > values) const final
+        {
+            auto ret = mlir::cast< ReturnOp >(op);
+            for (auto [from, to] : llvm::zip(values, ret.getOperands()))
+                from.replaceAllUsesWith(to);
+        }
+
+        Operation *materializeCallConversion(mlir::OpBuilder &bld, Value input, Type type,
+                                             Location loc) const final
+        {
+            auto lvalue = type.dyn_cast< LValueType >();
+            if (!lvalue || lvalue.getElementType() != input.getType())
+                return nullptr;
+
+            auto init = [&] (auto &builder, auto at) {
+                builder.template create< ValueYieldOp >(at, input);
+            };
+            return bld.create< VarDeclOp >(loc, type, "param", init);
+        }
+    };
+
     void HighLevelDialect::initialize()
     {
         registerTypes();
@@ -30,6 +102,8 @@ namespace vast::hl
             #define GET_OP_LIST
             #include "vast/Dialect/HighLevel/HighLevel.cpp.inc"
         >();
+
+        addInterfaces< HighLevelInlinerInterface >();
     }
 
     using DialectParser = mlir::AsmParser;
@@ -40,7 +114,13 @@ namespace vast::hl
 
     Operation *HighLevelDialect::materializeConstant(OpBuilder &builder, Attribute value, Type type, Location loc)
     {
-        VAST_UNIMPLEMENTED;
+        if (auto attr = value.dyn_cast< BooleanAttr >(); attr && isBoolType(type))
+            return builder.create< ConstantOp >(loc, type, attr.getValue());
+        if (auto attr = value.dyn_cast< IntegerAttr >(); attr && isIntegerType(type))
+            return builder.create< ConstantOp >(loc, type, attr.getValue());
+        if (auto attr = value.dyn_cast< FloatAttr >(); attr && isFloatingType(type))
+            return builder.create< ConstantOp >(loc, type, attr.getValue());
+        return nullptr;
     }
 } // namespace vast::hl
 
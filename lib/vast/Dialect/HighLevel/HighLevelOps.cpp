@@ -8,6 +8,7 @@
 #include <mlir/Support/LLVM.h>
 #include <mlir/Support/LogicalResult.h>
 #include <mlir/IR/Builders.h>
+#include <mlir/IR/Matchers.h>
 #include <mlir/IR/OperationSupport.h>
 #include <mlir/IR/SymbolTable.h>
 #include <mlir/IR/OpImplementation.h>
@@ -40,6 +41,123 @@ namespace vast::hl
         return getValue();
     }
 
+    //
+    // Constant folding
+    //
+    namespace detail
+    {
+        std::optional< llvm::APSInt > constant_int(Attribute attr) {
+            if (auto value = attr.dyn_cast_or_null< IntegerAttr >())
+                return value.getValue();
+            if (auto value = attr.dyn_cast_or_null< BooleanAttr >())
+                return llvm::APSInt(llvm::APInt(1, value.getValue()), /* unsigned */ true);
+            return std::nullopt;
+        }
+
+        // Integers are folded in the width and signedness of their type as
+        // given by the data layout of the module.
+        Attribute make_constant(Operation *op, Type type, const llvm::APSInt &value) {
+            if (isBoolType(type))
+                return BooleanAttr::get(type, !value.isZero());
+            if (!isIntegerType(type))
+                return {};
+
+            auto bits = mlir::DataLayout::closest(op).getTypeSizeInBits(type);
+            return IntegerAttr::get(type, llvm::APSInt(value.extOrTrunc(bits), isUnsigned(type)));
+        }
+
+        Attribute make_constant(Operation *op, Type type, bool value) {
+            return make_constant(op, type, llvm::APSInt::get(value));
+        }
+
+        std::optional< bool > compare(Predicate pred, const llvm::APInt &lhs, const llvm::APInt &rhs) {
+            if (lhs.getBitWidth() != rhs.getBitWidth())
+                return std::nullopt;
+
+            switch (pred) {
+                case Predicate::eq:  return lhs.eq(rhs);
+                case Predicate::ne:  return lhs.ne(rhs);
+                case Predicate::slt: return lhs.slt(rhs);
+                case Predicate::sle: return lhs.sle(rhs);
+                case Predicate::sgt: return lhs.sgt(rhs);
+                case Predicate::sge: return lhs.sge(rhs);
+                case Predicate::ult: return lhs.ult(rhs);
+                case Predicate::ule: return lhs.ule(rhs);
+                case Predicate::ugt: return lhs.ugt(rhs);
+                case Predicate::uge: return lhs.uge(rhs);
+            }
+
+            VAST_UNREACHABLE("unknown comparison predicate");
+        }
+
+        FoldResult fold_cast(Operation *op, Attribute value, CastKind kind) {
+            auto type = op->getResult(0).getType();
+            auto integer = constant_int(value);
+            if (!integer)
+                return {};
+
+            switch (kind) {
+                case CastKind::IntegralCast:
+                case CastKind::IntegralToBoolean:
+                case CastKind::NoOp:
+                    return make_constant(op, type, *integer);
+                default:
+                    return {};
+            }
+        }
+    } // namespace detail
+
+    FoldResult ImplicitCastOp::fold(mlir::ArrayRef< Attribute > operands) {
+        return detail::fold_cast(*this, operands[0], getKind());
+    }
+
+    FoldResult CStyleCastOp::fold(mlir::ArrayRef< Attribute > operands) {
+        return detail::fold_cast(*this, operands[0], getKind());
+    }
+
+    FoldResult BuiltinBitCastOp::fold(mlir::ArrayRef< Attribute >) {
+        return {};
+    }
+
+    FoldResult CmpOp::fold(mlir::ArrayRef< Attribute > operands) {
+        auto lhs = detail::constant_int(operands[0]);
+        auto rhs = detail::constant_int(operands[1]);
+        if (!lhs || !rhs)
+            return {};
+
+        if (auto result = detail::compare(getPredicate(), *lhs, *rhs))
+            return detail::make_constant(*this, getType(), *result);
+        return {};
+    }
+
+    FoldResult LNotOp::fold(mlir::ArrayRef< Attribute > operands) {
+        if (auto arg = detail::constant_int(operands[0]))
+            return detail::make_constant(*this, getType(), arg->isZero());
+        return {};
+    }
+
+    // Both operands are evaluated already, hence a single constant operand
+    // may decide the result.
+    FoldResult BinLAndOp::fold(mlir::ArrayRef< Attribute > operands) {
+        auto lhs = detail::constant_int(operands[0]);
+        auto rhs = detail::constant_int(operands[1]);
+        if ((lhs && lhs->isZero()) || (rhs && rhs->isZero()))
+            return detail::make_constant(*this, getType(), false);
+        if (lhs && rhs)
+            return detail::make_constant(*this, getType(), true);
+        return {};
+    }
+
+    FoldResult BinLOrOp::fold(mlir::ArrayRef< Attribute > operands) {
+        auto lhs = detail::constant_int(operands[0]);
+        auto rhs = detail::constant_int(operands[1]);
+        if ((lhs && !lhs->isZero()) || (rhs && !rhs->isZero()))
+            return detail::make_constant(*this, getType(), true);
+        if (lhs && rhs)
+            return detail::make_constant(*this, getType(), false);
+        return {};
+    }
+
 
     void build_expr_trait(Builder &bld, State &st, Type rty, BuilderCallback expr) {
         VAST_ASSERT(expr && "the builder callback for 'expr' block must be present");
@@ -100,6 +218,78 @@ namespace vast::hl
         return (*this)->getOperand(0);
     }
 
+    //
+    // Memory effects
+    //
+    namespace detail
+    {
+        using Effects = mlir::SmallVectorImpl<
+            mlir::SideEffects::EffectInstance< mlir::MemoryEffects::Effect >
+        >;
+
+        void read_from(Value value, Effects &effects) {
+            effects.emplace_back(mlir::MemoryEffects::Read::get(), value);
+        }
+
+        // Volatile accesses are not to be merged or removed, hence are modeled
+        // as writes as well.
+        void load_from(Value lvalue, Operation *op, Effects &effects) {
+            read_from(lvalue, effects);
+
+            auto element = lvalue.getType().cast< LValueType >().getElementType();
+            if (op->hasAttr(volatile_attr_name) || isVolatileQualified(element)) {
+                effects.emplace_back(mlir::MemoryEffects::Write::get(), lvalue);
+            }
+        }
+
+        void cast_effects(Operation *op, Value value, CastKind kind, Effects &effects) {
+            if (kind == CastKind::LValueToRValue || kind == CastKind::LValueToRValueBitCast) {
+                load_from(value, op, effects);
+            }
+        }
+    } // namespace detail
+
+    void ImplicitCastOp::getEffects(detail::Effects &effects) {
+        detail::cast_effects(*this, getValue(), getKind(), effects);
+    }
+
+    void CStyleCastOp::getEffects(detail::Effects &effects) {
+        detail::cast_effects(*this, getValue(), getKind(), effects);
+    }
+
+    void BuiltinBitCastOp::getEffects(detail::Effects &effects) {
+        detail::cast_effects(*this, getValue(), getKind(), effects);
+    }
+
+    // Dereference of a pointer stored in a variable reads the variable.
+    void Deref::getEffects(detail::Effects &effects) {
+        if (getAddr().getType().isa< LValueType >()) {
+            detail::load_from(getAddr(), *this, effects);
+        }
+    }
+
+    // Arrays are accessed in place, pointers are read first.
+    void SubscriptOp::getEffects(detail::Effects &effects) {
+        auto array = getArray().getType().cast< LValueType >().getElementType();
+        if (array.isa< PointerType >()) {
+            detail::load_from(getArray(), *this, effects);
+        }
+    }
+
+    void CallOp::getEffects(detail::Effects &effects) {
+        auto callee = mlir::SymbolTable::lookupNearestSymbolFrom(*this, getCalleeAttr());
+        if (callee && callee->hasAttr(ConstAttr::getMnemonic()))
+            return;
+
+        effects.emplace_back(mlir::MemoryEffects::Read::get());
+        if (callee && callee->hasAttr(PureAttr::getMnemonic()))
+            return;
+
+        effects.emplace_back(mlir::MemoryEffects::Write::get());
+        effects.emplace_back(mlir::MemoryEffects::Allocate::get());
+        effects.emplace_back(mlir::MemoryEffects::Free::get());
+    }
+
     void IfOp::build(Builder &bld, State &st, BuilderCallback condBuilder, BuilderCallback thenBuilder, BuilderCallback elseBuilder)
     {
         VAST_ASSERT(condBuilder && "the builder callback for 'condition' block must be present");
@@ -142,6 +332,58 @@ namespace vast::hl
         detail::build_region(bld, st, cond);
     }
 
+    namespace detail
+    {
+        bool is_defined_outside(Operation *loop, Value value) {
+            return !loop->isAncestor(value.getParentRegion()->getParentOp());
+        }
+    } // namespace detail
+
+    Operation *jump_target(Operation *jump) {
+        for (auto parent = jump->getParentOp(); parent; parent = parent->getParentOp()) {
+            if (mlir::isa< WhileOp, ForOp, DoOp >(parent))
+                return parent;
+            if (mlir::isa< BreakOp >(jump) && mlir::isa< SwitchOp >(parent))
+                return parent;
+        }
+        return nullptr;
+    }
+
+    std::optional< llvm::APInt > case_value(CaseOp op, unsigned width) {
+        auto &lhs = op.getLhs();
+        if (lhs.empty() || lhs.front().empty())
+            return std::nullopt;
+
+        auto yield = mlir::dyn_cast< ValueYieldOp >(lhs.front().back());
+        Attribute attr;
+        if (!yield || !mlir::matchPattern(yield.getResult(), mlir::m_Constant(&attr)))
+            return std::nullopt;
+
+        if (auto value = attr.dyn_cast< IntegerAttr >())
+            return value.getValue().extOrTrunc(width);
+        if (auto value = attr.dyn_cast< mlir::IntegerAttr >())
+            return value.getValue().sextOrTrunc(width);
+        return std::nullopt;
+    }
+
+    Region &WhileOp::getLoopBody() { return getBodyRegion(); }
+
+    bool WhileOp::isDefinedOutsideOfLoop(Value value) {
+        return detail::is_defined_outside(*this, value);
+    }
+
+    Region &ForOp::getLoopBody() { return getBodyRegion(); }
+
+    bool ForOp::isDefinedOutsideOfLoop(Value value) {
+        return detail::is_defined_outside(*this, value);
+    }
+
+    Region &DoOp::getLoopBody() { return getBodyRegion(); }
+
+    bool DoOp::isDefinedOutsideOfLoop(Value value) {
+        return detail::is_defined_outside(*this, value);
+    }
+
     void SwitchOp::build(Builder &bld, State &st, BuilderCallback cond, BuilderCallback body)
     {
         VAST_ASSERT(cond && "the builder callback for 'condition' block must be present");
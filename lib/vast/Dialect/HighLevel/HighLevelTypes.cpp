@@ -75,7 +75,7 @@ namespace vast::hl
 
         VAST_ASSERT(isIntegerType(type));
         return util::dispatch< integer_types, bool >(type, [] (auto ty) {
-            return ty.getQuals().hasUnsigned();
+            return !ty.getQuals().hasUnsigned();
         });
     }
 
@@ -89,6 +89,36 @@ namespace vast::hl
         return util::is_one_of< high_level_types >(type);
     }
 
+    bool hasQualifier(mlir::Type type, auto &&check)
+    {
+        if (!util::is_one_of< qualified_types >(type))
+            return false;
+
+        return util::dispatch< qualified_types, bool >(type, [&] (auto ty) {
+            auto quals = ty.getQuals();
+            return quals && check(quals);
+        });
+    }
+
+    bool isConstQualified(mlir::Type type)
+    {
+        return hasQualifier(type, [] (auto quals) { return quals.hasConst(); });
+    }
+
+    bool isVolatileQualified(mlir::Type type)
+    {
+        return hasQualifier(type, [] (auto quals) { return quals.hasVolatile(); });
+    }
+
+    bool isRestrictQualified(mlir::Type type)
+    {
+        return hasQualifier(type, [] (auto quals) {
+            if constexpr (requires { quals.hasRestrict(); })
+                return quals.hasRestrict();
+            return false;
+        });
+    }
+
 } // namespace vast::hl
 
 using StringRef = llvm::StringRef; // to fix missing namespace in generated file
@@ -5,6 +5,12 @@
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/FunctionInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::hl
 {
     bool isFileContext(DeclContextKind kind) {
@@ -29,9 +35,10 @@ namespace vast::hl
     bool VarDeclOp::isInRecordContext() { return isRecordContext(getDeclContextKind()); }
 
     DeclContextKind VarDeclOp::getDeclContextKind() {
-        auto st = mlir::SymbolTable::getNearestSymbolTable(*this);
-        if (mlir::isa< mlir::func::FuncOp >(st))
+        // Functions are not symbol tables, hence locals would see the module.
+        if ((*this)->getParentOfType< mlir::FunctionOpInterface >())
             return DeclContextKind::dc_function;
+        auto st = mlir::SymbolTable::getNearestSymbolTable(*this);
         if (mlir::isa< mlir::ModuleOp >(st))
             return DeclContextKind::dc_translation_unit;
         if (mlir::isa< StructDeclOp >(st))
@@ -52,10 +59,19 @@ namespace vast::hl
 
     bool VarDeclOp::isLocalVarDecl() { return isInFunctionOrMethodContext(); }
 
+    // Codegen omits storage classes of variables without any specifier.
+    static StorageClass storageClassOf(VarDeclOp var) {
+        return var.getStorageClass().value_or(StorageClass::sc_none);
+    }
+
+    static TSClass threadStorageClassOf(VarDeclOp var) {
+        return var.getThreadStorageClass().value_or(TSClass::tsc_none);
+    }
+
     bool VarDeclOp::hasLocalStorage() {
-        switch (getStorageClass().value()) {
+        switch (storageClassOf(*this)) {
             case StorageClass::sc_none:
-                return !isFileVarDecl() && getThreadStorageClass() == TSClass::tsc_none;
+                return !isFileVarDecl() && threadStorageClassOf(*this) == TSClass::tsc_none;
             case StorageClass::sc_register: return isLocalVarDecl();
             case StorageClass::sc_auto: return true;
             case StorageClass::sc_extern:
@@ -69,10 +85,10 @@ namespace vast::hl
     bool VarDeclOp::isStaticLocal() {
         if (isFileVarDecl())
             return false;
-        auto sc = getStorageClass();
+        auto sc = storageClassOf(*this);
         if (sc == StorageClass::sc_static)
             return true;
-        auto tsc = getThreadStorageClass();
+        auto tsc = threadStorageClassOf(*this);
         return sc == StorageClass::sc_none && tsc == TSClass::tsc_cxx_thread;
     }
 
@@ -86,7 +102,7 @@ namespace vast::hl
     StorageDuration VarDeclOp::getStorageDuration() {
         if (hasLocalStorage())
             return StorageDuration::sd_automatic;
-        if (getThreadStorageClass() != TSClass::tsc_none)
+        if (threadStorageClassOf(*this) != TSClass::tsc_none)
             return StorageDuration::sd_thread;
         return StorageDuration::sd_static;
     }
@@ -0,0 +1,71 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/Transforms/InliningUtils.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Number of high-level operations of the function body.
+        std::size_t size(mlir::func::FuncOp fn) {
+            std::size_t count = 0;
+            fn.walk([&] (Operation *op) {
+                if (op->getName().getDialectNamespace() == HighLevelDialect::getDialectNamespace())
+                    ++count;
+            });
+            return count;
+        }
+
+    } // namespace
+
+    // Whether a call is legal to be inlined is decided by the inliner interface
+    // of the dialect, the pass decides whether it is profitable.
+    struct HLInlinePass : HLInlineBase< HLInlinePass >
+    {
+        bool is_profitable(mlir::func::FuncOp callee) const {
+            if (callee->hasAttr(AlwaysInlineAttr::getMnemonic()))
+                return true;
+            return size(callee) <= size_threshold;
+        }
+
+        void runOnOperation() override {
+            auto mod = getOperation();
+            mlir::InlinerInterface interface(&getContext());
+
+            llvm::SmallVector< CallOp > calls;
+            mod.walk([&] (CallOp call) { calls.push_back(call); });
+
+            for (auto call : calls) {
+                auto callee = mod.lookupSymbol< mlir::func::FuncOp >(call.getCallee());
+                if (!callee || callee.isExternal() || callee->isAncestor(call))
+                    continue;
+
+                if (!is_profitable(callee))
+                    continue;
+
+                if (mlir::failed(mlir::inlineCall(interface, call, callee, &callee.getBody())))
+                    continue;
+
+                call.erase();
+                ++calls_inlined;
+            }
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLInlinePass()
+{
+    return std::make_unique< HLInlinePass >();
+}
@@ -0,0 +1,233 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/IR/Builders.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+#include "ProfileCounters.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/Meta/MetaAttributes.hpp"
+#include "vast/Util/Symbols.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        //
+        // Counters are incremented at the same places as clang increments
+        // them, so that the annotation of the profile derives counts of other
+        // edges the same way. Counters of `do` and switch labels count only
+        // jumps to their body, hence the fallthrough into them is subtracted
+        // right before the statement.
+        //
+        struct counter_instrumentation
+        {
+            mlir::OpBuilder &bld;
+            llvm::StringRef counters_name;
+            mlir::Type counters_type;
+            mlir::Type counter_type;
+
+            mlir::MLIRContext *mctx() { return bld.getContext(); }
+
+            template< typename Op >
+            void update(mlir::Location loc, unsigned idx)
+            {
+                auto ref = bld.create< GlobalRefOp >(
+                    loc, LValueType::get(mctx(), counters_type), counters_name
+                );
+                auto ptr = bld.create< ImplicitCastOp >(
+                    loc, LValueType::get(mctx(), PointerType::get(mctx(), counter_type)),
+                    ref, CastKind::ArrayToPointerDecay
+                );
+                auto index = bld.create< ConstantOp >(
+                    loc, IntType::get(mctx()), llvm::APSInt(llvm::APInt(32, idx), false)
+                );
+                auto counter = bld.create< SubscriptOp >(
+                    loc, LValueType::get(mctx(), counter_type), ptr, index
+                );
+                bld.create< Op >(loc, counter_type, counter);
+            }
+
+            void increment_at_start(mlir::Region &region, mlir::Location loc, unsigned idx)
+            {
+                bld.setInsertionPointToStart(&region.front());
+                update< PreIncOp >(loc, idx);
+            }
+
+            void decrement_before(mlir::Operation *op, unsigned idx)
+            {
+                bld.setInsertionPoint(op);
+                update< PreDecOp >(op->getLoc(), idx);
+            }
+
+            void instrument(mlir::func::FuncOp fn, const counter_numbering &numbering, unsigned base)
+            {
+                increment_at_start(fn.getBody(), fn.getLoc(), base);
+
+                for (auto [op, local] : numbering.counters) {
+                    auto idx = base + local;
+                    auto loc = op->getLoc();
+                    llvm::TypeSwitch< mlir::Operation *, void >(op)
+                        .Case([&] (IfOp stmt) { increment_at_start(stmt.getThenRegion(), loc, idx); })
+                        .Case< WhileOp, ForOp >([&] (auto stmt) {
+                            increment_at_start(stmt.getBodyRegion(), loc, idx);
+                        })
+                        .Case([&] (DoOp stmt) {
+                            decrement_before(stmt, idx);
+                            increment_at_start(stmt.getBodyRegion(), loc, idx);
+                        })
+                        .Case< CaseOp, DefaultOp >([&] (auto label) {
+                            decrement_before(label, idx);
+                            increment_at_start(label.getBody(), loc, idx);
+                        })
+                        .Case([&] (LabelStmt stmt) { increment_at_start(stmt.getSubstmt(), loc, idx); })
+                        // The counter of a switch counts its exit.
+                        .Case([&] (SwitchOp stmt) {
+                            bld.setInsertionPointAfter(stmt);
+                            update< PreIncOp >(loc, idx);
+                        })
+                        // Operands of logical operators are both evaluated in
+                        // the high-level dialect, their counters do not affect
+                        // counts of branches and are kept zero.
+                        .Default([] (mlir::Operation *) {});
+                }
+            }
+        };
+
+        llvm::json::Object location_entry(mlir::Location loc)
+        {
+            llvm::json::Object entry;
+            if (auto file = file_location(loc)) {
+                entry["file"] = file.getFilename().getValue();
+                entry["line"] = file.getLine();
+                entry["column"] = file.getColumn();
+            }
+            if (auto fused = loc.dyn_cast< mlir::FusedLoc >())
+                if (auto id = fused.getMetadata().dyn_cast_or_null< meta::IdentifierAttr >())
+                    entry["id"] = id.getValue();
+            return entry;
+        }
+
+    } // namespace
+
+    struct HLInstrumentPass : HLInstrumentBase< HLInstrumentPass >
+    {
+        void runOnOperation() override
+        {
+            auto mod = getOperation();
+
+            llvm::SmallVector< mlir::func::FuncOp > functions;
+            util::functions(mod, [&] (mlir::func::FuncOp fn) {
+                if (!fn.isDeclaration())
+                    functions.push_back(fn);
+            });
+
+            if (functions.empty())
+                return;
+
+            auto mctx = &getContext();
+            mlir::OpBuilder bld(mctx);
+
+            auto counters_name = symbol_prefix + "_counters";
+            auto counter_type = LongLongType::get(mctx, UCVQualifiersAttr::get(mctx, true, false, false));
+
+            // Counters are numbered before any of them is inserted.
+            std::vector< counter_numbering > numberings(functions.size());
+            unsigned total = 0;
+            for (auto [fn, numbering] : llvm::zip(functions, numberings)) {
+                numbering.number(fn.getBody());
+                total += numbering.next;
+            }
+
+            auto counters_type = ArrayType::get(mctx, SizeParam(total), counter_type);
+            counter_instrumentation instrumentation{ bld, counters_name, counters_type, counter_type };
+
+            // Names list functions with the number of their counters in the
+            // order of the counter array, e.g., `main 3 foo 1`.
+            std::string names;
+            llvm::raw_string_ostream names_stream(names);
+            llvm::json::Array map;
+
+            unsigned base = 0;
+            for (auto [fn, numbering] : llvm::zip(functions, numberings)) {
+                instrumentation.instrument(fn, numbering, base);
+                names_stream << (base ? " " : "") << fn.getName() << " " << numbering.next;
+
+                llvm::json::Array counters;
+                auto entry = location_entry(fn.getLoc());
+                entry["index"] = base;
+                entry["kind"] = "entry";
+                counters.push_back(std::move(entry));
+                for (auto [op, local] : numbering.counters) {
+                    auto counter = location_entry(op->getLoc());
+                    counter["index"] = base + local;
+                    counter["kind"] = op->getName().getStringRef();
+                    counters.push_back(std::move(counter));
+                }
+
+                llvm::json::Object function;
+                function["name"] = fn.getName();
+                function["counters"] = std::move(counters);
+                map.push_back(std::move(function));
+
+                base += numbering.next;
+            }
+
+            declare_globals(functions.front(), counters_name, counters_type, names_stream.str());
+
+            if (!map_file.empty())
+                write_map(std::move(map));
+        }
+
+        void declare_globals(mlir::Operation *before, llvm::StringRef counters_name,
+                             mlir::Type counters_type, llvm::StringRef names)
+        {
+            auto mctx = &getContext();
+            auto loc = mlir::UnknownLoc::get(mctx);
+
+            mlir::OpBuilder bld(before);
+            bld.create< VarDeclOp >(loc, LValueType::get(mctx, counters_type), counters_name);
+
+            auto char_type = CharType::get(mctx);
+            auto str_type = ArrayType::get(mctx, SizeParam(names.size() + 1), char_type);
+            auto ptr_type = PointerType::get(mctx, char_type);
+
+            auto init = [&] (Builder &init_bld, Location init_loc) {
+                auto str = init_bld.create< ConstantOp >(init_loc, str_type, names);
+                auto ptr = init_bld.create< ImplicitCastOp >(
+                    init_loc, ptr_type, str, CastKind::ArrayToPointerDecay
+                );
+                init_bld.create< ValueYieldOp >(init_loc, ptr.getResult());
+            };
+            bld.create< VarDeclOp >(loc, LValueType::get(mctx, ptr_type), symbol_prefix + "_names", init);
+        }
+
+        void write_map(llvm::json::Array map)
+        {
+            std::error_code ec;
+            llvm::raw_fd_ostream out(map_file, ec, llvm::sys::fs::OF_Text);
+            if (ec) {
+                getOperation().emitError("unable to write counter map: ") << ec.message();
+                return signalPassFailure();
+            }
+            out << llvm::formatv("{0:2}", llvm::json::Value(std::move(map)));
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLInstrumentPass()
+{
+    return std::make_unique< HLInstrumentPass >();
+}
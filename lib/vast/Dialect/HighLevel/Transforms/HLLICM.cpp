@@ -0,0 +1,76 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Interfaces/CallInterfaces.h>
+#include <mlir/Interfaces/LoopLikeInterface.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <mlir/Transforms/LoopInvariantCodeMotionUtils.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        // Integer division and remainder may trap, hence they are not
+        // speculated out of loops that might never evaluate them.
+        bool may_trap(Operation *op) {
+            return mlir::isa< DivSOp, DivUOp, RemSOp, RemUOp >(op);
+        }
+
+        // Pure expressions and address computations, i.e., operations that
+        // neither touch memory nor have nested regions.
+        bool is_hoistable(Operation *op) {
+            return op->getNumResults() != 0
+                && op->getNumRegions() == 0
+                && !mlir::isa< mlir::CallOpInterface >(op)
+                && !may_trap(op)
+                && mlir::MemoryEffectOpInterface::hasNoEffect(op);
+        }
+
+        // Compound statements of the loop are represented by nested scopes,
+        // invariants are hoisted from them as well.
+        void collect_regions(Region &region, llvm::SmallVectorImpl< Region * > &regions) {
+            regions.push_back(&region);
+            for (auto scope : region.getOps< ScopeOp >())
+                collect_regions(scope.getBody(), regions);
+        }
+
+        std::size_t hoist_invariants(mlir::LoopLikeOpInterface loop) {
+            llvm::SmallVector< Region * > regions;
+            for (auto &region : loop->getRegions())
+                collect_regions(region, regions);
+
+            return mlir::moveLoopInvariantCode(regions,
+                [&] (Value value, Region *) { return loop.isDefinedOutsideOfLoop(value); },
+                [&] (Operation *op, Region *) { return is_hoistable(op); },
+                [&] (Operation *op, Region *) { loop.moveOutOfLoop(op); }
+            );
+        }
+
+    } // namespace
+
+    struct HLLICMPass : HLLICMBase< HLLICMPass >
+    {
+        void runOnOperation() override {
+            // Post-order walk visits inner loops first, so the invariants
+            // hoisted from them can be hoisted further out of enclosing loops.
+            getOperation().walk([&] (Operation *op) {
+                if (mlir::isa< WhileOp, ForOp, DoOp >(op))
+                    hoist_invariants(mlir::cast< mlir::LoopLikeOpInterface >(op));
+            });
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLLICMPass()
+{
+    return std::make_unique< HLLICMPass >();
+}
@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <llvm/ADT/DenseSet.h>
 VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
@@ -340,10 +341,15 @@ namespace vast::hl
             mlir::SmallVector< mlir::NamedAttribute, 4 > out;
             for (const auto &attr : attrs)
             {
-                if (filter(attr))
-                    // TODO(lukas): Converter should accept & reconstruct NamedAttributes.
-                    if (auto x = getAttrConverter().convertAttr(attr.getValue()))
-                        out.emplace_back(attr.getName(), *x);
+                if (!filter(attr))
+                    continue;
+
+                // TODO(lukas): Converter should accept & reconstruct NamedAttributes.
+                // Attributes without types (e.g., inlining hints) are kept as they are.
+                if (auto x = getAttrConverter().convertAttr(attr.getValue()))
+                    out.emplace_back(attr.getName(), *x);
+                else
+                    out.push_back(attr);
             }
             return out;
         }
@@ -401,6 +407,7 @@ namespace vast::hl
             auto name = attr.getName();
             if (name == mlir::SymbolTable::getSymbolAttrName() ||
                 name == mlir::FunctionOpInterface::getTypeAttrName() ||
+                name == mlir::FunctionOpInterface::getArgDictAttrName() ||
                 name == "std.varargs")
             {
                 return false;
@@ -491,9 +498,120 @@ namespace vast::hl
         }
     };
 
+    namespace qualifiers
+    {
+        bool is_volatile_lvalue(mlir::Type t)
+        {
+            auto lvalue = t.dyn_cast< hl::LValueType >();
+            return lvalue && isVolatileQualified(lvalue.getElementType());
+        }
+
+        bool is_const_lvalue(mlir::Type t)
+        {
+            auto lvalue = t.dyn_cast< hl::LValueType >();
+            return lvalue && isConstQualified(lvalue.getElementType());
+        }
+
+        bool is_pointer_to_const(mlir::Type t)
+        {
+            if (auto lvalue = t.dyn_cast< hl::LValueType >())
+                t = lvalue.getElementType();
+            auto ptr = t.dyn_cast< hl::PointerType >();
+            return ptr && isConstQualified(ptr.getElementType());
+        }
+
+        bool is_read(mlir::Operation *op)
+        {
+            auto cast = mlir::dyn_cast< hl::ImplicitCastOp >(op);
+            return cast && cast.getKind() == hl::CastKind::LValueToRValue;
+        }
+
+        bool is_memory_access(mlir::Operation *op)
+        {
+            return is_read(op) || mlir::isa<
+                hl::AssignOp,
+                hl::AddIAssignOp, hl::AddFAssignOp, hl::SubIAssignOp, hl::SubFAssignOp,
+                hl::MulIAssignOp, hl::MulFAssignOp,
+                hl::DivSAssignOp, hl::DivUAssignOp, hl::DivFAssignOp,
+                hl::RemSAssignOp, hl::RemUAssignOp, hl::RemFAssignOp,
+                hl::BinAndAssignOp, hl::BinOrAssignOp, hl::BinXorAssignOp,
+                hl::BinShlAssignOp, hl::BinShrAssignOp,
+                hl::PostIncOp, hl::PostDecOp, hl::PreIncOp, hl::PreDecOp
+            >(op);
+        }
+
+        bool only_read(mlir::Operation *op)
+        {
+            return llvm::all_of(op->getUsers(), is_read);
+        }
+
+        // Pointer value is only compared or dereferenced to be read from.
+        bool is_readonly_pointer(mlir::Value ptr)
+        {
+            return llvm::all_of(ptr.getUsers(), [] (mlir::Operation *user) {
+                if (mlir::isa< hl::CmpOp >(user))
+                    return true;
+                return mlir::isa< hl::Deref >(user) && only_read(user);
+            });
+        }
+
+        // Conservative check that no memory is written through the argument: the
+        // parameter is only loaded (or subscripted) and the pointer does not
+        // escape anywhere else.
+        bool is_readonly_argument(mlir::BlockArgument arg)
+        {
+            auto readonly_use = [] (mlir::Operation *use) {
+                if (mlir::isa< hl::SubscriptOp >(use))
+                    return only_read(use);
+                return is_read(use) && is_readonly_pointer(use->getResult(0));
+            };
+
+            return llvm::all_of(arg.getUsers(), [&] (mlir::Operation *user) {
+                auto ref = mlir::dyn_cast< hl::DeclRefOp >(user);
+                return ref && llvm::all_of(ref->getUsers(), readonly_use);
+            });
+        }
+
+        void annotate_function(mlir::func::FuncOp fn, mlir::UnitAttr unit)
+        {
+            if (fn.empty())
+                return;
+
+            for (auto arg : fn.getArguments())
+                if (is_pointer_to_const(arg.getType()) && is_readonly_argument(arg))
+                    fn.setArgAttr(arg.getArgNumber(), readonly_attr_name, unit);
+        }
+
+        void annotate_var(hl::VarDeclOp var, mlir::UnitAttr unit)
+        {
+            if (is_volatile_lvalue(var.getType()))
+                var->setAttr(volatile_attr_name, unit);
+            bool file_scope = !var->getParentOfType< mlir::func::FuncOp >();
+            if (file_scope && is_const_lvalue(var.getType()))
+                var->setAttr(const_attr_name, unit);
+        }
+
+        void annotate(mlir::Operation *root)
+        {
+            auto unit = mlir::UnitAttr::get(root->getContext());
+            root->walk([&] (mlir::Operation *op) {
+                if (auto var = mlir::dyn_cast< hl::VarDeclOp >(op))
+                    return annotate_var(var, unit);
+                if (auto fn = mlir::dyn_cast< mlir::func::FuncOp >(op))
+                    return annotate_function(fn, unit);
+                if (is_memory_access(op) && llvm::any_of(op->getOperandTypes(), is_volatile_lvalue))
+                    op->setAttr(volatile_attr_name, unit);
+            });
+        }
+
+    } // namespace qualifiers
+
     struct HLLowerTypesPass : HLLowerTypesBase< HLLowerTypesPass >
     {
         void runOnOperation() override;
+
+        // Updates statistics of operations and types about to be lowered.
+        void count_lowered(mlir::Operation *root);
     };
 
     void HLLowerTypesPass::runOnOperation()
@@ -515,11 +633,35 @@ namespace vast::hl
                       LowerFuncOpType     >(type_converter, attr_converter,
                                             patterns.getContext());
 
+        qualifiers::annotate(op);
+
+        count_lowered(op);
+
         if (mlir::failed(mlir::applyPartialConversion(
                          op, trg, std::move(patterns))))
             return signalPassFailure();
     }
 
+    void HLLowerTypesPass::count_lowered(mlir::Operation *root)
+    {
+        llvm::DenseSet< mlir::Type > types;
+        auto collect = [&] (mlir::TypeRange range) {
+            for (auto type : range)
+                if (contains_hl_type(type))
+                    types.insert(type);
+        };
+
+        root->walk([&] (mlir::Operation *op) {
+            if (should_lower(op))
+                return;
+            ++ops_lowered;
+            collect(op->getResultTypes());
+            collect(op->getOperandTypes());
+        });
+
+        types_lowered = types.size();
+    }
+
     mlir::Block &solo_block(mlir::Region &region)
     {
         VAST_ASSERT(region.hasOneBlock());
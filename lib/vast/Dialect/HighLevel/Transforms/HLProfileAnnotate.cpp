@@ -0,0 +1,357 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/IR/Builders.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+#include "ProfileCounters.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace vast::hl
+{
+    namespace
+    {
+        using profile_counts = std::vector< uint64_t >;
+
+        // Records of the same name differ in the hash of the function, which
+        // is computed from the clang ast and cannot be recomputed from the
+        // high-level dialect.
+        using profile = llvm::StringMap< llvm::SmallVector< profile_counts, 1 > >;
+
+        llvm::Expected< std::unique_ptr< llvm::InstrProfReader > > open_profile(llvm::StringRef path)
+        {
+            auto buffer = llvm::MemoryBuffer::getFileOrSTDIN(path);
+            if (auto ec = buffer.getError())
+                return llvm::errorCodeToError(ec);
+
+            if (llvm::IndexedInstrProfReader::hasFormat(**buffer)) {
+                auto reader = llvm::IndexedInstrProfReader::create(std::move(*buffer));
+                if (!reader)
+                    return reader.takeError();
+                return std::unique_ptr< llvm::InstrProfReader >(std::move(*reader));
+            }
+
+            return llvm::InstrProfReader::create(std::move(*buffer));
+        }
+
+        llvm::Expected< profile > read_profile(llvm::StringRef path)
+        {
+            auto reader = open_profile(path);
+            if (!reader)
+                return reader.takeError();
+
+            // Counters of profiles of llvm ir instrumentation do not correspond
+            // to statements.
+            if ((*reader)->isIRLevelProfile())
+                return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                               "unsupported profile of ir level instrumentation");
+
+            profile result;
+            for (const auto &record : **reader)
+                result[record.Name].push_back(record.Counts);
+
+            if ((*reader)->hasError())
+                return (*reader)->getError();
+            return result;
+        }
+
+        // Labels of a switch in the order of their appearance, labels of
+        // nested switches belong to those.
+        void collect_labels(mlir::Region &region, llvm::SmallVectorImpl< mlir::Operation * > &labels)
+        {
+            for (auto &block : region)
+                for (auto &op : block) {
+                    if (mlir::isa< SwitchOp >(op))
+                        continue;
+                    if (mlir::isa< CaseOp, DefaultOp >(op))
+                        labels.push_back(&op);
+                    for (auto &nested : op.getRegions())
+                        collect_labels(nested, labels);
+                }
+        }
+
+        //
+        // Propagates counts of regions through statements, the same way clang
+        // does, to derive counts of edges that have no counter of their own,
+        // such as the exit of a loop or the else branch of `if`.
+        //
+        struct count_propagation
+        {
+            const llvm::MapVector< mlir::Operation *, unsigned > &counters;
+            llvm::ArrayRef< uint64_t > counts;
+            mlir::Builder bld;
+
+            struct jump_totals
+            {
+                uint64_t breaks = 0;
+                uint64_t continues = 0;
+            };
+
+            llvm::SmallVector< jump_totals > jump_counts;
+            uint64_t current = counts.front();
+
+            uint64_t counter(mlir::Operation *op) const
+            {
+                return counts[counters.lookup(op)];
+            }
+
+            static uint64_t sub(uint64_t lhs, uint64_t rhs) { return lhs > rhs ? lhs - rhs : 0; }
+
+            // Weights are scaled to fit signed 32 bits of the attribute, a zero
+            // weight is avoided as llvm would consider the edge never taken.
+            void annotate(mlir::Operation *op, llvm::ArrayRef< uint64_t > weights)
+            {
+                auto max = *std::max_element(weights.begin(), weights.end());
+                if (max == 0)
+                    return;
+
+                uint64_t limit = std::numeric_limits< int32_t >::max() - 1;
+                auto scale = max < limit ? 1 : max / limit + 1;
+
+                llvm::SmallVector< int32_t > scaled;
+                for (auto weight : weights)
+                    scaled.push_back(int32_t(weight / scale + 1));
+                op->setAttr(branch_weights_attr_name, bld.getI32ArrayAttr(scaled));
+            }
+
+            void annotate_loop(mlir::Operation *op, uint64_t loop, uint64_t cond)
+            {
+                annotate(op, { loop, std::max(cond, loop) - loop });
+            }
+
+            void visit(mlir::Region &region)
+            {
+                for (auto &block : region)
+                    for (auto &op : block)
+                        visit(&op);
+            }
+
+            void visit(mlir::Operation *op)
+            {
+                llvm::TypeSwitch< mlir::Operation *, void >(op)
+                    .Case< ReturnOp, GotoStmt >([&] (auto) { current = 0; })
+                    .Case([&] (BreakOp) {
+                        if (!jump_counts.empty())
+                            jump_counts.back().breaks += current;
+                        current = 0;
+                    })
+                    .Case([&] (ContinueOp) {
+                        if (!jump_counts.empty())
+                            jump_counts.back().continues += current;
+                        current = 0;
+                    })
+                    .Case([&] (LabelStmt stmt) {
+                        current = counter(stmt);
+                        visit(stmt.getSubstmt());
+                    })
+                    .Case([&] (IfOp stmt) { visit_if(stmt); })
+                    .Case([&] (WhileOp stmt) { visit_while(stmt); })
+                    .Case([&] (ForOp stmt) { visit_for(stmt); })
+                    .Case([&] (DoOp stmt) { visit_do(stmt); })
+                    .Case([&] (SwitchOp stmt) { visit_switch(stmt); })
+                    .Case< CaseOp, DefaultOp >([&] (auto label) {
+                        // The counter of a label counts only jumps from the
+                        // switch, not the fallthrough from the previous case.
+                        current += counter(label);
+                        visit(label.getBody());
+                    })
+                    .Default([&] (mlir::Operation *) {
+                        for (auto &region : op->getRegions())
+                            visit(region);
+                    });
+            }
+
+            void visit_if(IfOp op)
+            {
+                visit(op.getCondRegion());
+                auto parent = current;
+                auto then_count = current = counter(op);
+                visit(op.getThenRegion());
+
+                auto out = current;
+                auto else_count = sub(parent, then_count);
+                if (op.hasElse()) {
+                    current = else_count;
+                    visit(op.getElseRegion());
+                    out += current;
+                } else {
+                    out += else_count;
+                }
+
+                current = out;
+                annotate(op, { then_count, else_count });
+            }
+
+            // The body is visited first, so that the count of the condition
+            // includes the backedge and continues.
+            void visit_while(WhileOp op)
+            {
+                auto parent = current;
+                jump_counts.emplace_back();
+                auto body = current = counter(op);
+                visit(op.getBodyRegion());
+
+                auto backedge = current;
+                auto jumps = jump_counts.pop_back_val();
+                auto cond = current = parent + backedge + jumps.continues;
+                visit(op.getCondRegion());
+
+                current = sub(jumps.breaks + cond, body);
+                annotate_loop(op, body, cond);
+            }
+
+            void visit_for(ForOp op)
+            {
+                auto parent = current;
+                jump_counts.emplace_back();
+                auto body = current = counter(op);
+                visit(op.getBodyRegion());
+
+                auto backedge = current;
+                auto jumps = jump_counts.pop_back_val();
+                current = backedge + jumps.continues;
+                visit(op.getIncrRegion());
+
+                auto cond = current = parent + backedge + jumps.continues;
+                visit(op.getCondRegion());
+
+                current = sub(jumps.breaks + cond, body);
+                annotate_loop(op, body, cond);
+            }
+
+            // The counter of `do` counts only the backedge, not the entry
+            // from the parent.
+            void visit_do(DoOp op)
+            {
+                auto loop = counter(op);
+                jump_counts.emplace_back();
+                current += loop;
+                visit(op.getBodyRegion());
+
+                auto backedge = current;
+                auto jumps = jump_counts.pop_back_val();
+                auto cond = current = backedge + jumps.continues;
+                visit(op.getCondRegion());
+
+                current = sub(jumps.breaks + cond, loop);
+                annotate_loop(op, loop, cond);
+            }
+
+            // The counter of `switch` counts its exit.
+            void visit_switch(SwitchOp op)
+            {
+                visit(op.getCondRegion());
+                current = 0;
+                jump_counts.emplace_back();
+                for (auto &region : op.getCases())
+                    visit(region);
+
+                auto jumps = jump_counts.pop_back_val();
+                if (!jump_counts.empty())
+                    jump_counts.back().continues += jumps.continues;
+                current = counter(op);
+
+                llvm::SmallVector< mlir::Operation * > labels;
+                for (auto &region : op.getCases())
+                    collect_labels(region, labels);
+
+                llvm::SmallVector< uint64_t > weights = { 0 };
+                for (auto label : labels) {
+                    if (mlir::isa< DefaultOp >(label))
+                        weights.front() = counter(label);
+                    else
+                        weights.push_back(counter(label));
+                }
+                annotate(op, weights);
+            }
+        };
+
+    } // namespace
+
+    struct HLProfileAnnotatePass : HLProfileAnnotateBase< HLProfileAnnotatePass >
+    {
+        void runOnOperation() override
+        {
+            auto mod = getOperation();
+            if (profile_path.empty()) {
+                mod.emitError("missing path to the profile");
+                return signalPassFailure();
+            }
+
+            auto data = read_profile(profile_path);
+            if (!data) {
+                mod.emitError("unable to read profile '") << llvm::StringRef(profile_path) << "': "
+                    << llvm::toString(data.takeError());
+                return signalPassFailure();
+            }
+
+            util::functions(mod, [&] (mlir::func::FuncOp fn) {
+                if (!fn.isDeclaration())
+                    annotate(fn, *data);
+            });
+        }
+
+        // Profile names of functions with internal linkage are prefixed by
+        // the name of their file.
+        const llvm::SmallVector< profile_counts, 1 > *lookup(mlir::func::FuncOp fn, const profile &data)
+        {
+            auto loc = file_location(fn.getLoc());
+            auto file = loc ? loc.getFilename().getValue() : llvm::StringRef();
+            for (auto name : { (file + ":" + fn.getName()).str(),
+                               (llvm::sys::path::filename(file) + ":" + fn.getName()).str(),
+                               fn.getName().str() })
+            {
+                if (auto it = data.find(name); it != data.end())
+                    return &it->second;
+            }
+            return nullptr;
+        }
+
+        void annotate(mlir::func::FuncOp fn, const profile &data)
+        {
+            auto records = lookup(fn, data);
+            if (!records)
+                return;
+
+            counter_numbering numbering;
+            numbering.number(fn.getBody());
+
+            auto counts = llvm::find_if(*records, [&] (const auto &record) {
+                return record.size() == numbering.next;
+            });
+
+            if (counts == records->end()) {
+                fn.emitWarning("profile of function does not match its statements");
+                return;
+            }
+
+            mlir::Builder bld(fn.getContext());
+            fn->setAttr(entry_count_attr_name, bld.getI64IntegerAttr(int64_t(counts->front())));
+
+            count_propagation propagation{ numbering.counters, *counts, bld };
+            propagation.visit(fn.getBody());
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLProfileAnnotatePass()
+{
+    return std::make_unique< HLProfileAnnotatePass >();
+}
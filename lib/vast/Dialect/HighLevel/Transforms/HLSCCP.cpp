@@ -0,0 +1,640 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <map>
+#include <optional>
+
+namespace vast::hl
+{
+    //
+    // Sparse conditional constant propagation
+    //
+    // Regions of high-level control flow operations are interpreted in the
+    // order of their execution. Each value is either unknown (not yet reached),
+    // a constant or overdefined. Promotable local variables, i.e., variables
+    // that are only loaded and assigned to, carry the same lattice along the
+    // paths of the function. Only the taken branches of conditions with
+    // a constant value are followed, loops are iterated until the values of
+    // variables on their entry do not change.
+    //
+    // Functions with `goto` or case labels nested in other statements than
+    // labels and scopes are left as they are.
+    //
+    namespace
+    {
+        struct lattice
+        {
+            enum class kind { unknown, constant, overdefined };
+
+            kind state = kind::unknown;
+            Attribute value = {};
+
+            static lattice overdefined() { return { kind::overdefined }; }
+
+            static lattice constant(Attribute attr) {
+                return attr ? lattice{ kind::constant, attr } : overdefined();
+            }
+
+            bool is_unknown() const { return state == kind::unknown; }
+            bool is_constant() const { return state == kind::constant; }
+
+            // Returns whether the lattice has changed.
+            bool join(const lattice &other) {
+                if (other.is_unknown() || *this == other || state == kind::overdefined)
+                    return false;
+                *this = is_unknown() ? other : overdefined();
+                return true;
+            }
+
+            bool operator==(const lattice &) const = default;
+        };
+
+        // Values of promotable variables at a point of the function,
+        // `std::nullopt` if the point is not reachable.
+        using environment = std::optional< std::map< Operation *, lattice > >;
+
+        environment join(environment lhs, const environment &rhs) {
+            if (!rhs)
+                return lhs;
+            if (!lhs)
+                return rhs;
+            for (const auto &[var, value] : *rhs)
+                (*lhs)[var].join(value);
+            return lhs;
+        }
+
+        std::optional< bool > truth(const lattice &value) {
+            if (!value.is_constant())
+                return std::nullopt;
+            if (auto attr = value.value.dyn_cast< IntegerAttr >())
+                return !attr.getValue().isZero();
+            if (auto attr = value.value.dyn_cast< BooleanAttr >())
+                return attr.getValue();
+            return std::nullopt;
+        }
+
+        Value yielded(Region &region) {
+            if (region.empty() || region.front().empty())
+                return {};
+            auto &term = region.front().back();
+            if (auto yield = mlir::dyn_cast< CondYieldOp >(term))
+                return yield.getResult();
+            if (auto yield = mlir::dyn_cast< ValueYieldOp >(term))
+                return yield.getResult();
+            return {};
+        }
+
+        VarDeclOp referenced_var(Value lvalue) {
+            if (auto ref = lvalue.getDefiningOp< DeclRefOp >())
+                return ref.getDecl().getDefiningOp< VarDeclOp >();
+            return {};
+        }
+
+        // Variables that are only loaded and assigned to, so their value
+        // cannot change behind the back of the analysis.
+        bool is_promotable_var(VarDeclOp var) {
+            if (!var.hasLocalStorage())
+                return false;
+
+            auto type = var.getType().dyn_cast< LValueType >();
+            if (!type || isVolatileQualified(type.getElementType()))
+                return false;
+
+            for (auto user : var->getUsers()) {
+                auto ref = mlir::dyn_cast< DeclRefOp >(user);
+                if (!ref)
+                    return false;
+
+                for (auto &use : ref->getUses()) {
+                    auto owner = use.getOwner();
+                    if (auto load = mlir::dyn_cast< ImplicitCastOp >(owner))
+                        if (load.getKind() == CastKind::LValueToRValue)
+                            continue;
+                    if (auto assign = mlir::dyn_cast< AssignOp >(owner))
+                        if (use.get() == assign.getDst() && assign.getSrc() != assign.getDst())
+                            continue;
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // Gotos and case labels nested in conditionals or loops jump into
+        // the middle of statements, which the analysis does not follow.
+        bool is_structured(Operation *fn) {
+            auto result = fn->walk([] (Operation *op) {
+                if (mlir::isa< GotoStmt, LabelStmt >(op))
+                    return mlir::WalkResult::interrupt();
+
+                if (mlir::isa< CaseOp, DefaultOp >(op)) {
+                    for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp()) {
+                        if (mlir::isa< SwitchOp >(parent))
+                            break;
+                        if (!mlir::isa< CaseOp, DefaultOp, ScopeOp >(parent))
+                            return mlir::WalkResult::interrupt();
+                    }
+                }
+
+                return mlir::WalkResult::advance();
+            });
+            return !result.wasInterrupted();
+        }
+
+        struct sccp_analysis
+        {
+            explicit sccp_analysis(Operation *function) : fn(function) {
+                fn->walk([&] (VarDeclOp var) {
+                    if (is_promotable_var(var))
+                        promotable.insert(var);
+                });
+            }
+
+            Operation *fn;
+            llvm::DenseSet< Operation * > promotable;
+            llvm::DenseMap< Value, lattice > values;
+
+            // States at `break` and `continue` of loops and switches, and on
+            // entry of switches for their labels.
+            llvm::DenseMap< Operation *, environment > breaks, continues, entries;
+
+            lattice get(Value value) const {
+                // Arguments and values defined outside of the function can
+                // be anything.
+                if (value.isa< mlir::BlockArgument >() || !fn->isProperAncestor(value.getDefiningOp()))
+                    return lattice::overdefined();
+                auto it = values.find(value);
+                return it != values.end() ? it->second : lattice{};
+            }
+
+            void set(Value value, lattice state) { values[value].join(state); }
+
+            void set_overdefined(Operation *op) {
+                for (auto result : op->getResults())
+                    set(result, lattice::overdefined());
+            }
+
+            bool is_tracked(VarDeclOp var) const {
+                return var && promotable.contains(var);
+            }
+
+            environment take(llvm::DenseMap< Operation *, environment > &states, Operation *op) {
+                auto state = std::move(states[op]);
+                states.erase(op);
+                return state;
+            }
+
+            void run() {
+                for (auto &region : fn->getRegions())
+                    visit(region, environment(std::in_place));
+            }
+
+            environment visit(Region &region, environment env) {
+                for (auto &block : region)
+                    env = visit(block, std::move(env));
+                return env;
+            }
+
+            // Unreachable operations are visited too, as labels of a switch
+            // make the code after them reachable again.
+            environment visit(Block &block, environment env) {
+                for (auto &op : block)
+                    env = visit(&op, std::move(env));
+                return env;
+            }
+
+            environment visit(Operation *operation, environment env) {
+                if (!env && !mlir::isa< ScopeOp, CaseOp, DefaultOp >(operation))
+                    return env;
+
+                return llvm::TypeSwitch< Operation *, environment >(operation)
+                    .Case([&] (VarDeclOp var) { return visit_var(var, std::move(env)); })
+                    .Case([&] (ImplicitCastOp cast) { return visit_cast(cast, std::move(env)); })
+                    .Case([&] (AssignOp assign) { return visit_assign(assign, std::move(env)); })
+                    .Case([&] (ScopeOp scope) { return visit(scope.getBody(), std::move(env)); })
+                    .Case([&] (ExprOp expr) {
+                        env = visit(expr.getSubexpr(), std::move(env));
+                        if (auto value = yielded(expr.getSubexpr()))
+                            set(expr.getResult(), get(value));
+                        else
+                            set_overdefined(expr);
+                        return env;
+                    })
+                    .Case([&] (IfOp op) { return visit_if(op, std::move(env)); })
+                    .Case([&] (WhileOp loop) {
+                        return visit_loop(
+                            loop, loop.getCondRegion(), loop.getBodyRegion(), nullptr, false, std::move(env)
+                        );
+                    })
+                    .Case([&] (ForOp loop) {
+                        return visit_loop(
+                            loop, loop.getCondRegion(), loop.getBodyRegion(), &loop.getIncrRegion(), false,
+                            std::move(env)
+                        );
+                    })
+                    .Case([&] (DoOp loop) {
+                        return visit_loop(
+                            loop, loop.getCondRegion(), loop.getBodyRegion(), nullptr, true, std::move(env)
+                        );
+                    })
+                    .Case([&] (SwitchOp sw) { return visit_switch(sw, std::move(env)); })
+                    .Case< CaseOp, DefaultOp >([&] (auto label) {
+                        auto sw = label->template getParentOfType< SwitchOp >();
+                        env = join(std::move(env), entries.lookup(sw));
+                        return visit(label.getBody(), std::move(env));
+                    })
+                    .Case([&] (BreakOp jump) {
+                        auto target = jump_target(jump);
+                        breaks[target] = join(std::move(breaks[target]), env);
+                        return environment();
+                    })
+                    .Case([&] (ContinueOp jump) {
+                        auto target = jump_target(jump);
+                        continues[target] = join(std::move(continues[target]), env);
+                        return environment();
+                    })
+                    .Case([&] (ReturnOp) { return environment(); })
+                    .Default([&] (Operation *op) { return visit_operation(op, std::move(env)); });
+            }
+
+            environment visit_var(VarDeclOp var, environment env) {
+                env = visit(var.getInitializer(), std::move(env));
+                env = visit(var.getAllocationSize(), std::move(env));
+                set_overdefined(var);
+
+                if (env && is_tracked(var)) {
+                    auto init = yielded(var.getInitializer());
+                    (*env)[var] = init ? get(init) : lattice::overdefined();
+                }
+                return env;
+            }
+
+            environment visit_cast(ImplicitCastOp cast, environment env) {
+                auto var = referenced_var(cast.getValue());
+                if (cast.getKind() != CastKind::LValueToRValue || !is_tracked(var))
+                    return visit_operation(cast, std::move(env));
+
+                auto it = env->find(var);
+                set(cast.getResult(), it != env->end() ? it->second : lattice::overdefined());
+                return env;
+            }
+
+            environment visit_assign(AssignOp assign, environment env) {
+                auto value = get(assign.getSrc());
+                if (auto var = referenced_var(assign.getDst()); is_tracked(var))
+                    (*env)[var] = value;
+                set(assign.getResult(), value);
+                return env;
+            }
+
+            // Operations without nested control flow are folded when the
+            // values of their operands are known.
+            environment visit_operation(Operation *op, environment env) {
+                if (op->getNumRegions() != 0) {
+                    // Regions of unknown operations are not followed, hence
+                    // variables assigned in them can be anything.
+                    op->walk([&] (AssignOp assign) {
+                        if (auto var = referenced_var(assign.getDst()); is_tracked(var))
+                            (*env)[var] = lattice::overdefined();
+                    });
+                    set_overdefined(op);
+                    return env;
+                }
+
+                if (op->getNumResults() == 0)
+                    return env;
+
+                llvm::SmallVector< Attribute > operands;
+                for (auto operand : op->getOperands()) {
+                    auto state = get(operand);
+                    if (state.is_unknown())
+                        return env;
+                    operands.push_back(state.value);
+                }
+
+                llvm::SmallVector< mlir::OpFoldResult > results;
+                if (!mlir::MemoryEffectOpInterface::hasNoEffect(op)
+                    || mlir::failed(op->fold(operands, results))
+                    || results.size() != op->getNumResults()
+                ) {
+                    set_overdefined(op);
+                    return env;
+                }
+
+                for (auto [result, folded] : llvm::zip(op->getResults(), results)) {
+                    if (auto attr = folded.dyn_cast< Attribute >())
+                        set(result, lattice::constant(attr));
+                    else
+                        set(result, get(folded.get< Value >()));
+                }
+                return env;
+            }
+
+            // Successors of a condition that may be taken.
+            struct edges { bool on_true = false; bool on_false = false; };
+
+            edges successors(Region &cond) const {
+                auto value = yielded(cond);
+                auto state = value ? get(value) : lattice::overdefined();
+                if (state.is_unknown())
+                    return {};
+                if (auto taken = truth(state))
+                    return { *taken, !*taken };
+                return { true, true };
+            }
+
+            environment when(bool taken, const environment &env) {
+                return taken ? env : environment();
+            }
+
+            environment visit_if(IfOp op, environment env) {
+                env = visit(op.getCondRegion(), std::move(env));
+                auto [on_true, on_false] = successors(op.getCondRegion());
+
+                auto then_env = visit(op.getThenRegion(), when(on_true, env));
+                auto else_env = visit(op.getElseRegion(), when(on_false, env));
+                return join(std::move(then_env), else_env);
+            }
+
+            // Iterates the loop until the values of variables at its head,
+            // i.e., on entry of the condition (or of the body of `do`), are
+            // stable.
+            environment visit_loop(
+                Operation *loop, Region &cond, Region &body, Region *incr, bool body_first, environment env
+            ) {
+                environment head = env;
+                while (true) {
+                    breaks.erase(loop);
+                    continues.erase(loop);
+
+                    environment latch, exit;
+                    if (body_first) {
+                        auto next = visit(body, head);
+                        next = join(std::move(next), take(continues, loop));
+                        next = visit(cond, std::move(next));
+                        auto [on_true, on_false] = successors(cond);
+                        latch = when(on_true, next);
+                        exit = when(on_false, next);
+                    } else {
+                        auto next = visit(cond, head);
+                        auto [on_true, on_false] = successors(cond);
+                        exit = when(on_false, next);
+                        latch = visit(body, when(on_true, next));
+                        latch = join(std::move(latch), take(continues, loop));
+                        if (incr)
+                            latch = visit(*incr, std::move(latch));
+                    }
+
+                    exit = join(std::move(exit), take(breaks, loop));
+
+                    auto next_head = join(head, latch);
+                    if (next_head == head)
+                        return exit;
+                    head = std::move(next_head);
+                }
+            }
+
+            environment visit_switch(SwitchOp op, environment env) {
+                env = visit(op.getCondRegion(), std::move(env));
+                auto value = yielded(op.getCondRegion());
+                if (!env || (value && get(value).is_unknown()))
+                    return environment();
+
+                // Labels join the state on entry of the switch, statements
+                // before the first label are not reachable.
+                entries[op] = env;
+                breaks.erase(op);
+
+                environment flow;
+                for (auto &region : op.getCases())
+                    flow = visit(region, std::move(flow));
+
+                auto has_default = op->walk([&] (DefaultOp label) {
+                    return label->getParentOfType< SwitchOp >() == op
+                        ? mlir::WalkResult::interrupt()
+                        : mlir::WalkResult::advance();
+                }).wasInterrupted();
+
+                flow = join(std::move(flow), take(breaks, op));
+                return has_default ? flow : join(std::move(flow), env);
+            }
+        };
+
+        // Replaces control flow operation by a scope containing operations of
+        // the given regions in order. Condition yields are dropped, the
+        // condition is still evaluated for its side effects.
+        void replace_with_scope(Operation *op, llvm::ArrayRef< Region * > regions, mlir::RewriterBase &rewriter) {
+            rewriter.setInsertionPoint(op);
+            auto scope = rewriter.create< ScopeOp >(op->getLoc());
+            auto block = rewriter.createBlock(&scope.getBody());
+
+            for (auto region : regions) {
+                if (region->empty())
+                    continue;
+
+                auto &front = region->front();
+                if (!front.empty() && mlir::isa< CondYieldOp >(front.back()))
+                    rewriter.eraseOp(&front.back());
+                rewriter.mergeBlocks(&front, block);
+            }
+
+            rewriter.eraseOp(op);
+        }
+
+        bool has_jumps_to(Operation *loop) {
+            auto result = loop->walk([&] (Operation *op) {
+                if (mlir::isa< BreakOp, ContinueOp >(op) && jump_target(op) == loop)
+                    return mlir::WalkResult::interrupt();
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        bool ends_with_terminator(Region &region) {
+            return !region.empty() && !region.front().empty()
+                && region.front().back().hasTrait< mlir::OpTrait::IsTerminator >();
+        }
+
+        struct sccp_rewriter
+        {
+            sccp_rewriter(sccp_analysis &analysis, mlir::MLIRContext *mctx)
+                : analysis(analysis), rewriter(mctx)
+            {}
+
+            sccp_analysis &analysis;
+            mlir::IRRewriter rewriter;
+
+            std::optional< bool > condition(Region &cond) const {
+                auto value = yielded(cond);
+                return value ? truth(analysis.get(value)) : std::nullopt;
+            }
+
+            // Uses of values with a constant lattice are replaced by the
+            // constant, the operations themselves are left to the folding.
+            void replace_constants() {
+                analysis.fn->walk([&] (Operation *op) {
+                    if (op->hasTrait< mlir::OpTrait::ConstantLike >())
+                        return;
+
+                    auto dialect = op->getDialect();
+                    for (auto result : op->getResults()) {
+                        auto state = analysis.get(result);
+                        if (!state.is_constant() || result.use_empty() || !dialect)
+                            continue;
+
+                        rewriter.setInsertionPoint(op);
+                        auto constant = dialect->materializeConstant(
+                            rewriter, state.value, result.getType(), op->getLoc()
+                        );
+                        if (constant)
+                            result.replaceAllUsesWith(constant->getResult(0));
+                    }
+                });
+            }
+
+            // Branches that are never taken are removed. Conditions that were
+            // never evaluated lie in unreachable code and are kept. Nested
+            // operations are visited first, so none of them is erased with
+            // its parent before it is visited.
+            void remove_dead_branches() {
+                llvm::SmallVector< Operation * > ops;
+                analysis.fn->walk< mlir::WalkOrder::PostOrder >([&] (Operation *op) {
+                    if (mlir::isa< IfOp, WhileOp, ForOp, DoOp >(op))
+                        ops.push_back(op);
+                });
+
+                for (auto op : ops) {
+                    llvm::TypeSwitch< Operation *, void >(op)
+                        .Case([&] (IfOp branch) {
+                            if (auto cond = condition(branch.getCondRegion())) {
+                                auto &taken = *cond ? branch.getThenRegion() : branch.getElseRegion();
+                                replace_with_scope(branch, { &branch.getCondRegion(), &taken }, rewriter);
+                            }
+                        })
+                        .Case< WhileOp, ForOp >([&] (auto loop) {
+                            // The condition of a loop is the join over all its
+                            // iterations, hence false means the loop is never entered.
+                            auto cond = condition(loop.getCondRegion());
+                            if (cond && !*cond)
+                                replace_with_scope(loop, { &loop.getCondRegion() }, rewriter);
+                        })
+                        .Case([&] (DoOp loop) {
+                            auto cond = condition(loop.getCondRegion());
+                            if (!cond || *cond || has_jumps_to(loop))
+                                return;
+
+                            auto &body = loop.getBodyRegion();
+                            if (ends_with_terminator(body))
+                                replace_with_scope(loop, { &body }, rewriter);
+                            else
+                                replace_with_scope(loop, { &body, &loop.getCondRegion() }, rewriter);
+                        });
+                }
+            }
+
+            // Variables that are not loaded anymore are removed together with
+            // the assignments to them, unless the value of an assignment is used.
+            // Variables are collected anew, as some were erased with dead branches.
+            void remove_dead_vars() {
+                llvm::SmallVector< VarDeclOp > vars;
+                analysis.fn->walk([&] (VarDeclOp var) {
+                    if (is_promotable_var(var))
+                        vars.push_back(var);
+                });
+
+                for (auto var : vars) {
+                    llvm::SmallVector< Operation * > dead;
+                    auto is_dead = llvm::all_of(var->getUsers(), [&] (Operation *ref) {
+                        dead.push_back(ref);
+                        return llvm::all_of(ref->getUsers(), [&] (Operation *user) {
+                            auto assign = mlir::dyn_cast< AssignOp >(user);
+                            if (!assign || !assign.getResult().use_empty())
+                                return false;
+                            dead.push_back(assign);
+                            return true;
+                        });
+                    });
+
+                    if (!is_dead)
+                        continue;
+
+                    for (auto user : llvm::reverse(dead))
+                        rewriter.eraseOp(user);
+
+                    auto is_pure = [] (Operation &op) {
+                        return op.getNumRegions() == 0 && mlir::MemoryEffectOpInterface::hasNoEffect(&op);
+                    };
+
+                    auto &init = var.getInitializer();
+                    if (init.empty() || llvm::all_of(init.front().without_terminator(), is_pure))
+                        rewriter.eraseOp(var);
+                }
+            }
+        };
+
+        struct erase_empty_scope : mlir::OpRewritePattern< ScopeOp >
+        {
+            using base = mlir::OpRewritePattern< ScopeOp >;
+            using base::base;
+
+            mlir::LogicalResult matchAndRewrite(ScopeOp op, mlir::PatternRewriter &rewriter) const override {
+                auto is_empty = [] (mlir::Block &block) { return block.empty(); };
+                if (!llvm::all_of(op.getBody(), is_empty))
+                    return mlir::failure();
+
+                rewriter.eraseOp(op);
+                return mlir::success();
+            }
+        };
+
+    } // namespace
+
+    struct HLSCCPPass : HLSCCPBase< HLSCCPPass >
+    {
+        void runOnOperation() override {
+            auto &mctx = getContext();
+
+            mlir::RewritePatternSet patterns(&mctx);
+            patterns.add< erase_empty_scope >(&mctx);
+            mlir::FrozenRewritePatternSet frozen(std::move(patterns));
+
+            for (auto fn : getOperation().getOps< mlir::FunctionOpInterface >()) {
+                if (fn.isExternal() || !is_structured(fn))
+                    continue;
+
+                sccp_analysis analysis(fn);
+                analysis.run();
+
+                sccp_rewriter rewriter(analysis, &mctx);
+                rewriter.replace_constants();
+                rewriter.remove_dead_branches();
+
+                // Folding removes loads and computations whose uses were
+                // replaced, which leaves variables that are only assigned.
+                (void) mlir::applyPatternsAndFoldGreedily(fn, frozen);
+                rewriter.remove_dead_vars();
+                (void) mlir::applyPatternsAndFoldGreedily(fn, frozen);
+            }
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLSCCPPass()
+{
+    return std::make_unique< HLSCCPPass >();
+}
@@ -0,0 +1,478 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Affine/IR/AffineOps.h>
+#include <mlir/Dialect/Arithmetic/IR/Arithmetic.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/IR/Matchers.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <optional>
+
+namespace vast::hl
+{
+    namespace
+    {
+        std::optional< int64_t > constant_value(mlir::Value value)
+        {
+            mlir::Attribute attr;
+            if (!value || !mlir::matchPattern(value, mlir::m_Constant(&attr)))
+                return std::nullopt;
+
+            auto integer = attr.dyn_cast< IntegerAttr >();
+            if (!integer)
+                return std::nullopt;
+
+            auto apval = integer.getValue();
+            if (apval.isSigned() ? apval.getMinSignedBits() > 64 : apval.getActiveBits() > 63)
+                return std::nullopt;
+            return apval.getExtValue();
+        }
+
+        bool is_load(mlir::Operation *op)
+        {
+            auto cast = mlir::dyn_cast< ImplicitCastOp >(op);
+            return cast && cast.getKind() == CastKind::LValueToRValue;
+        }
+
+        // Returns the variable read by `value`, if it is a plain load of it.
+        VarDeclOp loaded_var(mlir::Value value)
+        {
+            auto load = value.getDefiningOp();
+            if (!load || !is_load(load))
+                return {};
+
+            auto ref = mlir::cast< ImplicitCastOp >(load).getValue().getDefiningOp< DeclRefOp >();
+            if (!ref)
+                return {};
+            return ref.getDecl().getDefiningOp< VarDeclOp >();
+        }
+
+        mlir::Value init_value(VarDeclOp var)
+        {
+            auto &init = var.getInitializer();
+            if (init.empty() || init.front().empty())
+                return {};
+
+            auto yield = mlir::dyn_cast< ValueYieldOp >(init.front().back());
+            return yield ? yield.getResult() : mlir::Value();
+        }
+
+        bool is_plain_local(VarDeclOp var)
+        {
+            return var.hasLocalStorage() && !var->hasAttr(volatile_attr_name)
+                && var.getAllocationSize().empty();
+        }
+
+        //
+        // counted loops
+        //
+        // `for (int i = lb; i < ub; i += step)` with constant bounds and step,
+        // whose induction variable is declared by the loop, only read by its
+        // body and which is left only through its condition.
+        //
+        struct counted_loop
+        {
+            ForOp op;
+            VarDeclOp iv;
+            int64_t lb, ub, step;
+        };
+
+        std::optional< int64_t > match_step(ForOp op, VarDeclOp iv)
+        {
+            auto &incr = op.getIncrRegion();
+            if (incr.empty())
+                return std::nullopt;
+
+            auto is_iv_ref = [&] (mlir::Value value) {
+                auto ref = value.getDefiningOp< DeclRefOp >();
+                return ref && ref.getDecl() == iv.getResult();
+            };
+
+            std::optional< int64_t > step;
+            for (auto &nested : incr.front()) {
+                if (mlir::isa< DeclRefOp, ConstantOp >(nested))
+                    continue;
+
+                if (step)
+                    return std::nullopt;
+
+                if (mlir::isa< PreIncOp, PostIncOp >(nested) && is_iv_ref(nested.getOperand(0))) {
+                    step = 1;
+                } else if (auto add = mlir::dyn_cast< AddIAssignOp >(nested); add && is_iv_ref(add.getDst())) {
+                    step = constant_value(add.getSrc());
+                    if (!step)
+                        return std::nullopt;
+                } else {
+                    return std::nullopt;
+                }
+            }
+
+            if (!step || *step <= 0)
+                return std::nullopt;
+            return step;
+        }
+
+        // Upper bound of the induction variable given by the loop condition.
+        std::optional< int64_t > match_upper_bound(CmpOp cmp, int64_t lb, int64_t step)
+        {
+            auto bound = constant_value(cmp.getRhs());
+            if (!bound)
+                return std::nullopt;
+
+            switch (cmp.getPredicate()) {
+                case Predicate::slt:
+                    return bound;
+                case Predicate::sle:
+                    return *bound + 1;
+                case Predicate::ult:
+                    return lb >= 0 && *bound >= 0 ? bound : std::nullopt;
+                case Predicate::ule:
+                    return lb >= 0 && *bound >= 0 ? std::optional(*bound + 1) : std::nullopt;
+                case Predicate::ne:
+                    return step == 1 && lb <= *bound ? bound : std::nullopt;
+                default:
+                    return std::nullopt;
+            }
+        }
+
+        // The induction variable is not used outside of the loop and the
+        // body only reads it.
+        bool is_loop_local(VarDeclOp iv, ForOp op)
+        {
+            if (iv->getBlock() != op->getBlock() || !iv->isBeforeInBlock(op))
+                return false;
+
+            auto type = iv.getType().dyn_cast< LValueType >();
+            if (!type || !type.getElementType().isa< mlir::IntegerType >() || !is_plain_local(iv))
+                return false;
+
+            auto &body = op.getBodyRegion();
+            for (auto user : iv->getUsers()) {
+                if (!mlir::isa< DeclRefOp >(user) || !op->isProperAncestor(user))
+                    return false;
+                if (body.isAncestor(user->getParentRegion()))
+                    if (!llvm::all_of(user->getUsers(), is_load))
+                        return false;
+            }
+
+            return true;
+        }
+
+        bool has_early_exits(ForOp op)
+        {
+            auto result = op.getBodyRegion().walk([&] (mlir::Operation *nested) {
+                if (mlir::isa< ReturnOp, GotoStmt, LabelStmt >(nested))
+                    return mlir::WalkResult::interrupt();
+                if (mlir::isa< BreakOp, ContinueOp >(nested) && jump_target(nested) == op)
+                    return mlir::WalkResult::interrupt();
+                return mlir::WalkResult::advance();
+            });
+            return result.wasInterrupted();
+        }
+
+        std::optional< counted_loop > match_counted_loop(ForOp op)
+        {
+            auto &cond = op.getCondRegion();
+            if (cond.empty() || cond.front().empty() || op.getBodyRegion().empty())
+                return std::nullopt;
+
+            auto yield = mlir::dyn_cast< CondYieldOp >(cond.front().back());
+            auto cmp = yield ? yield.getResult().getDefiningOp< CmpOp >() : CmpOp();
+            if (!cmp)
+                return std::nullopt;
+
+            auto iv = loaded_var(cmp.getLhs());
+            if (!iv)
+                return std::nullopt;
+
+            // The condition is dropped, hence it must not compute anything
+            // else than the comparison.
+            auto lhs = cmp.getLhs().getDefiningOp();
+            llvm::SmallPtrSet< mlir::Operation *, 4 > cond_ops = {
+                cmp, lhs, lhs->getOperand(0).getDefiningOp(), cmp.getRhs().getDefiningOp()
+            };
+            for (auto &nested : cond.front().without_terminator())
+                if (!cond_ops.contains(&nested))
+                    return std::nullopt;
+
+            auto lb = constant_value(init_value(iv));
+            auto step = match_step(op, iv);
+            if (!lb || !step)
+                return std::nullopt;
+
+            auto ub = match_upper_bound(cmp, *lb, *step);
+            if (!ub || !is_loop_local(iv, op) || has_early_exits(op))
+                return std::nullopt;
+
+            return counted_loop{ op, iv, *lb, *ub, *step };
+        }
+
+        void lower(const counted_loop &loop, mlir::OpBuilder &bld)
+        {
+            auto op = loop.op;
+            bld.setInsertionPoint(op);
+            auto affine_for = bld.create< mlir::AffineForOp >(op.getLoc(), loop.lb, loop.ub, loop.step);
+
+            auto body = affine_for.getBody();
+            body->getOperations().splice(
+                mlir::Block::iterator(body->getTerminator()),
+                op.getBodyRegion().front().getOperations()
+            );
+
+            // Reads of the induction variable in the body are replaced by the
+            // induction value of the affine loop.
+            for (auto user : llvm::make_early_inc_range(loop.iv->getUsers())) {
+                if (!affine_for->isProperAncestor(user))
+                    continue;
+
+                for (auto load : llvm::make_early_inc_range(user->getUsers())) {
+                    bld.setInsertionPoint(load);
+                    auto value = bld.create< mlir::arith::IndexCastOp >(
+                        load->getLoc(), load->getResult(0).getType(), affine_for.getInductionVar()
+                    );
+                    load->replaceAllUsesWith(value->getResults());
+                    load->erase();
+                }
+                user->erase();
+            }
+
+            op->erase();
+            loop.iv->erase();
+        }
+
+        //
+        // arrays
+        //
+        // Local fixed size arrays, which are accessed only by subscripts
+        // (i.e., their address never escapes), are allocated as memrefs.
+        // Accesses are lowered to affine loads and stores if the subscripts
+        // are affine in induction values of enclosing affine loops, to memref
+        // loads and stores otherwise.
+        //
+        struct array_access
+        {
+            DeclRefOp ref;
+            // Pointer decays and subscripts from the outermost dimension.
+            llvm::SmallVector< mlir::Operation * > chain;
+            llvm::SmallVector< mlir::Value > indices;
+            mlir::Value element;
+        };
+
+        std::optional< array_access > match_access(DeclRefOp ref, int64_t rank)
+        {
+            array_access access{ ref, {}, {}, ref };
+            while (int64_t(access.indices.size()) < rank) {
+                if (!access.element.hasOneUse())
+                    return std::nullopt;
+
+                auto decay = mlir::dyn_cast< ImplicitCastOp >(*access.element.user_begin());
+                if (!decay || decay.getKind() != CastKind::ArrayToPointerDecay || !decay->hasOneUse())
+                    return std::nullopt;
+
+                auto subscript = mlir::dyn_cast< SubscriptOp >(*decay->user_begin());
+                if (!subscript || subscript.getArray() != decay.getResult())
+                    return std::nullopt;
+
+                access.chain.append({ decay, subscript });
+                access.indices.push_back(subscript.getIndex());
+                access.element = subscript.getResult();
+            }
+
+            for (auto user : access.element.getUsers()) {
+                if (is_load(user))
+                    continue;
+                auto assign = mlir::dyn_cast< AssignOp >(user);
+                if (!assign || assign.getSrc() == access.element)
+                    return std::nullopt;
+            }
+
+            return access;
+        }
+
+        // Expresses the index in terms of induction values of affine loops.
+        std::optional< mlir::AffineExpr > affine_expr(
+            mlir::Value value, llvm::SmallVectorImpl< mlir::Value > &dims
+        ) {
+            auto ctx = value.getContext();
+            if (auto constant = constant_value(value))
+                return mlir::getAffineConstantExpr(*constant, ctx);
+
+            auto def = value.getDefiningOp();
+            if (!def)
+                return std::nullopt;
+
+            if (auto cast = mlir::dyn_cast< mlir::arith::IndexCastOp >(def)) {
+                auto iv = cast.getIn();
+                if (!mlir::isForInductionVar(iv))
+                    return std::nullopt;
+
+                auto pos = llvm::find(dims, iv) - dims.begin();
+                if (pos == int64_t(dims.size()))
+                    dims.push_back(iv);
+                return mlir::getAffineDimExpr(unsigned(pos), ctx);
+            }
+
+            // Widening casts keep the value of the index.
+            if (auto cast = mlir::dyn_cast< ImplicitCastOp >(def)) {
+                auto from = cast.getValue().getType().dyn_cast< mlir::IntegerType >();
+                auto to   = cast.getType().dyn_cast< mlir::IntegerType >();
+                if (cast.getKind() != CastKind::IntegralCast || !from || !to)
+                    return std::nullopt;
+                if (from.getWidth() > to.getWidth())
+                    return std::nullopt;
+                return affine_expr(cast.getValue(), dims);
+            }
+
+            if (!mlir::isa< AddIOp, SubIOp, MulIOp >(def))
+                return std::nullopt;
+
+            auto lhs = affine_expr(def->getOperand(0), dims);
+            auto rhs = lhs ? affine_expr(def->getOperand(1), dims) : std::nullopt;
+            if (!lhs || !rhs)
+                return std::nullopt;
+
+            if (mlir::isa< AddIOp >(def))
+                return *lhs + *rhs;
+            if (mlir::isa< SubIOp >(def))
+                return *lhs - *rhs;
+            if (lhs->isSymbolicOrConstant() || rhs->isSymbolicOrConstant())
+                return *lhs * *rhs;
+            return std::nullopt;
+        }
+
+        struct memory_access
+        {
+            std::optional< mlir::AffineMap > map;
+            llvm::SmallVector< mlir::Value > operands;
+        };
+
+        memory_access make_access(
+            llvm::ArrayRef< mlir::Value > indices, mlir::Location loc, mlir::OpBuilder &bld
+        ) {
+            llvm::SmallVector< mlir::Value > dims;
+            llvm::SmallVector< mlir::AffineExpr > exprs;
+            for (auto index : indices) {
+                auto expr = affine_expr(index, dims);
+                if (!expr)
+                    break;
+                exprs.push_back(*expr);
+            }
+
+            if (exprs.size() == indices.size()) {
+                auto map = mlir::AffineMap::get(unsigned(dims.size()), 0, exprs, bld.getContext());
+                return { map, dims };
+            }
+
+            memory_access access;
+            for (auto index : indices)
+                access.operands.push_back(
+                    bld.create< mlir::arith::IndexCastOp >(loc, bld.getIndexType(), index)
+                );
+            return access;
+        }
+
+        void lower(const array_access &access, mlir::Value memref, mlir::OpBuilder &bld)
+        {
+            for (auto user : llvm::make_early_inc_range(access.element.getUsers())) {
+                bld.setInsertionPoint(user);
+                auto loc = user->getLoc();
+                auto mem = make_access(access.indices, loc, bld);
+
+                if (auto assign = mlir::dyn_cast< AssignOp >(user)) {
+                    auto value = assign.getSrc();
+                    if (mem.map)
+                        bld.create< mlir::AffineStoreOp >(loc, value, memref, *mem.map, mem.operands);
+                    else
+                        bld.create< mlir::memref::StoreOp >(loc, value, memref, mem.operands);
+                    assign->replaceAllUsesWith(mlir::ValueRange(value));
+                } else {
+                    mlir::Value value;
+                    if (mem.map)
+                        value = bld.create< mlir::AffineLoadOp >(loc, memref, *mem.map, mem.operands);
+                    else
+                        value = bld.create< mlir::memref::LoadOp >(loc, memref, mem.operands);
+                    user->replaceAllUsesWith(mlir::ValueRange(value));
+                }
+
+                user->erase();
+            }
+
+            for (auto op : llvm::reverse(access.chain))
+                op->erase();
+            access.ref->erase();
+        }
+
+        void promote_array(VarDeclOp var, mlir::Block &entry, mlir::OpBuilder &bld)
+        {
+            auto type = var.getType().dyn_cast< LValueType >();
+            auto memref = type ? type.getElementType().dyn_cast< mlir::MemRefType >() : mlir::MemRefType();
+            if (!memref || !memref.hasStaticShape() || !is_plain_local(var))
+                return;
+            if (!memref.getElementType().isa< mlir::IntegerType, mlir::FloatType >())
+                return;
+            if (!var.getInitializer().empty())
+                return;
+
+            llvm::SmallVector< array_access > accesses;
+            for (auto user : var->getUsers()) {
+                auto ref = mlir::dyn_cast< DeclRefOp >(user);
+                auto access = ref ? match_access(ref, memref.getRank()) : std::nullopt;
+                if (!access)
+                    return;
+                accesses.push_back(*access);
+            }
+
+            // Fixed size arrays are allocated on function entry, so that
+            // arrays declared in loops do not grow the stack.
+            bld.setInsertionPointToStart(&entry);
+            auto alloca = bld.create< mlir::memref::AllocaOp >(var.getLoc(), memref);
+
+            for (const auto &access : accesses)
+                lower(access, alloca, bld);
+            var->erase();
+        }
+
+    } // namespace
+
+    struct HLToAffinePass : HLToAffineBase< HLToAffinePass >
+    {
+        void runOnOperation() override
+        {
+            mlir::OpBuilder bld(&getContext());
+
+            for (auto fn : getOperation().getOps< mlir::FunctionOpInterface >()) {
+                if (fn->getRegion(0).empty())
+                    continue;
+
+                // Inner loops are lowered first, so that their reads of outer
+                // induction variables are replaced together with the outer
+                // loop.
+                llvm::SmallVector< ForOp > loops;
+                fn->walk< mlir::WalkOrder::PostOrder >([&] (ForOp op) { loops.push_back(op); });
+                for (auto op : loops)
+                    if (auto loop = match_counted_loop(op))
+                        lower(*loop, bld);
+
+                llvm::SmallVector< VarDeclOp > vars;
+                fn->walk([&] (VarDeclOp var) { vars.push_back(var); });
+                for (auto var : vars)
+                    promote_array(var, fn->getRegion(0).front(), bld);
+            }
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLToAffinePass()
+{
+    return std::make_unique< HLToAffinePass >();
+}
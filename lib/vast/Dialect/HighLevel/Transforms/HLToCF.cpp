@@ -0,0 +1,546 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
+#include <mlir/IR/Dominance.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <vector>
+
+namespace vast::hl
+{
+    //
+    // Control flow lowering
+    //
+    // Structured control flow of a function is flattened into blocks of its
+    // body, one operation at a time. Once a control flow operation is reached,
+    // its block is split after it and the operation is replaced by branches
+    // to the blocks of its regions, which are moved into the function body and
+    // lowered in turn. Jumps (`hl.break`, `hl.continue`, `hl.goto`) become
+    // branches to the blocks recorded for their targets, labels (including
+    // case labels) start a new block.
+    //
+    namespace
+    {
+        struct cfg_lowering
+        {
+            mlir::FunctionOpInterface fn;
+            mlir::Region &body;
+            mlir::OpBuilder bld;
+
+            // Blocks started by `hl.label` of the label declaration.
+            llvm::DenseMap< mlir::Value, mlir::Block * > labels;
+            // Destinations of `hl.break` and `hl.continue`, recorded before
+            // the body of the loop or switch is moved out of it.
+            llvm::DenseMap< mlir::Operation *, mlir::Block * > jumps;
+            // Blocks started by `hl.case` and `hl.default`.
+            llvm::DenseMap< mlir::Operation *, mlir::Block * > cases;
+
+            std::vector< mlir::Block * > worklist;
+
+            explicit cfg_lowering(mlir::FunctionOpInterface fn)
+                : fn(fn), body(fn->getRegion(0)), bld(fn->getContext())
+            {}
+
+            mlir::LogicalResult run()
+            {
+                hoist_uninitialized_vars();
+
+                for (auto &block : body)
+                    worklist.push_back(&block);
+
+                while (!worklist.empty()) {
+                    auto block = worklist.back();
+                    worklist.pop_back();
+                    if (mlir::failed(lower(block)))
+                        return mlir::failure();
+                }
+
+                erase_unused_labels();
+                return check_dominance();
+            }
+
+            // Scans the block up to the first control flow operation.
+            mlir::LogicalResult lower(mlir::Block *block)
+            {
+                for (auto &op : llvm::make_early_inc_range(*block)) {
+                    if (mlir::isa< SkipStmt >(op)) {
+                        op.erase();
+                        continue;
+                    }
+
+                    // Operations following a terminator are never executed.
+                    if (op.hasTrait< mlir::OpTrait::IsTerminator >()) {
+                        if (&op != &block->back())
+                            split_after(&op);
+                        return mlir::success();
+                    }
+
+                    if (is_control_flow(&op))
+                        return lower_op(&op);
+                }
+
+                return mlir::success();
+            }
+
+            static bool is_control_flow(mlir::Operation *op)
+            {
+                return mlir::isa<
+                    ScopeOp, IfOp, WhileOp, ForOp, DoOp, SwitchOp, CaseOp, DefaultOp,
+                    LabelStmt, GotoStmt, BreakOp, ContinueOp
+                >(op);
+            }
+
+            mlir::LogicalResult lower_op(mlir::Operation *op)
+            {
+                // The block is rescanned, as operations lowered into it
+                // (e.g., a condition) may contain control flow themselves.
+                worklist.push_back(op->getBlock());
+
+                return llvm::TypeSwitch< mlir::Operation *, mlir::LogicalResult >(op)
+                    .Case([&] (ScopeOp scope) { return lower(scope); })
+                    .Case([&] (IfOp if_op) { return lower(if_op); })
+                    .Case([&] (WhileOp loop) { return lower(loop); })
+                    .Case([&] (ForOp loop) { return lower(loop); })
+                    .Case([&] (DoOp loop) { return lower(loop); })
+                    .Case([&] (SwitchOp switch_op) { return lower(switch_op); })
+                    .Case([&] (CaseOp case_op) { return start_block(case_op, cases.lookup(op)); })
+                    .Case([&] (DefaultOp default_op) { return start_block(default_op, cases.lookup(op)); })
+                    .Case([&] (LabelStmt label) {
+                        return start_block(label, label_block(label.getLabel()));
+                    })
+                    .Case([&] (GotoStmt jump) { return branch(jump, label_block(jump.getLabel())); })
+                    .Case< BreakOp, ContinueOp >([&] (auto jump) { return branch(jump, jumps.lookup(op)); })
+                    .Default([&] (auto) { return mlir::failure(); });
+            }
+
+            mlir::LogicalResult lower(ScopeOp scope)
+            {
+                for (auto &block : scope.getBody())
+                    splice_before(scope, block);
+                scope->erase();
+                return mlir::success();
+            }
+
+            mlir::LogicalResult lower(IfOp op)
+            {
+                auto cont = split_after(op);
+                auto then_block = move_region(op.getThenRegion(), cont);
+                fallthrough(then_block, cont);
+
+                auto else_block = cont;
+                if (op.hasElse()) {
+                    else_block = move_region(op.getElseRegion(), cont);
+                    fallthrough(else_block, cont);
+                }
+
+                auto cond = inline_condition(op);
+                if (!cond)
+                    return mlir::failure();
+
+                auto br = bld.create< mlir::cf::CondBranchOp >(op.getLoc(), cond, then_block, else_block);
+                copy_attr(op, br, branch_weights_attr_name);
+                op->erase();
+                return mlir::success();
+            }
+
+            mlir::LogicalResult lower(WhileOp op)
+            {
+                auto cont = split_after(op);
+                auto cond = &ensure_block(op.getCondRegion());
+                auto loop_body = &ensure_block(op.getBodyRegion());
+                record_jumps(op, cont, cond);
+
+                move_region(op.getCondRegion(), cont);
+                move_region(op.getBodyRegion(), cont);
+                auto latch = fallthrough(loop_body, cond);
+
+                return finish_loop(op, cond, loop_body, cont, cond, latch);
+            }
+
+            mlir::LogicalResult lower(ForOp op)
+            {
+                auto cont = split_after(op);
+                auto cond = &ensure_block(op.getCondRegion());
+                auto incr = &ensure_block(op.getIncrRegion());
+                auto loop_body = &ensure_block(op.getBodyRegion());
+                record_jumps(op, cont, incr);
+
+                move_region(op.getCondRegion(), cont);
+                move_region(op.getBodyRegion(), cont);
+                move_region(op.getIncrRegion(), cont);
+                fallthrough(loop_body, incr);
+                auto latch = fallthrough(incr, cond);
+
+                return finish_loop(op, cond, loop_body, cont, cond, latch);
+            }
+
+            mlir::LogicalResult lower(DoOp op)
+            {
+                auto cont = split_after(op);
+                auto loop_body = &ensure_block(op.getBodyRegion());
+                auto cond = &ensure_block(op.getCondRegion());
+                record_jumps(op, cont, cond);
+
+                move_region(op.getBodyRegion(), cont);
+                move_region(op.getCondRegion(), cont);
+                fallthrough(loop_body, cond);
+
+                // The conditional branch is the latch of the loop.
+                return finish_loop(op, cond, loop_body, cont, loop_body, nullptr);
+            }
+
+            // Branch weights are kept on the conditional branch, loop hints on
+            // the branch back to the condition.
+            mlir::LogicalResult finish_loop(
+                mlir::Operation *op, mlir::Block *cond, mlir::Block *on_true,
+                mlir::Block *on_false, mlir::Block *entry, mlir::Operation *latch
+            ) {
+                bld.setInsertionPoint(op);
+                bld.create< mlir::cf::BranchOp >(op->getLoc(), entry);
+
+                // Loops without condition (e.g., `for (;;)`) are left only by
+                // jumps.
+                if (cond->empty()) {
+                    bld.setInsertionPointToEnd(cond);
+                    auto br = bld.create< mlir::cf::BranchOp >(op->getLoc(), on_true);
+                    copy_attr(op, latch ? latch : br.getOperation(), loop_hints_attr_name);
+                    op->erase();
+                    return mlir::success();
+                }
+
+                auto yield = mlir::dyn_cast< CondYieldOp >(cond->back());
+                if (!yield)
+                    return op->emitError("loop condition is not terminated by hl.cond.yield");
+
+                bld.setInsertionPoint(yield);
+                auto value = coerce(yield.getResult(), yield.getLoc());
+                if (!value)
+                    return yield.emitError("unsupported condition type: ") << yield.getResult().getType();
+
+                auto br = bld.create< mlir::cf::CondBranchOp >(yield.getLoc(), value, on_true, on_false);
+                copy_attr(op, br, branch_weights_attr_name);
+                copy_attr(op, latch ? latch : br.getOperation(), loop_hints_attr_name);
+                yield->erase();
+                op->erase();
+                return mlir::success();
+            }
+
+            mlir::LogicalResult lower(SwitchOp op)
+            {
+                auto cont = split_after(op);
+
+                auto &cond = op.getCondRegion();
+                if (cond.empty() || cond.front().empty())
+                    return op.emitError("switch without condition");
+
+                auto yield = mlir::dyn_cast< ValueYieldOp >(cond.front().back());
+                if (!yield)
+                    return op.emitError("switch condition is not terminated by hl.value.yield");
+
+                auto value = yield.getResult();
+                auto type = value.getType().dyn_cast< mlir::IntegerType >();
+                if (!type)
+                    return op.emitError("unsupported switch condition type: ") << value.getType();
+
+                record_jumps(op, cont, nullptr);
+
+                // Every label of the switch starts a block, even when nested
+                // in other statements. Cases are kept in the order of their
+                // appearance, which is the order of their branch weights.
+                mlir::Block *default_dest = cont;
+                llvm::SmallVector< llvm::APInt > values;
+                llvm::SmallVector< mlir::Block * > dests;
+
+                auto result = op->walk< mlir::WalkOrder::PreOrder >([&] (mlir::Operation *nested) {
+                    if (!mlir::isa< CaseOp, DefaultOp >(nested) || nested->getParentOfType< SwitchOp >() != op)
+                        return mlir::WalkResult::advance();
+
+                    auto block = bld.createBlock(cont);
+                    cases[nested] = block;
+
+                    if (mlir::isa< DefaultOp >(nested)) {
+                        default_dest = block;
+                        return mlir::WalkResult::advance();
+                    }
+
+                    auto case_op = mlir::cast< CaseOp >(nested);
+                    auto case_val = case_value(case_op, type.getWidth());
+                    if (!case_val) {
+                        case_op.emitError("case value is not constant");
+                        return mlir::WalkResult::interrupt();
+                    }
+
+                    values.push_back(*case_val);
+                    dests.push_back(block);
+                    return mlir::WalkResult::advance();
+                });
+
+                if (result.wasInterrupted())
+                    return mlir::failure();
+
+                // Statements preceding the first label are never executed,
+                // but still lowered to keep the labels nested in them.
+                auto next = cont;
+                for (auto &region : llvm::reverse(op.getCases())) {
+                    auto block = move_region(region, next);
+                    fallthrough(block, next);
+                    next = block;
+                }
+
+                yield->erase();
+                splice_before(op, cond.front());
+
+                bld.setInsertionPoint(op);
+                llvm::SmallVector< mlir::ValueRange > operands(values.size(), mlir::ValueRange{});
+                auto sw = bld.create< mlir::cf::SwitchOp >(
+                    op.getLoc(), value, default_dest, mlir::ValueRange{}, values, dests, operands
+                );
+                copy_attr(op, sw, branch_weights_attr_name);
+
+                op->erase();
+                return mlir::success();
+            }
+
+            // Moves the labeled statement and everything after it into the
+            // block of the label.
+            mlir::LogicalResult start_block(mlir::Operation *op, mlir::Block *block)
+            {
+                if (!block)
+                    return op->emitError("label outside of lowered control flow");
+
+                auto from = op->getBlock();
+                block->getOperations().splice(
+                    block->end(), from->getOperations(), mlir::Block::iterator(op), from->end()
+                );
+
+                bld.setInsertionPointToEnd(from);
+                bld.create< mlir::cf::BranchOp >(op->getLoc(), block);
+
+                auto &substmt = op->getRegions().back();
+                for (auto &inner : substmt)
+                    splice_before(op, inner);
+                op->erase();
+
+                worklist.push_back(block);
+                return mlir::success();
+            }
+
+            mlir::LogicalResult branch(mlir::Operation *op, mlir::Block *dest)
+            {
+                if (!dest)
+                    return op->emitError("jump outside of lowered control flow");
+
+                split_after(op);
+                bld.setInsertionPoint(op);
+                bld.create< mlir::cf::BranchOp >(op->getLoc(), dest);
+                op->erase();
+                return mlir::success();
+            }
+
+            void record_jumps(mlir::Operation *op, mlir::Block *on_break, mlir::Block *on_continue)
+            {
+                op->walk([&] (mlir::Operation *nested) {
+                    if (!mlir::isa< BreakOp, ContinueOp >(nested) || jump_target(nested) != op)
+                        return;
+                    jumps[nested] = mlir::isa< BreakOp >(nested) ? on_break : on_continue;
+                });
+            }
+
+            mlir::Block *label_block(mlir::Value label)
+            {
+                auto &block = labels[label];
+                if (!block) {
+                    block = new mlir::Block();
+                    body.push_back(block);
+                }
+                return block;
+            }
+
+            // Splits the block after the operation, the rest is lowered later.
+            mlir::Block *split_after(mlir::Operation *op)
+            {
+                auto cont = op->getBlock()->splitBlock(op->getNextNode());
+                worklist.push_back(cont);
+                return cont;
+            }
+
+            static mlir::Block &ensure_block(mlir::Region &region)
+            {
+                if (region.empty())
+                    region.push_back(new mlir::Block());
+                return region.front();
+            }
+
+            // Moves the single block of the region in front of `before`.
+            mlir::Block *move_region(mlir::Region &region, mlir::Block *before)
+            {
+                auto block = &ensure_block(region);
+                body.getBlocks().splice(mlir::Region::iterator(before), region.getBlocks());
+                worklist.push_back(block);
+                return block;
+            }
+
+            // Returns the branch to the next block, unless the block ends
+            // with a terminator.
+            mlir::Operation *fallthrough(mlir::Block *block, mlir::Block *next)
+            {
+                if (!block->empty() && block->back().hasTrait< mlir::OpTrait::IsTerminator >())
+                    return nullptr;
+                bld.setInsertionPointToEnd(block);
+                return bld.create< mlir::cf::BranchOp >(fn.getLoc(), next);
+            }
+
+            static void copy_attr(mlir::Operation *from, mlir::Operation *to, llvm::StringRef name)
+            {
+                if (auto attr = from->getAttr(name))
+                    to->setAttr(name, attr);
+            }
+
+            static void splice_before(mlir::Operation *op, mlir::Block &block)
+            {
+                op->getBlock()->getOperations().splice(
+                    mlir::Block::iterator(op), block.getOperations()
+                );
+            }
+
+            // Evaluates the condition of `hl.if` in front of it and leaves
+            // the builder there.
+            mlir::Value inline_condition(IfOp op)
+            {
+                auto &cond = op.getCondRegion();
+                auto yield = cond.empty() || cond.front().empty()
+                    ? nullptr : mlir::dyn_cast< CondYieldOp >(cond.front().back());
+                if (!yield) {
+                    op.emitError("if condition is not terminated by hl.cond.yield");
+                    return {};
+                }
+
+                auto value = yield.getResult();
+                auto loc = yield.getLoc();
+                yield->erase();
+                splice_before(op, cond.front());
+
+                bld.setInsertionPoint(op);
+                auto coerced = coerce(value, loc);
+                if (!coerced)
+                    op.emitError("unsupported condition type: ") << value.getType();
+                return coerced;
+            }
+
+            // Conditions are compared against zero: integral conditions by
+            // `hl.cmp ne`, pointers against null and floating point conditions
+            // by unordered `cmpf une`, so that NaN is true as it is in C.
+            mlir::Value coerce(mlir::Value value, mlir::Location loc)
+            {
+                return llvm::TypeSwitch< mlir::Type, mlir::Value >(value.getType())
+                    .Case([&] (mlir::IntegerType type) -> mlir::Value {
+                        if (type.getWidth() == 1)
+                            return value;
+                        auto zero = bld.create< ConstantOp >(
+                            loc, type, llvm::APSInt(llvm::APInt(type.getWidth(), 0), false)
+                        );
+                        return bld.create< CmpOp >(loc, bld.getI1Type(), Predicate::ne, value, zero);
+                    })
+                    .Case([&] (PointerType type) -> mlir::Value {
+                        auto zero = bld.create< ConstantOp >(
+                            loc, bld.getI32Type(), llvm::APSInt(llvm::APInt(32, 0), false)
+                        );
+                        auto null = bld.create< ImplicitCastOp >(
+                            loc, type, zero, CastKind::NullToPointer
+                        );
+                        return bld.create< CmpOp >(loc, bld.getI1Type(), Predicate::ne, value, null);
+                    })
+                    .Case([&] (mlir::FloatType type) -> mlir::Value {
+                        auto zero = bld.create< mlir::arith::ConstantOp >(
+                            loc, bld.getFloatAttr(type, 0.0)
+                        );
+                        return bld.create< mlir::arith::CmpFOp >(
+                            loc, mlir::arith::CmpFPredicate::UNE, value, zero
+                        );
+                    })
+                    .Default([] (auto) { return mlir::Value(); });
+            }
+
+            // Variables without initializer are allocated on function entry,
+            // so that jumps into their scope (e.g., to a case label) keep them
+            // in scope.
+            void hoist_uninitialized_vars()
+            {
+                if (body.empty())
+                    return;
+
+                auto &entry = body.front();
+                llvm::SmallVector< VarDeclOp > vars;
+                fn->walk([&] (VarDeclOp var) {
+                    if (var->getBlock() == &entry || !var.hasLocalStorage())
+                        return;
+                    if (var.getInitializer().empty() && var.getAllocationSize().empty())
+                        vars.push_back(var);
+                });
+
+                for (auto var : vars)
+                    var->moveBefore(&entry, entry.begin());
+            }
+
+            void erase_unused_labels()
+            {
+                llvm::SmallVector< LabelDeclOp > unused;
+                fn->walk([&] (LabelDeclOp decl) {
+                    if (decl->use_empty())
+                        unused.push_back(decl);
+                });
+
+                for (auto decl : unused)
+                    decl->erase();
+            }
+
+            // Jumps past an initialized declaration leave it undefined on
+            // some paths, which cannot be expressed by the lowered blocks.
+            mlir::LogicalResult check_dominance()
+            {
+                mlir::DominanceInfo dom(fn);
+                auto result = fn->walk([&] (mlir::Operation *op) {
+                    for (auto operand : op->getOperands()) {
+                        if (dom.properlyDominates(operand, op))
+                            continue;
+                        op->emitError("jump bypasses the definition of a used value");
+                        return mlir::WalkResult::interrupt();
+                    }
+                    return mlir::WalkResult::advance();
+                });
+
+                return mlir::failure(result.wasInterrupted());
+            }
+        };
+
+    } // namespace
+
+    struct HLToCFPass : HLToCFBase< HLToCFPass >
+    {
+        void runOnOperation() override
+        {
+            for (auto fn : getOperation().getOps< mlir::FunctionOpInterface >()) {
+                if (fn->getRegion(0).empty())
+                    continue;
+                if (mlir::failed(cfg_lowering(fn).run()))
+                    return signalPassFailure();
+            }
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLToCFPass()
+{
+    return std::make_unique< HLToCFPass >();
+}
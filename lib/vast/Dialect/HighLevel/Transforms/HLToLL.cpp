@@ -20,6 +20,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Util/TypeConverter.hpp"
 #include "vast/Util/Symbols.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 namespace vast::hl
@@ -210,6 +211,63 @@ namespace vast::hl
                     return this->convert_type_to_types(lvalue.getElementType());
                 return this->convert_type_to_types(t);
             }
+
+            // Type based alias analysis. By the time this pass runs, types are already
+            // lowered to standard ones, therefore type descriptors are derived from
+            // the lowered scalar types. C types of the same kind and width are
+            // merged (and signedness is ignored), which is a conservative
+            // approximation of the effective type rules.
+            bool strict_aliasing = true;
+            llvm::DenseMap< mlir::Type, mlir::StringAttr > tbaa_names;
+
+            mlir::StringAttr tbaa_type_name(mlir::Type t)
+            {
+                if (auto it = tbaa_names.find(t); it != tbaa_names.end())
+                    return it->second;
+                return tbaa_names[t] = make_tbaa_type_name(t);
+            }
+
+            static mlir::StringAttr make_tbaa_type_name(mlir::Type t)
+            {
+                auto name = [&](const llvm::Twine &str) {
+                    return mlir::StringAttr::get(t.getContext(), str);
+                };
+
+                if (t.isa< LLVM::LLVMPointerType, hl::PointerType >())
+                    return name("any pointer");
+
+                if (auto int_type = t.dyn_cast< mlir::IntegerType >())
+                {
+                    // Character types may alias any other type.
+                    if (int_type.getWidth() == 8)
+                        return name("omnipotent char");
+                    return name("int" + llvm::Twine(int_type.getWidth()));
+                }
+
+                if (auto float_type = t.dyn_cast< mlir::FloatType >())
+                    return name("float" + llvm::Twine(float_type.getWidth()));
+
+                // Aggregates are accessed as a whole, such access may alias anything.
+                return {};
+            }
+
+            void annotate_access(mlir::Operation *access, mlir::Type accessed)
+            {
+                if (!strict_aliasing)
+                    return;
+                if (auto name = tbaa_type_name(accessed))
+                    access->setAttr(tbaa_attr_name, name);
+            }
+
+            void annotate_access(LLVM::LoadOp load)
+            {
+                annotate_access(load, load.getType());
+            }
+
+            void annotate_access(LLVM::StoreOp store)
+            {
+                annotate_access(store, store.getValue().getType());
+            }
         };
 
         template< typename O >
@@ -260,6 +318,100 @@ namespace vast::hl
             }
         };
 
+        // Operations that form the static allocation prologue of the entry block,
+        // i.e. allocas, their constant sizes and spills of function arguments.
+        bool is_alloca_prologue(mlir::Operation *op)
+        {
+            if (mlir::isa< LLVM::AllocaOp >(op))
+                return true;
+
+            if (auto store = mlir::dyn_cast< LLVM::StoreOp >(op))
+                return store.getValue().isa< mlir::BlockArgument >();
+
+            if (auto cst = mlir::dyn_cast< LLVM::ConstantOp >(op))
+            {
+                auto users = cst->getUsers();
+                return !users.empty() && llvm::all_of(users, [](auto user) {
+                    return mlir::isa< LLVM::AllocaOp >(user);
+                });
+            }
+            return false;
+        }
+
+        // Static allocas are placed at the end of the prologue, so they keep
+        // the declaration order and mem2reg/SROA can promote them.
+        mlir::Block::iterator alloca_insertion_point(mlir::Block &entry)
+        {
+            return std::find_if_not(entry.begin(), entry.end(), [](auto &op) {
+                return is_alloca_prologue(&op);
+            });
+        }
+
+        bool is_volatile_access(mlir::Operation *op)
+        {
+            return op->hasAttr(volatile_attr_name);
+        }
+
+        bool is_restrict_pointer(mlir::Type t)
+        {
+            if (auto lvalue = t.dyn_cast< hl::LValueType >())
+                t = lvalue.getElementType();
+            return t.isa< hl::PointerType >() && isRestrictQualified(t);
+        }
+
+        auto make_alloca(mlir::Location loc, mlir::Type ptr_type, mlir::Value count,
+                         auto &rewriter)
+        {
+            return rewriter.template create< LLVM::AllocaOp >(loc, ptr_type, count, 0);
+        }
+
+        auto make_alloca_of_one(mlir::Location loc, mlir::Type ptr_type, auto &rewriter,
+                                auto &tc)
+        {
+            auto count = rewriter.template create< LLVM::ConstantOp >(
+                    loc,
+                    tc.convertType(rewriter.getIndexType()),
+                    rewriter.getIntegerAttr(rewriter.getIndexType(), 1));
+            return make_alloca(loc, ptr_type, count, rewriter);
+        }
+
+        std::optional< uint64_t > declared_alignment(mlir::Operation *op)
+        {
+            if (auto aligned = op->getAttrOfType< hl::AlignedAttr >(hl::AlignedAttr::getMnemonic()))
+                return aligned.getAlignment();
+            return std::nullopt;
+        }
+
+        hl::SectionAttr declared_section(mlir::Operation *op)
+        {
+            return op->getAttrOfType< hl::SectionAttr >(hl::SectionAttr::getMnemonic());
+        }
+
+        // Llvm function attributes implied by the attributes of the declaration.
+        mlir::ArrayAttr make_passthrough(mlir::Operation *op, mlir::Builder &bld)
+        {
+            llvm::SmallVector< mlir::Attribute, 4 > attrs;
+            auto add = [&] (auto attr, std::initializer_list< llvm::StringRef > names) {
+                if (op->hasAttr(decltype(attr)::getMnemonic()))
+                    for (auto name : names)
+                        attrs.push_back(bld.getStringAttr(name));
+            };
+
+            add(hl::AlwaysInlineAttr(), { "alwaysinline" });
+            add(hl::NoInlineAttr(),     { "noinline" });
+            add(hl::HotAttr(),          { "hot" });
+            add(hl::ColdAttr(),         { "cold" });
+            add(hl::NoReturnAttr(),     { "noreturn" });
+            if (op->hasAttr(hl::ConstAttr::getMnemonic()))
+                add(hl::ConstAttr(),    { "readnone", "nounwind" });
+            else
+                add(hl::PureAttr(),     { "readonly", "nounwind" });
+
+            if (attrs.empty())
+                return {};
+            return bld.getArrayAttr(attrs);
+        }
+
         struct func_op : BasePattern< mlir::func::FuncOp >
         {
             using Base = BasePattern< mlir::func::FuncOp >;
@@ -291,17 +443,33 @@ namespace vast::hl
                     {
                         const auto &mapping = signature.getInputMapping(i);
                         for (std::size_t j = 0; j < mapping->size; ++j)
-                            new_arg_attrs[mapping->inputNo + j] = original_arg_attr[i];
+                            new_arg_attrs.push_back(original_arg_attr[i]);
                     }
                     new_attrs.push_back(rewriter.getNamedAttr(
                                 mlir::FunctionOpInterface::getArgDictAttrName(),
                                 rewriter.getArrayAttr(new_arg_attrs)));
                 }
+                if (auto passthrough = make_passthrough(func_op, rewriter))
+                    new_attrs.push_back(rewriter.getNamedAttr("passthrough", passthrough));
+
+                if (auto section = declared_section(func_op))
+                    new_attrs.push_back(rewriter.getNamedAttr(section_attr_name,
+                                                              section.getName()));
+
+                if (auto align = declared_alignment(func_op))
+                    new_attrs.push_back(rewriter.getNamedAttr(aligned_attr_name,
+                                                              rewriter.getI64IntegerAttr(*align)));
+
+                if (auto count = func_op->getAttrOfType< mlir::IntegerAttr >(entry_count_attr_name))
+                    new_attrs.push_back(rewriter.getNamedAttr(entry_count_attr_name, count));
+
                 // TODO(lukas): Linkage?
                 auto linkage = LLVM::Linkage::External;
                 auto new_func = rewriter.create< LLVM::LLVMFuncOp >(
                         func_op.getLoc(), func_op.getName(), target_type,
                         linkage, false, LLVM::CConv::C, new_attrs);
+                mark_noalias_args(func_op, new_func, signature, rewriter);
+
                 rewriter.inlineRegionBefore(func_op.getBody(),
                                             new_func.getBody(), new_func.end());
                 util::convert_region_types(func_op, new_func, signature);
@@ -312,6 +480,23 @@ namespace vast::hl
                 return mlir::success();
             }
 
+            // `restrict` qualified pointer parameters are lowered to `noalias`.
+            void mark_noalias_args(mlir::func::FuncOp func_op, LLVM::LLVMFuncOp new_func,
+                                   const auto &signature,
+                                   mlir::ConversionPatternRewriter &rewriter) const
+            {
+                for (auto arg : llvm::enumerate(func_op.getFunctionType().getInputs()))
+                {
+                    if (!is_restrict_pointer(arg.value()))
+                        continue;
+
+                    const auto &mapping = signature.getInputMapping(arg.index());
+                    new_func.setArgAttr(mapping->inputNo,
+                                        LLVM::LLVMDialect::getNoAliasAttrName(),
+                                        rewriter.getUnitAttr());
+                }
+            }
+
             mlir::LogicalResult args_to_allocas(
                     mlir::LLVM::LLVMFuncOp fn,
                     mlir::ConversionPatternRewriter &rewriter) const
@@ -337,8 +522,6 @@ namespace vast::hl
                 return mlir::success();
             }
 
-            // TODO(lukas): Extract common codebase (there will be other places
-            //              that need to create allocas).
             mlir::LogicalResult arg_to_alloca(mlir::BlockArgument arg, mlir::Block &block,
                                               mlir::ConversionPatternRewriter &rewriter) const
             {
@@ -346,13 +529,8 @@ namespace vast::hl
                 if (!ptr_type)
                     return mlir::failure();
 
-                auto count = rewriter.create< LLVM::ConstantOp >(
-                        arg.getLoc(),
-                        type_converter().convertType(rewriter.getIndexType()),
-                        rewriter.getIntegerAttr(rewriter.getIndexType(), 1));
-
-                auto alloca_op = rewriter.create< LLVM::AllocaOp >(
-                        arg.getLoc(), ptr_type, count, 0);
+                auto alloca_op = make_alloca_of_one(arg.getLoc(), ptr_type, rewriter,
+                                                    type_converter());
 
                 arg.replaceAllUsesWith(alloca_op);
                 rewriter.create< mlir::LLVM::StoreOp >(arg.getLoc(), arg, alloca_op);
@@ -402,27 +580,35 @@ namespace vast::hl
             }
         };
 
-        // Inline the region that is responsible for initialization
+        // Inline the single block `region` of `src` right after `src`
         //  * `rewriter` insert point is invalidated (although documentation of called
         //    methods does not state it, experimentally it is corrupted)
         //  * terminator is returned to be used & erased by caller.
         template< typename T >
-        T inline_init_region(auto src, auto &rewriter)
+        T inline_region(auto src, mlir::Region &region, auto &rewriter)
         {
-            VAST_ASSERT(size(src.getInitializer()) == 1);
-            auto &init_region = src.getInitializer();
-            auto &init_block = init_region.back();
+            VAST_ASSERT(size(region) == 1);
+            auto &block = region.back();
 
-            auto terminator = mlir::dyn_cast< T >(init_block.getTerminator());
-            VAST_ASSERT(size(init_region) == 1 && terminator);
-            rewriter.inlineRegionBefore(init_region, src->getBlock());
+            auto terminator = mlir::dyn_cast< T >(block.getTerminator());
+            VAST_ASSERT(terminator);
+            rewriter.inlineRegionBefore(region, src->getBlock());
             auto ip = std::next(mlir::Block::iterator(src));
-            VAST_ASSERT(ip != src->getBlock()->end());
 
-            rewriter.mergeBlockBefore(&init_block, &*ip);
+            if (ip != src->getBlock()->end())
+                rewriter.mergeBlockBefore(&block, &*ip);
+            else
+                rewriter.mergeBlocks(&block, src->getBlock(), llvm::None);
             return terminator;
         }
 
+        // Inline the region that is responsible for initialization
+        template< typename T >
+        T inline_init_region(auto src, auto &rewriter)
+        {
+            return inline_region< T >(src, src.getInitializer(), rewriter);
+        }
+
         struct var : BasePattern< hl::VarDeclOp >
         {
             using Base = BasePattern< hl::VarDeclOp >;
@@ -431,7 +617,7 @@ namespace vast::hl
 
 
             mlir::LogicalResult unfold_init(LLVM::AllocaOp alloca, hl::InitListExpr init,
-                                            auto &rewriter) const
+                                            bool is_volatile, auto &rewriter) const
             {
                 std::size_t i = 0;
 
@@ -449,7 +635,9 @@ namespace vast::hl
                             rewriter.getIntegerAttr(rewriter.getIndexType(), i));
                     auto where = rewriter.template create< LLVM::GEPOp >(
                             alloca.getLoc(), e_type, alloca, index.getResult());
-                    rewriter.template create< LLVM::StoreOp >(alloca.getLoc(), op, where);
+                    auto store = rewriter.template create< LLVM::StoreOp >(
+                            alloca.getLoc(), op, where, 0, is_volatile);
+                    type_converter().annotate_access(store);
                     ++i;
                 }
                 rewriter.eraseOp(init);
@@ -457,37 +645,205 @@ namespace vast::hl
             }
 
             mlir::LogicalResult make_init(LLVM::AllocaOp alloca, hl::ValueYieldOp yield,
-                                          auto &rewriter) const
+                                          bool is_volatile, auto &rewriter) const
             {
                 mlir::Value v = yield.getOperand();
                 if (auto init_list = v.getDefiningOp< hl::InitListExpr >())
-                    return unfold_init(alloca, init_list, rewriter);
+                    return unfold_init(alloca, init_list, is_volatile, rewriter);
 
-                rewriter.template create< LLVM::StoreOp >(alloca.getLoc(), v, alloca);
+                auto store = rewriter.template create< LLVM::StoreOp >(
+                        alloca.getLoc(), v, alloca, 0, is_volatile);
+                type_converter().annotate_access(store);
                 return mlir::success();
             }
 
+            static bool is_global(hl::VarDeclOp var_op)
+            {
+                return !var_op->getParentOfType< LLVM::LLVMFuncOp >()
+                    && !var_op->getParentOfType< mlir::func::FuncOp >();
+            }
+
+            static bool is_extern(hl::VarDeclOp var_op)
+            {
+                auto sc = var_op.getStorageClass();
+                return sc && *sc == StorageClass::sc_extern;
+            }
+
+            static LLVM::Linkage global_linkage(hl::VarDeclOp var_op)
+            {
+                auto sc = var_op.getStorageClass();
+                if (sc && *sc == StorageClass::sc_static)
+                    return LLVM::Linkage::Internal;
+                return LLVM::Linkage::External;
+            }
+
+            // File scope variables are lowered to globals, `const` ones to llvm
+            // constants, so they end up in read-only sections.
+            mlir::LogicalResult make_global(hl::VarDeclOp var_op,
+                                            mlir::ConversionPatternRewriter &rewriter) const
+            {
+                auto lvalue = var_op.getType().dyn_cast< hl::LValueType >();
+                if (!lvalue)
+                    return mlir::failure();
+
+                auto type = type_converter().convertType(lvalue.getElementType());
+                if (!type)
+                    return mlir::failure();
+
+                auto &init = var_op.getInitializer();
+                if (!init.empty())
+                {
+                    auto yield = mlir::dyn_cast< hl::ValueYieldOp >(init.back().getTerminator());
+                    if (!yield)
+                        return mlir::failure();
+                    // Initializer lists of locals are unfolded into stores, globals
+                    // would need a constant aggregate instead.
+                    if (yield.getOperand().getDefiningOp< hl::InitListExpr >())
+                        return var_op.emitError("unsupported aggregate initializer of global");
+                }
+
+                // Tentative definitions are zero initialized, extern declarations
+                // have no initializer at all.
+                mlir::Attribute value;
+                if (init.empty() && !is_extern(var_op))
+                {
+                    value = rewriter.getZeroAttr(type);
+                    if (!value)
+                        return mlir::failure();
+                }
+
+                auto global = rewriter.create< LLVM::GlobalOp >(
+                        var_op.getLoc(), type, var_op->hasAttr(const_attr_name),
+                        global_linkage(var_op), var_op.getName(), value,
+                        declared_alignment(var_op).value_or(0));
+
+                if (auto section = declared_section(var_op))
+                    global->setAttr("section", section.getName());
+
+                if (!init.empty())
+                {
+                    auto &global_init = global.getInitializerRegion();
+                    rewriter.inlineRegionBefore(init, global_init, global_init.end());
+
+                    auto yield = mlir::cast< hl::ValueYieldOp >(global_init.back().getTerminator());
+                    rewriter.setInsertionPoint(yield);
+                    rewriter.create< LLVM::ReturnOp >(yield.getLoc(), yield.getOperand());
+                    rewriter.eraseOp(yield);
+                }
+
+                rewriter.eraseOp(var_op);
+                return mlir::success();
+            }
+
+            static bool is_vla(hl::VarDeclOp var_op)
+            {
+                return !var_op.getAllocationSize().empty();
+            }
+
+            // Variable length arrays stay dynamic, they are allocated where they are
+            // declared with the size computed by the `allocation_size` region.
+            LLVM::AllocaOp make_vla_alloca(hl::VarDeclOp var_op,
+                                           mlir::ConversionPatternRewriter &rewriter) const
+            {
+                auto lvalue = var_op.getType().dyn_cast< hl::LValueType >();
+                if (!lvalue)
+                    return {};
+
+                auto array = lvalue.getElementType().dyn_cast< mlir::MemRefType >();
+                if (!array)
+                    return {};
+
+                auto element_type = type_converter().convertType(array.getElementType());
+                if (!element_type)
+                    return {};
+
+                auto yield = inline_region< hl::ValueYieldOp >(
+                        var_op, var_op.getAllocationSize(), rewriter);
+                rewriter.setInsertionPoint(yield);
+                auto alloca = make_alloca(var_op.getLoc(),
+                                          LLVM::LLVMPointerType::get(element_type),
+                                          yield.getOperand(), rewriter);
+                rewriter.eraseOp(yield);
+                return alloca;
+            }
+
+            // Fixed size variables are allocated in the entry block of the enclosing
+            // function.
+            LLVM::AllocaOp make_static_alloca(hl::VarDeclOp var_op, mlir::Type ptr_type,
+                                              mlir::ConversionPatternRewriter &rewriter) const
+            {
+                mlir::OpBuilder::InsertionGuard guard(rewriter);
+                if (auto fn = var_op->getParentOfType< LLVM::LLVMFuncOp >())
+                {
+                    auto &entry = fn.front();
+                    rewriter.setInsertionPoint(&entry, alloca_insertion_point(entry));
+                }
+
+                return make_alloca_of_one(var_op.getLoc(), ptr_type, rewriter,
+                                          type_converter());
+            }
+
+            // Lifetime of a variable declared in `hl.scope` is bounded by the scope.
+            void make_lifetime_markers(hl::VarDeclOp var_op, LLVM::AllocaOp alloca,
+                                       mlir::ConversionPatternRewriter &rewriter) const
+            {
+                auto scope = mlir::dyn_cast< hl::ScopeOp >(var_op->getParentOp());
+                if (!scope)
+                    return;
+
+                auto element_type = alloca.getType().cast< LLVM::LLVMPointerType >()
+                                                    .getElementType();
+                const auto &dl = type_converter().getDataLayoutAnalysis()
+                                                 ->getAtOrAbove(var_op);
+
+                mlir::OpBuilder::InsertionGuard guard(rewriter);
+                rewriter.setInsertionPoint(var_op);
+                auto bytes = rewriter.create< LLVM::ConstantOp >(
+                        var_op.getLoc(), rewriter.getI64Type(),
+                        rewriter.getI64IntegerAttr(dl.getTypeSize(element_type)));
+                rewriter.create< LLVM::LifetimeStartOp >(var_op.getLoc(), bytes, alloca);
+
+                auto &body = scope.getBody().front();
+                if (!body.empty() && body.back().hasTrait< mlir::OpTrait::IsTerminator >())
+                    rewriter.setInsertionPoint(&body.back());
+                else
+                    rewriter.setInsertionPointToEnd(&body);
+                rewriter.create< LLVM::LifetimeEndOp >(var_op.getLoc(), bytes, alloca);
+            }
+
             mlir::LogicalResult matchAndRewrite(
                     hl::VarDeclOp var_op, hl::VarDeclOp::Adaptor ops,
                     mlir::ConversionPatternRewriter &rewriter) const override
             {
+                if (is_global(var_op))
+                    return make_global(var_op, rewriter);
+
                 auto ptr_type = type_converter().convertType(var_op.getType());
                 if (!ptr_type)
                     return mlir::failure();
 
-                auto count = rewriter.create< LLVM::ConstantOp >(
-                        var_op.getLoc(),
-                        type_converter().convertType(rewriter.getIndexType()),
-                        rewriter.getIntegerAttr(rewriter.getIndexType(), 1));
-                auto alloca = rewriter.create< LLVM::AllocaOp >(
-                        var_op.getLoc(), ptr_type, count, 0);
-
-                auto yield = inline_init_region< hl::ValueYieldOp >(var_op, rewriter);
-                rewriter.setInsertionPoint(yield);
-                if (!mlir::succeeded(make_init(alloca, yield, rewriter)))
+                auto alloca = is_vla(var_op) ? make_vla_alloca(var_op, rewriter)
+                                             : make_static_alloca(var_op, ptr_type, rewriter);
+                if (!alloca)
                     return mlir::failure();
 
-                rewriter.eraseOp(yield);
+                if (auto align = declared_alignment(var_op))
+                    alloca->setAttr("alignment", rewriter.getI64IntegerAttr(*align));
+
+                if (!is_vla(var_op))
+                    make_lifetime_markers(var_op, alloca, rewriter);
+
+                if (!var_op.getInitializer().empty())
+                {
+                    auto yield = inline_init_region< hl::ValueYieldOp >(var_op, rewriter);
+                    rewriter.setInsertionPoint(yield);
+                    if (!mlir::succeeded(make_init(alloca, yield, is_volatile_access(var_op),
+                                                   rewriter)))
+                        return mlir::failure();
+
+                    rewriter.eraseOp(yield);
+                }
+
                 rewriter.replaceOp(var_op, {alloca});
 
                 return mlir::success();
@@ -532,8 +888,9 @@ namespace vast::hl
                     if (!op.getOperand().getType().isa< hl::LValueType >())
                         return mlir::failure();
 
-                    auto loaded = rewriter.create< LLVM::LoadOp >(op.getLoc(),
-                                                                  ops.getOperands()[0]);
+                    auto loaded = rewriter.create< LLVM::LoadOp >(
+                            op.getLoc(), ops.getOperands()[0], 0, is_volatile_access(op));
+                    this->type_converter().annotate_access(loaded);
                     rewriter.replaceOp(op, {loaded});
                     return mlir::success();
                 }
@@ -591,7 +948,10 @@ namespace vast::hl
                 if (ops[0].getType().template isa< hl::LValueType >())
                     return mlir::failure();
 
-                m_ops[0] = rewriter.create< LLVM::LoadOp >(op.getLoc(), alloca);
+                auto loaded = rewriter.create< LLVM::LoadOp >(
+                        op.getLoc(), alloca, 0, is_volatile_access(op));
+                this->type_converter().annotate_access(loaded);
+                m_ops[0] = loaded;
                 auto target_ty = this->type_converter().convert_type_to_type(op.getSrc().getType());
                 // Probably the easiest way to compose this (some template specialization would
                 // require a lot of boilerplate).
@@ -603,7 +963,9 @@ namespace vast::hl
                         return ops[0];
                 }();
 
-                rewriter.create< LLVM::StoreOp >(op.getLoc(), new_op, alloca);
+                auto store = rewriter.create< LLVM::StoreOp >(
+                        op.getLoc(), new_op, alloca, 0, is_volatile_access(op));
+                this->type_converter().annotate_access(store);
 
                 // `hl.assign` returns value for cases like `int x = y = 5;`
                 rewriter.replaceOp(op, {new_op});
@@ -617,6 +979,25 @@ namespace vast::hl
 
         using declref = ignore_pattern< hl::DeclRefOp >;
 
+        struct global_ref : BasePattern< hl::GlobalRefOp >
+        {
+            using Base = BasePattern< hl::GlobalRefOp >;
+            using Base::Base;
+
+            mlir::LogicalResult matchAndRewrite(
+                        hl::GlobalRefOp op, hl::GlobalRefOp::Adaptor ops,
+                        mlir::ConversionPatternRewriter &rewriter) const override
+            {
+                auto target_ty = this->type_converter().convert_type_to_type(op.getType());
+                if (!target_ty)
+                    return mlir::failure();
+
+                rewriter.replaceOpWithNewOp< LLVM::AddressOfOp >(
+                        op, *target_ty, op.getGlobal());
+                return mlir::success();
+            }
+        };
+
         struct call : BasePattern< hl::CallOp >
         {
             using Base = BasePattern< hl::CallOp >;
@@ -672,19 +1053,41 @@ namespace vast::hl
             auto convert_predicate(auto hl_predicate) const
             -> std::optional< mlir::LLVM::ICmpPredicate >
             {
-                // TODO(lukas): Use map later, this is just a proof of concept.
                 switch (hl_predicate)
                 {
-                    case hl::Predicate::eq : return { mlir::LLVM::ICmpPredicate::eq };
+                    case hl::Predicate::eq  : return { mlir::LLVM::ICmpPredicate::eq };
+                    case hl::Predicate::ne  : return { mlir::LLVM::ICmpPredicate::ne };
+                    case hl::Predicate::slt : return { mlir::LLVM::ICmpPredicate::slt };
+                    case hl::Predicate::sle : return { mlir::LLVM::ICmpPredicate::sle };
                     case hl::Predicate::sgt : return { mlir::LLVM::ICmpPredicate::sgt };
-                    default : return {};
+                    case hl::Predicate::sge : return { mlir::LLVM::ICmpPredicate::sge };
+                    case hl::Predicate::ult : return { mlir::LLVM::ICmpPredicate::ult };
+                    case hl::Predicate::ule : return { mlir::LLVM::ICmpPredicate::ule };
+                    case hl::Predicate::ugt : return { mlir::LLVM::ICmpPredicate::ugt };
+                    case hl::Predicate::uge : return { mlir::LLVM::ICmpPredicate::uge };
                 }
+                return {};
             }
         };
 
     } // namespace pattern
 
 
+    // Scopes are kept during the conversion so that variables can derive their
+    // lifetime from them, once everything is lowered they are dissolved.
+    void inline_scopes(mlir::Operation *op)
+    {
+        op->walk< mlir::WalkOrder::PostOrder >([](hl::ScopeOp scope) {
+            auto &body = scope.getBody();
+            if (!body.empty())
+            {
+                auto &ops = scope->getBlock()->getOperations();
+                ops.splice(mlir::Block::iterator(scope), body.front().getOperations());
+            }
+            scope.erase();
+        });
+    }
+
     struct HLToLLPass : HLToLLBase< HLToLLPass >
     {
         void runOnOperation() override;
@@ -699,6 +1102,7 @@ namespace vast::hl
         mlir::ConversionTarget target(mctx);
         target.addIllegalDialect< hl::HighLevelDialect >();
         target.addLegalOp< hl::TypeDefOp >();
+        target.addLegalOp< hl::ScopeOp >();
         target.addIllegalOp< mlir::func::FuncOp >();
         target.markUnknownOpDynamicallyLegal([](auto) { return true; });
 
@@ -707,6 +1111,7 @@ namespace vast::hl
         mlir::LowerToLLVMOptions llvm_options{ &mctx };
         llvm_options.useBarePtrCallConv = true;
         pattern::TypeConverter type_converter(&mctx, llvm_options , &dl_analysis);
+        type_converter.strict_aliasing = strict_aliasing;
 
         mlir::RewritePatternSet patterns(&mctx);
         patterns.add< pattern::translation_unit >(type_converter);
@@ -717,14 +1122,24 @@ namespace vast::hl
         patterns.add< pattern::add >(type_converter);
         patterns.add< pattern::sub >(type_converter);
         patterns.add< pattern::declref >(type_converter);
+        patterns.add< pattern::global_ref >(type_converter);
         patterns.add< pattern::assign_add >(type_converter);
         patterns.add< pattern::assign_sub >(type_converter);
         patterns.add< pattern::assign >(type_converter);
         patterns.add< pattern::implicit_cast >(type_converter);
         patterns.add< pattern::call >(type_converter);
         patterns.add< pattern::cmp >(type_converter);
+
+        // Partial conversion fails unless all illegal operations are converted.
+        op->walk([&] (mlir::Operation *nested) {
+            if (target.isIllegal(nested))
+                ++ops_converted;
+        });
+
         if (mlir::failed(mlir::applyPartialConversion(op, target, std::move(patterns))))
             return signalPassFailure();
+
+        inline_scopes(op);
     }
 }
 
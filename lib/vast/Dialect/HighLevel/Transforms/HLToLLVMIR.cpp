@@ -0,0 +1,1702 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/ExecutionEngine/ExecutionEngine.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+#include <llvm/ADT/DepthFirstIterator.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/Triple.h>
+#include <llvm/ADT/TypeSwitch.h>
+#include <llvm/IR/CFG.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Module.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+#include "HLToLLVMIR.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <algorithm>
+#include <optional>
+
+namespace vast::hl
+{
+    //
+    // Direct translation to llvm ir
+    //
+    // A translation unit is emitted in a single walk over its operations,
+    // without materializing any intermediate dialect. Local variables live in
+    // stack slots allocated in the entry block and expressions are emitted as
+    // they are reached, so the result resembles unoptimized output of clang.
+    // Structured control flow is emitted into blocks named after their clang
+    // counterparts, jumps branch to the blocks recorded for their targets.
+    //
+    namespace
+    {
+        mlir::Type value_type(mlir::Type type)
+        {
+            if (auto lvalue = type.dyn_cast< LValueType >())
+                return lvalue.getElementType();
+            return type;
+        }
+
+        enum class arith_kind { add, sub, mul, sdiv, udiv, fdiv, srem, urem, frem,
+                                band, bor, bxor, shl, shr };
+
+        // Arithmetic of binary operations and of their compound assignments.
+        std::optional< arith_kind > arith_kind_of(mlir::Operation *op)
+        {
+            using kind = std::optional< arith_kind >;
+            return llvm::TypeSwitch< mlir::Operation *, kind >(op)
+                .Case< AddIOp, AddFOp, AddIAssignOp, AddFAssignOp >([] (auto) { return arith_kind::add; })
+                .Case< SubIOp, SubFOp, SubIAssignOp, SubFAssignOp >([] (auto) { return arith_kind::sub; })
+                .Case< MulIOp, MulFOp, MulIAssignOp, MulFAssignOp >([] (auto) { return arith_kind::mul; })
+                .Case< DivSOp, DivSAssignOp >([] (auto) { return arith_kind::sdiv; })
+                .Case< DivUOp, DivUAssignOp >([] (auto) { return arith_kind::udiv; })
+                .Case< DivFOp, DivFAssignOp >([] (auto) { return arith_kind::fdiv; })
+                .Case< RemSOp, RemSAssignOp >([] (auto) { return arith_kind::srem; })
+                .Case< RemUOp, RemUAssignOp >([] (auto) { return arith_kind::urem; })
+                .Case< RemFOp, RemFAssignOp >([] (auto) { return arith_kind::frem; })
+                .Case< BinAndOp, BinAndAssignOp >([] (auto) { return arith_kind::band; })
+                .Case< BinOrOp, BinOrAssignOp >([] (auto) { return arith_kind::bor; })
+                .Case< BinXorOp, BinXorAssignOp >([] (auto) { return arith_kind::bxor; })
+                .Case< BinShlOp, BinShlAssignOp >([] (auto) { return arith_kind::shl; })
+                .Case< BinShrOp, BinShrAssignOp >([] (auto) { return arith_kind::shr; })
+                .Default([] (auto) -> kind { return std::nullopt; });
+        }
+
+        bool is_compound_assign(mlir::Operation *op)
+        {
+            return mlir::isa<
+                AddIAssignOp, AddFAssignOp, SubIAssignOp, SubFAssignOp, MulIAssignOp, MulFAssignOp,
+                DivSAssignOp, DivUAssignOp, DivFAssignOp, RemSAssignOp, RemUAssignOp, RemFAssignOp,
+                BinAndAssignOp, BinOrAssignOp, BinXorAssignOp, BinShlAssignOp, BinShrAssignOp
+            >(op);
+        }
+
+        //
+        // Types, functions and globals of the translated unit.
+        //
+        struct unit_translator
+        {
+            llvm::Module &lmod;
+            llvm::LLVMContext &lctx;
+            mlir::DataLayout dl;
+
+            llvm::StringMap< mlir::func::FuncOp > functions;
+            llvm::StringMap< mlir::Operation * > records;
+            llvm::StringMap< EnumDeclOp > enums;
+            llvm::StringMap< mlir::Type > typedefs;
+            llvm::StringMap< EnumConstantOp > enum_constants;
+
+            llvm::StringMap< llvm::StructType * > structs;
+            llvm::StringMap< llvm::GlobalVariable * > strings;
+
+            unit_translator(mlir::ModuleOp mod, llvm::Module &lmod)
+                : lmod(lmod), lctx(lmod.getContext()), dl(mod)
+            {
+                // Sizes of types are queried during the translation, hence the
+                // target has to be known upfront.
+                if (lmod.getDataLayout().isDefault())
+                    mlir::ExecutionEngine::setupTargetTriple(&lmod);
+
+                mod.walk([&] (mlir::Operation *op) {
+                    llvm::TypeSwitch< mlir::Operation * >(op)
+                        .Case([&] (mlir::func::FuncOp fn) {
+                            functions.try_emplace(fn.getName(), fn);
+                        })
+                        .Case< StructDeclOp, UnionDeclOp >([&] (auto decl) {
+                            // Forward declarations are superseded by definitions.
+                            auto &entry = records[decl.getName()];
+                            if (!entry || entry->getRegion(0).empty())
+                                entry = decl;
+                        })
+                        .Case([&] (EnumDeclOp decl) { enums[decl.getName()] = decl; })
+                        .Case([&] (TypeDefOp def) { typedefs[def.getName()] = def.getType(); })
+                        .Case([&] (EnumConstantOp cst) { enum_constants[cst.getName()] = cst; });
+                });
+            }
+
+            const llvm::DataLayout &target_layout() const { return lmod.getDataLayout(); }
+
+            // Strips the type sugar, enumerations are resolved to their
+            // underlying type.
+            mlir::Type resolve(mlir::Type type)
+            {
+                while (true) {
+                    if (auto elaborated = type.dyn_cast< ElaboratedType >()) {
+                        type = elaborated.getElementType();
+                    } else if (auto paren = type.dyn_cast< ParenType >()) {
+                        type = paren.getElementType();
+                    } else if (auto decayed = type.dyn_cast< DecayedType >()) {
+                        type = decayed.getElementType();
+                    } else if (auto def = type.dyn_cast< TypedefType >()) {
+                        auto underlying = typedefs.find(def.getName());
+                        if (underlying == typedefs.end())
+                            return type;
+                        type = underlying->second;
+                    } else if (auto tag = type.dyn_cast< RecordType >()) {
+                        auto decl = enums.find(tag.getName());
+                        if (decl == enums.end())
+                            return type;
+                        type = decl->second.getType();
+                    } else if (auto tag = type.dyn_cast< EnumType >()) {
+                        auto decl = enums.find(tag.getName());
+                        if (decl == enums.end())
+                            return type;
+                        type = decl->second.getType();
+                    } else {
+                        return type;
+                    }
+                }
+            }
+
+            bool is_signed(mlir::Type type)
+            {
+                type = resolve(value_type(type));
+                if (auto builtin = type.dyn_cast< mlir::IntegerType >())
+                    return !builtin.isUnsigned();
+                return (isIntegerType(type) || isBoolType(type)) && isSigned(type);
+            }
+
+            bool is_volatile(mlir::Type type)
+            {
+                return isVolatileQualified(value_type(type));
+            }
+
+            llvm::SmallVector< FieldDeclOp > fields(mlir::Operation *decl)
+            {
+                llvm::SmallVector< FieldDeclOp > result;
+                for (auto &block : decl->getRegion(0))
+                    for (auto &op : block)
+                        if (auto field = mlir::dyn_cast< FieldDeclOp >(op))
+                            result.push_back(field);
+                return result;
+            }
+
+            mlir::Operation *record_decl(mlir::Type type)
+            {
+                if (auto record = resolve(value_type(type)).dyn_cast< RecordType >())
+                    return records.lookup(record.getName());
+                return nullptr;
+            }
+
+            bool is_union(mlir::Type type)
+            {
+                return mlir::isa_and_nonnull< UnionDeclOp >(record_decl(type));
+            }
+
+            llvm::Type *convert(mlir::Type type)
+            {
+                return llvm::TypeSwitch< mlir::Type, llvm::Type * >(resolve(type))
+                    .Case< LValueType, PointerType >([&] (auto ptr) -> llvm::Type * {
+                        return pointer_to(ptr.getElementType());
+                    })
+                    .Case([&] (VoidType) { return llvm::Type::getVoidTy(lctx); })
+                    .Case< BoolType, CharType, ShortType, IntType, LongType, LongLongType,
+                           Int128Type >([&] (auto ty) -> llvm::Type * {
+                        return llvm::IntegerType::get(lctx, dl.getTypeSizeInBits(ty));
+                    })
+                    .Case< HalfType, BFloat16Type, FloatType, DoubleType, LongDoubleType,
+                           Float128Type >([&] (auto ty) {
+                        return float_type(to_std_float_type(ty).template cast< mlir::FloatType >());
+                    })
+                    .Case([&] (ArrayType arr) -> llvm::Type * {
+                        auto element = convert(arr.getElementType());
+                        if (!element)
+                            return nullptr;
+                        // Arrays of unknown size are accessed only through
+                        // pointers to their elements.
+                        auto size = arr.getSize();
+                        return llvm::ArrayType::get(element, size ? *size : 0);
+                    })
+                    .Case([&] (RecordType record) { return record_type(record.getName()); })
+                    .Case([&] (mlir::FunctionType fty) { return function_type(fty); })
+                    .Case([&] (mlir::IntegerType ty) {
+                        return llvm::IntegerType::get(lctx, ty.getWidth());
+                    })
+                    .Case([&] (mlir::IndexType) { return llvm::Type::getInt64Ty(lctx); })
+                    .Case([&] (mlir::FloatType ty) { return float_type(ty); })
+                    .Default([] (auto) -> llvm::Type * { return nullptr; });
+            }
+
+            llvm::Type *float_type(mlir::FloatType type)
+            {
+                switch (type.getWidth()) {
+                    case 16: return type.isBF16() ? llvm::Type::getBFloatTy(lctx)
+                                                  : llvm::Type::getHalfTy(lctx);
+                    case 32: return llvm::Type::getFloatTy(lctx);
+                    case 64: return llvm::Type::getDoubleTy(lctx);
+                    case 128: return llvm::Type::getFP128Ty(lctx);
+                    default: break;
+                }
+
+                // `long double` is extended precision only on x86 targets.
+                if (llvm::Triple(lmod.getTargetTriple()).isX86())
+                    return llvm::Type::getX86_FP80Ty(lctx);
+                return llvm::Type::getFP128Ty(lctx);
+            }
+
+            // Pointers to `void` and to unknown types point to bytes.
+            llvm::PointerType *pointer_to(mlir::Type element)
+            {
+                auto type = convert(element);
+                if (!type || type->isVoidTy())
+                    type = llvm::Type::getInt8Ty(lctx);
+                return type->getPointerTo();
+            }
+
+            llvm::Type *pointee(mlir::Type pointer)
+            {
+                auto ptr = resolve(value_type(pointer)).dyn_cast< PointerType >();
+                if (!ptr)
+                    return nullptr;
+                auto type = convert(ptr.getElementType());
+                if (!type || type->isVoidTy())
+                    return llvm::Type::getInt8Ty(lctx);
+                return type;
+            }
+
+            // Records are named types, they are created before their fields
+            // are converted, so that they can refer to themselves.
+            llvm::Type *record_type(llvm::StringRef name)
+            {
+                if (auto type = structs.lookup(name))
+                    return type;
+
+                auto decl = records.lookup(name);
+                auto prefix = mlir::isa_and_nonnull< UnionDeclOp >(decl) ? "union." : "struct.";
+                auto type = llvm::StructType::create(lctx, (llvm::Twine(prefix) + name).str());
+                structs[name] = type;
+
+                // Incomplete records stay opaque.
+                if (!decl || decl->getRegion(0).empty())
+                    return type;
+
+                llvm::SmallVector< llvm::Type * > elements;
+                for (auto field : fields(decl)) {
+                    auto element = field.getBits() ? nullptr : convert(field.getType());
+                    if (!element) {
+                        if (field.getBits())
+                            field.emitError("unsupported bit-field in translation to llvm ir");
+                        structs.erase(name);
+                        return nullptr;
+                    }
+                    elements.push_back(element);
+                }
+
+                if (mlir::isa< UnionDeclOp >(decl) && !elements.empty())
+                    elements = union_body(elements);
+
+                type->setBody(elements);
+                return type;
+            }
+
+            // A union is represented by its most aligned member padded to the
+            // size of the largest one.
+            llvm::SmallVector< llvm::Type * > union_body(llvm::ArrayRef< llvm::Type * > members)
+            {
+                auto &layout = target_layout();
+                llvm::Type *aligned = nullptr;
+                uint64_t size = 0;
+                for (auto member : members) {
+                    size = std::max(size, uint64_t(layout.getTypeAllocSize(member)));
+                    if (!aligned || layout.getABITypeAlign(member) > layout.getABITypeAlign(aligned))
+                        aligned = member;
+                }
+
+                llvm::SmallVector< llvm::Type * > body = { aligned };
+                auto aligned_size = uint64_t(layout.getTypeAllocSize(aligned));
+                if (size > aligned_size)
+                    body.push_back(llvm::ArrayType::get(llvm::Type::getInt8Ty(lctx),
+                                                        size - aligned_size));
+                return body;
+            }
+
+            std::optional< unsigned > field_index(mlir::Operation *decl, llvm::StringRef name)
+            {
+                for (auto field : llvm::enumerate(fields(decl)))
+                    if (field.value().getName() == name)
+                        return unsigned(field.index());
+                return std::nullopt;
+            }
+
+            // Parameters of functions are lvalues, `void` result means none.
+            llvm::FunctionType *function_type(mlir::FunctionType type)
+            {
+                llvm::SmallVector< llvm::Type * > params;
+                for (auto input : type.getInputs()) {
+                    auto param = convert(value_type(input));
+                    if (!param)
+                        return nullptr;
+                    params.push_back(param);
+                }
+
+                auto result = type.getNumResults() == 0
+                    ? llvm::Type::getVoidTy(lctx) : convert(type.getResult(0));
+                if (!result)
+                    return nullptr;
+                return llvm::FunctionType::get(result, params, false);
+            }
+
+            void apply_attributes(mlir::func::FuncOp op, llvm::Function *fn)
+            {
+                auto add = [&] (auto attr, std::initializer_list< llvm::Attribute::AttrKind > kinds) {
+                    if (op->hasAttr(decltype(attr)::getMnemonic()))
+                        for (auto kind : kinds)
+                            fn->addFnAttr(kind);
+                };
+
+                add(AlwaysInlineAttr(), { llvm::Attribute::AlwaysInline });
+                add(NoInlineAttr(),     { llvm::Attribute::NoInline });
+                add(HotAttr(),          { llvm::Attribute::Hot });
+                add(ColdAttr(),         { llvm::Attribute::Cold });
+                add(NoReturnAttr(),     { llvm::Attribute::NoReturn });
+                if (op->hasAttr(ConstAttr::getMnemonic()))
+                    add(ConstAttr(),    { llvm::Attribute::ReadNone, llvm::Attribute::NoUnwind });
+                else
+                    add(PureAttr(),     { llvm::Attribute::ReadOnly, llvm::Attribute::NoUnwind });
+
+                if (auto section = op->getAttrOfType< SectionAttr >(SectionAttr::getMnemonic()))
+                    fn->setSection(section.getName().getValue());
+                if (auto aligned = op->getAttrOfType< AlignedAttr >(AlignedAttr::getMnemonic()))
+                    fn->setAlignment(llvm::Align(aligned.getAlignment()));
+
+                // `restrict` qualified pointer parameters are `noalias`.
+                for (auto input : llvm::enumerate(op.getFunctionType().getInputs())) {
+                    auto type = value_type(input.value());
+                    if (type.isa< PointerType >() && isRestrictQualified(type))
+                        fn->addParamAttr(unsigned(input.index()), llvm::Attribute::NoAlias);
+                }
+            }
+
+            // A prototype of a different signature, e.g., of a function declared
+            // without parameters, is replaced once the function is defined.
+            llvm::Function *declare(mlir::func::FuncOp op, bool definition)
+            {
+                auto type = function_type(op.getFunctionType());
+                if (!type)
+                    return nullptr;
+
+                auto fn = lmod.getFunction(op.getName());
+                if (fn && (!definition || fn->getFunctionType() == type))
+                    return fn;
+
+                auto fresh = llvm::Function::Create(type, llvm::GlobalValue::ExternalLinkage,
+                                                    op.getName(), lmod);
+                if (fn) {
+                    fresh->takeName(fn);
+                    fn->replaceAllUsesWith(llvm::ConstantExpr::getPointerCast(fresh, fn->getType()));
+                    fn->eraseFromParent();
+                }
+
+                apply_attributes(op, fresh);
+                return fresh;
+            }
+
+            llvm::Function *function(llvm::StringRef name)
+            {
+                if (auto fn = lmod.getFunction(name))
+                    return fn;
+                auto op = functions.find(name);
+                return op != functions.end() ? declare(op->second, false) : nullptr;
+            }
+
+            // Incomplete declarations, e.g., of arrays of unknown size, are
+            // replaced once the variable is defined.
+            llvm::GlobalVariable *global(llvm::StringRef name, llvm::Type *type, bool definition)
+            {
+                auto gv = lmod.getGlobalVariable(name, /* AllowInternal */ true);
+                if (gv && (!definition || gv->getValueType() == type))
+                    return gv;
+
+                auto fresh = new llvm::GlobalVariable(lmod, type, false,
+                                                      llvm::GlobalValue::ExternalLinkage,
+                                                      nullptr, name);
+                if (gv) {
+                    fresh->takeName(gv);
+                    gv->replaceAllUsesWith(llvm::ConstantExpr::getPointerCast(fresh, gv->getType()));
+                    gv->eraseFromParent();
+                }
+                return fresh;
+            }
+
+            llvm::GlobalVariable *string_literal(llvm::StringRef value, llvm::ArrayType *type)
+            {
+                auto &gv = strings[value];
+                if (gv && gv->getValueType() == type)
+                    return gv;
+
+                llvm::SmallVector< char > bytes(type->getNumElements(), 0);
+                std::copy_n(value.begin(), std::min(value.size(), bytes.size()), bytes.begin());
+                auto init = llvm::ConstantDataArray::getString(
+                    lctx, llvm::StringRef(bytes.data(), bytes.size()), /* AddNull */ false
+                );
+
+                gv = new llvm::GlobalVariable(lmod, init->getType(), true,
+                                              llvm::GlobalValue::PrivateLinkage, init, ".str");
+                gv->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+                gv->setAlignment(llvm::Align(1));
+                return gv;
+            }
+
+            llvm::GlobalVariable *define_global(VarDeclOp var, llvm::StringRef name);
+            mlir::LogicalResult define_function(mlir::func::FuncOp op);
+            mlir::LogicalResult translate(mlir::Operation *op);
+        };
+
+        //
+        // Emission of statements and expressions of a function body, or of
+        // a constant initializer of a global. The latter has no insertion
+        // point, hence the builder folds all operations into constants.
+        //
+        struct emitter
+        {
+            struct jump_targets
+            {
+                llvm::BasicBlock *exit;
+                llvm::BasicBlock *next;
+            };
+
+            unit_translator &unit;
+            llvm::LLVMContext &lctx;
+            llvm::IRBuilder<> irb;
+
+            llvm::Function *fn = nullptr;
+            llvm::Instruction *last_alloca = nullptr;
+
+            llvm::DenseMap< mlir::Value, llvm::Value * > values;
+            llvm::DenseMap< mlir::Value, llvm::BasicBlock * > labels;
+            llvm::DenseMap< mlir::Operation *, jump_targets > targets;
+            llvm::DenseMap< mlir::Operation *, llvm::BasicBlock * > cases;
+
+            explicit emitter(unit_translator &unit)
+                : unit(unit), lctx(unit.lctx), irb(unit.lctx)
+            {}
+
+            llvm::Value *lookup(mlir::Value value) { return values.lookup(value); }
+
+            mlir::LogicalResult bind(mlir::Operation *op, llvm::Value *value)
+            {
+                if (!value)
+                    return op->emitError("unable to translate operation to llvm ir");
+                values[op->getResult(0)] = value;
+                return mlir::success();
+            }
+
+            llvm::Type *convert(mlir::Type type) { return unit.convert(type); }
+
+            //
+            // Blocks
+            //
+            llvm::BasicBlock *block(const llvm::Twine &name)
+            {
+                return llvm::BasicBlock::Create(lctx, name);
+            }
+
+            // Branches to `bb` unless the current block is already terminated.
+            llvm::BranchInst *branch(llvm::BasicBlock *bb)
+            {
+                auto current = irb.GetInsertBlock();
+                if (current->getTerminator())
+                    return nullptr;
+                return irb.CreateBr(bb);
+            }
+
+            void start(llvm::BasicBlock *bb)
+            {
+                if (!bb->getParent())
+                    fn->getBasicBlockList().push_back(bb);
+                irb.SetInsertPoint(bb);
+            }
+
+            void fall_through(llvm::BasicBlock *bb)
+            {
+                branch(bb);
+                start(bb);
+            }
+
+            // Code following a jump is unreachable, it is emitted into a fresh
+            // block that is dropped at the end.
+            void start_unreachable() { start(block("")); }
+
+            llvm::BasicBlock *label_block(mlir::Value label)
+            {
+                auto &bb = labels[label];
+                if (!bb) {
+                    auto decl = label.getDefiningOp< LabelDeclOp >();
+                    bb = block(decl ? decl.getName() : "label");
+                }
+                return bb;
+            }
+
+            // Conditional branches have a pair of weights, switches have the
+            // weight of the default destination followed by those of cases.
+            llvm::MDNode *branch_weights(mlir::Operation *op, unsigned size = 2)
+            {
+                auto weights = op->getAttrOfType< mlir::ArrayAttr >(branch_weights_attr_name);
+                if (!weights || weights.size() != size)
+                    return nullptr;
+
+                llvm::SmallVector< uint32_t > values;
+                for (auto weight : weights.getAsRange< mlir::IntegerAttr >())
+                    values.push_back(uint32_t(weight.getInt()));
+                return llvm::MDBuilder(lctx).createBranchWeights(values);
+            }
+
+            void attach_loop_hints(mlir::Operation *op, llvm::Instruction *latch)
+            {
+                auto hints = op->getAttrOfType< mlir::DictionaryAttr >(loop_hints_attr_name);
+                if (hints && latch)
+                    latch->setMetadata(llvm::LLVMContext::MD_loop, make_loop_id(lctx, hints));
+            }
+
+            //
+            // Memory
+            //
+            llvm::Value *cast_pointer(llvm::Value *ptr, llvm::Type *element)
+            {
+                return irb.CreatePointerCast(ptr, element->getPointerTo());
+            }
+
+            // Stack slots are allocated in the entry block in order of their
+            // declarations.
+            llvm::AllocaInst *make_alloca(llvm::Type *type, const llvm::Twine &name = "")
+            {
+                auto &entry = fn->getEntryBlock();
+                llvm::IRBuilder<> bld(&entry, last_alloca ? std::next(last_alloca->getIterator())
+                                                          : entry.begin());
+                auto alloca = bld.CreateAlloca(type, nullptr, name);
+                last_alloca = alloca;
+                return alloca;
+            }
+
+            llvm::Value *load(llvm::Type *type, llvm::Value *addr, bool is_volatile)
+            {
+                if (!fn || !type || !addr)
+                    return nullptr;
+                return irb.CreateLoad(type, cast_pointer(addr, type), is_volatile);
+            }
+
+            void store(llvm::Value *value, llvm::Value *addr, bool is_volatile)
+            {
+                irb.CreateStore(value, cast_pointer(addr, value->getType()), is_volatile);
+            }
+
+            //
+            // Regions
+            //
+            mlir::LogicalResult emit(mlir::Region &region)
+            {
+                for (auto &block : region)
+                    for (auto &op : block)
+                        if (mlir::failed(emit(&op)))
+                            return mlir::failure();
+                return mlir::success();
+            }
+
+            // Value yielded by the terminator of a value or condition region.
+            static mlir::Value yield_of(mlir::Region &region)
+            {
+                if (region.empty() || region.back().empty())
+                    return {};
+                auto &yield = region.back().back();
+                return yield.getNumOperands() ? yield.getOperand(0) : mlir::Value();
+            }
+
+            llvm::Value *to_bool(llvm::Value *value)
+            {
+                auto type = value->getType();
+                if (type->isIntegerTy(1))
+                    return value;
+                if (type->isFloatingPointTy())
+                    return irb.CreateFCmpUNE(value, llvm::ConstantFP::get(type, 0.0));
+                return irb.CreateIsNotNull(value);
+            }
+
+            // An empty condition, e.g., of `for (;;)`, holds.
+            llvm::Value *emit_condition(mlir::Region &region)
+            {
+                if (region.empty())
+                    return irb.getTrue();
+                if (mlir::failed(emit(region)))
+                    return nullptr;
+                auto value = lookup(yield_of(region));
+                return value ? to_bool(value) : nullptr;
+            }
+
+            //
+            // Operations
+            //
+            mlir::LogicalResult emit(mlir::Operation *op)
+            {
+                return llvm::TypeSwitch< mlir::Operation *, mlir::LogicalResult >(op)
+                    .Case< TypeDefOp, TypeDeclOp, StructDeclOp, UnionDeclOp, EnumDeclOp,
+                           LabelDeclOp, SkipStmt, InitListExpr, ValueYieldOp, CondYieldOp
+                    >([] (auto) { return mlir::success(); })
+                    .Case([&] (ConstantOp cst) { return bind(op, constant(cst)); })
+                    .Case([&] (VarDeclOp var) { return emit_var(var); })
+                    .Case([&] (DeclRefOp ref) { return bind(op, lookup(ref.getDecl())); })
+                    .Case([&] (GlobalRefOp ref) {
+                        auto type = convert(value_type(ref.getType()));
+                        return bind(op, type ? unit.global(ref.getGlobal(), type, false) : nullptr);
+                    })
+                    .Case([&] (FuncRefOp ref) { return bind(op, unit.function(ref.getFunction())); })
+                    .Case([&] (EnumRefOp ref) { return bind(op, enum_constant(ref)); })
+                    .Case< ImplicitCastOp, CStyleCastOp, BuiltinBitCastOp >([&] (auto cast) {
+                        return bind(op, emit_cast(cast.getKind(), cast.getValue(), cast.getType()));
+                    })
+                    .Case([&] (AddressOf addr) { return bind(op, lookup(addr.getValue())); })
+                    .Case([&] (Deref deref) { return bind(op, lookup(deref.getAddr())); })
+                    .Case([&] (SubscriptOp sub) { return bind(op, subscript(sub)); })
+                    .Case([&] (RecordMemberOp member) { return bind(op, record_member(member)); })
+                    .Case([&] (CmpOp cmp) { return bind(op, compare(cmp)); })
+                    .Case< BinLAndOp, BinLOrOp >([&] (auto logic) {
+                        auto lhs = to_bool(lookup(logic.getLhs()));
+                        auto rhs = to_bool(lookup(logic.getRhs()));
+                        auto value = mlir::isa< BinLAndOp >(op) ? irb.CreateAnd(lhs, rhs)
+                                                                 : irb.CreateOr(lhs, rhs);
+                        return bind(op, irb.CreateZExt(value, convert(logic.getType())));
+                    })
+                    .Case([&] (BinComma comma) { return bind(op, lookup(comma.getRhs())); })
+                    .Case< PlusOp, MinusOp, NotOp, LNotOp >([&] (auto un) {
+                        return bind(op, unary(op, lookup(un.getArg())));
+                    })
+                    .Case< PreIncOp, PreDecOp, PostIncOp, PostDecOp >([&] (auto) {
+                        return bind(op, inc_dec(op));
+                    })
+                    .Case([&] (AssignOp assign) { return bind(op, emit_assign(assign)); })
+                    .Case< SizeOfTypeOp, AlignOfTypeOp >([&] (auto trait) {
+                        return bind(op, type_trait(op, trait.getArg()));
+                    })
+                    .Case< SizeOfExprOp, AlignOfExprOp >([&] (auto trait) {
+                        // The expression is not evaluated, only its type matters.
+                        auto value = yield_of(trait.getExpr());
+                        return bind(op, value ? type_trait(op, value_type(value.getType())) : nullptr);
+                    })
+                    .Case([&] (ExprOp expr) {
+                        if (mlir::failed(emit(expr.getSubexpr())))
+                            return mlir::failure();
+                        return bind(op, lookup(yield_of(expr.getSubexpr())));
+                    })
+                    .Case([&] (CallOp call) {
+                        auto callee = unit.function(call.getCallee());
+                        auto type = callee ? callee->getFunctionType() : nullptr;
+                        return bind(op, emit_call(type, callee, call.getArgOperands()));
+                    })
+                    .Case([&] (IndirectCallOp call) {
+                        auto type = unit.function_type(getFunctionType(call.getCallee().getType()));
+                        auto callee = lookup(call.getCallee());
+                        return bind(op, emit_call(type, callee, call.getArgOperands()));
+                    })
+                    .Case([&] (ScopeOp scope) { return emit(scope.getBody()); })
+                    .Case([&] (IfOp stmt) { return emit_if(stmt); })
+                    .Case([&] (WhileOp stmt) { return emit_while(stmt); })
+                    .Case([&] (ForOp stmt) { return emit_for(stmt); })
+                    .Case([&] (DoOp stmt) { return emit_do(stmt); })
+                    .Case([&] (SwitchOp stmt) { return emit_switch(stmt); })
+                    .Case< CaseOp, DefaultOp >([&] (auto stmt) -> mlir::LogicalResult {
+                        auto bb = cases.lookup(op);
+                        if (!bb)
+                            return op->emitError("case outside of switch");
+                        fall_through(bb);
+                        return emit(stmt.getBody());
+                    })
+                    .Case< BreakOp, ContinueOp >([&] (auto) { return emit_jump(op); })
+                    .Case([&] (LabelStmt stmt) {
+                        fall_through(label_block(stmt.getLabel()));
+                        return emit(stmt.getSubstmt());
+                    })
+                    .Case([&] (GotoStmt stmt) {
+                        branch(label_block(stmt.getLabel()));
+                        start_unreachable();
+                        return mlir::success();
+                    })
+                    .Case([&] (ReturnOp ret) { return emit_return(ret); })
+                    .Case([&] (UnreachableOp) {
+                        irb.CreateUnreachable();
+                        start_unreachable();
+                        return mlir::success();
+                    })
+                    .Default([&] (mlir::Operation *) -> mlir::LogicalResult {
+                        if (auto kind = arith_kind_of(op))
+                            return bind(op, is_compound_assign(op) ? compound_assign(op, *kind)
+                                                                   : binary(op, *kind));
+                        return op->emitError("unsupported operation in translation to llvm ir");
+                    });
+            }
+
+            //
+            // Constants
+            //
+            llvm::Value *constant(ConstantOp op)
+            {
+                auto type = convert(op.getType());
+                if (!type)
+                    return nullptr;
+
+                auto attr = op.getValue();
+                if (auto value = attr.dyn_cast< IntegerAttr >())
+                    return llvm::ConstantInt::get(type, value.getValue().extOrTrunc(
+                        type->getIntegerBitWidth()
+                    ));
+                if (auto value = attr.dyn_cast< BooleanAttr >())
+                    return llvm::ConstantInt::get(type, value.getValue());
+                if (auto value = attr.dyn_cast< FloatAttr >())
+                    return make_float(type, value.getValue());
+                if (auto value = attr.dyn_cast< StringAttr >()) {
+                    auto arr = llvm::dyn_cast< llvm::ArrayType >(type);
+                    return arr ? unit.string_literal(value.getValue(), arr) : nullptr;
+                }
+                if (auto value = attr.dyn_cast< mlir::IntegerAttr >())
+                    return llvm::ConstantInt::get(type, value.getValue());
+                if (auto value = attr.dyn_cast< mlir::FloatAttr >())
+                    return make_float(type, value.getValue());
+                return nullptr;
+            }
+
+            llvm::Constant *make_float(llvm::Type *type, llvm::APFloat value)
+            {
+                bool loses_info = false;
+                value.convert(type->getFltSemantics(), llvm::APFloat::rmNearestTiesToEven,
+                              &loses_info);
+                return llvm::ConstantFP::get(lctx, value);
+            }
+
+            llvm::Value *enum_constant(EnumRefOp ref)
+            {
+                auto type = convert(ref.getType());
+                auto decl = unit.enum_constants.lookup(ref.getValue());
+                if (!type || !decl)
+                    return nullptr;
+
+                auto value = decl.getValue().dyn_cast< IntegerAttr >();
+                if (!value)
+                    return nullptr;
+                return llvm::ConstantInt::get(type, value.getValue().extOrTrunc(
+                    type->getIntegerBitWidth()
+                ));
+            }
+
+            llvm::Value *type_trait(mlir::Operation *op, mlir::Type arg)
+            {
+                auto result = convert(op->getResult(0).getType());
+                auto type = convert(arg);
+                if (!result || !type || !type->isSized())
+                    return nullptr;
+
+                auto &layout = unit.target_layout();
+                auto value = mlir::isa< SizeOfTypeOp, SizeOfExprOp >(op)
+                    ? uint64_t(layout.getTypeAllocSize(type))
+                    : uint64_t(layout.getABITypeAlign(type).value());
+                return llvm::ConstantInt::get(result, value);
+            }
+
+            //
+            // Casts
+            //
+            // Conversion of scalars of the same category, the signedness of
+            // integers is given by their high-level types.
+            llvm::Value *convert_scalar(llvm::Value *value, mlir::Type from,
+                                        llvm::Type *to, mlir::Type to_hl)
+            {
+                auto src = value->getType();
+                if (src == to)
+                    return value;
+
+                if (src->isIntegerTy() && to->isIntegerTy())
+                    return irb.CreateIntCast(value, to, unit.is_signed(from));
+                if (src->isIntegerTy() && to->isFloatingPointTy())
+                    return unit.is_signed(from) ? irb.CreateSIToFP(value, to)
+                                                : irb.CreateUIToFP(value, to);
+                if (src->isFloatingPointTy() && to->isIntegerTy())
+                    return unit.is_signed(to_hl) ? irb.CreateFPToSI(value, to)
+                                                 : irb.CreateFPToUI(value, to);
+                if (src->isFloatingPointTy() && to->isFloatingPointTy())
+                    return irb.CreateFPCast(value, to);
+                if (src->isPointerTy() && to->isPointerTy())
+                    return irb.CreatePointerCast(value, to);
+                return nullptr;
+            }
+
+            // Decayed arrays point to their first element.
+            llvm::Value *decay(llvm::Value *addr, mlir::Type array)
+            {
+                auto type = llvm::dyn_cast_or_null< llvm::ArrayType >(convert(array));
+                if (!type)
+                    return nullptr;
+                if (type->getNumElements() == 0)
+                    return cast_pointer(addr, type->getElementType());
+                return irb.CreateConstInBoundsGEP2_32(type, cast_pointer(addr, type), 0, 0);
+            }
+
+            llvm::Value *emit_cast(CastKind kind, mlir::Value arg, mlir::Type result)
+            {
+                auto value = lookup(arg);
+                auto to = convert(value_type(result));
+                if (!value || !to)
+                    return nullptr;
+
+                auto from = arg.getType();
+
+                switch (kind) {
+                    case CastKind::LValueToRValue:
+                        return load(to, value, unit.is_volatile(from));
+                    case CastKind::NoOp:
+                    case CastKind::ToVoid:
+                    case CastKind::FunctionToPointerDecay:
+                    case CastKind::BuiltinFnToFnPtr:
+                    case CastKind::AtomicToNonAtomic:
+                    case CastKind::NonAtomicToAtomic:
+                        if (value->getType()->isPointerTy() && to->isPointerTy())
+                            return irb.CreatePointerCast(value, to);
+                        return value;
+                    case CastKind::ArrayToPointerDecay:
+                        return decay(value, value_type(from));
+                    case CastKind::BitCast:
+                    case CastKind::LValueBitCast:
+                    case CastKind::LValueToRValueBitCast:
+                        return irb.CreateBitOrPointerCast(value, to);
+                    case CastKind::NullToPointer:
+                        return llvm::Constant::getNullValue(to);
+                    case CastKind::IntegralToPointer:
+                        return irb.CreateIntToPtr(value, to);
+                    case CastKind::PointerToIntegral:
+                        return irb.CreatePtrToInt(value, to);
+                    case CastKind::PointerToBoolean:
+                    case CastKind::IntegralToBoolean:
+                    case CastKind::FloatingToBoolean:
+                        return irb.CreateZExt(to_bool(value), to);
+                    case CastKind::BooleanToSignedIntegral:
+                        return irb.CreateSExt(to_bool(value), to);
+                    case CastKind::IntegralCast:
+                    case CastKind::IntegralToFloating:
+                    case CastKind::FloatingToIntegral:
+                    case CastKind::FloatingCast:
+                        return convert_scalar(value, from, to, result);
+                    default:
+                        return nullptr;
+                }
+            }
+
+            //
+            // Arithmetic
+            //
+            llvm::Value *unary(mlir::Operation *op, llvm::Value *arg)
+            {
+                if (!arg)
+                    return nullptr;
+
+                auto floating = arg->getType()->isFloatingPointTy();
+                return llvm::TypeSwitch< mlir::Operation *, llvm::Value * >(op)
+                    .Case([&] (PlusOp) { return arg; })
+                    .Case([&] (MinusOp) { return floating ? irb.CreateFNeg(arg) : irb.CreateNeg(arg); })
+                    .Case([&] (NotOp) { return irb.CreateNot(arg); })
+                    .Case([&] (LNotOp) {
+                        auto type = convert(op->getResult(0).getType());
+                        return irb.CreateZExt(irb.CreateNot(to_bool(arg)), type);
+                    })
+                    .Default([] (auto) -> llvm::Value * { return nullptr; });
+            }
+
+            // Pointer arithmetic scales the integer operand by the size of the
+            // pointee, difference of pointers is the number of elements between
+            // them.
+            llvm::Value *pointer_arith(arith_kind kind, llvm::Value *lhs, llvm::Value *rhs,
+                                       mlir::Type lhs_type, mlir::Type rhs_type,
+                                       mlir::Type result_type)
+            {
+                if (lhs->getType()->isPointerTy() && rhs->getType()->isPointerTy()) {
+                    auto element = unit.pointee(lhs_type);
+                    auto type = convert(result_type);
+                    if (kind != arith_kind::sub || !element || !type)
+                        return nullptr;
+                    auto diff = irb.CreatePtrDiff(element, cast_pointer(lhs, element),
+                                                  cast_pointer(rhs, element));
+                    return irb.CreateIntCast(diff, type, true);
+                }
+
+                if (rhs->getType()->isPointerTy()) {
+                    std::swap(lhs, rhs);
+                    std::swap(lhs_type, rhs_type);
+                }
+
+                auto element = unit.pointee(lhs_type);
+                if ((kind != arith_kind::add && kind != arith_kind::sub) || !element)
+                    return nullptr;
+
+                auto idx = irb.CreateIntCast(rhs, irb.getInt64Ty(), unit.is_signed(rhs_type));
+                if (kind == arith_kind::sub)
+                    idx = irb.CreateNeg(idx);
+                return irb.CreateInBoundsGEP(element, cast_pointer(lhs, element), idx);
+            }
+
+            llvm::Value *arith(arith_kind kind, llvm::Value *lhs, llvm::Value *rhs,
+                               mlir::Type lhs_type, mlir::Type rhs_type, mlir::Type result_type)
+            {
+                if (!lhs || !rhs)
+                    return nullptr;
+
+                if (lhs->getType()->isPointerTy() || rhs->getType()->isPointerTy())
+                    return pointer_arith(kind, lhs, rhs, lhs_type, rhs_type, result_type);
+
+                if (lhs->getType()->isFloatingPointTy()) {
+                    switch (kind) {
+                        case arith_kind::add: return irb.CreateFAdd(lhs, rhs);
+                        case arith_kind::sub: return irb.CreateFSub(lhs, rhs);
+                        case arith_kind::mul: return irb.CreateFMul(lhs, rhs);
+                        case arith_kind::sdiv:
+                        case arith_kind::udiv:
+                        case arith_kind::fdiv: return irb.CreateFDiv(lhs, rhs);
+                        case arith_kind::srem:
+                        case arith_kind::urem:
+                        case arith_kind::frem: return irb.CreateFRem(lhs, rhs);
+                        default: return nullptr;
+                    }
+                }
+
+                auto is_signed = unit.is_signed(lhs_type);
+                switch (kind) {
+                    case arith_kind::add: return irb.CreateAdd(lhs, rhs);
+                    case arith_kind::sub: return irb.CreateSub(lhs, rhs);
+                    case arith_kind::mul: return irb.CreateMul(lhs, rhs);
+                    case arith_kind::sdiv: return irb.CreateSDiv(lhs, rhs);
+                    case arith_kind::udiv: return irb.CreateUDiv(lhs, rhs);
+                    case arith_kind::fdiv:
+                        return is_signed ? irb.CreateSDiv(lhs, rhs) : irb.CreateUDiv(lhs, rhs);
+                    case arith_kind::srem: return irb.CreateSRem(lhs, rhs);
+                    case arith_kind::urem: return irb.CreateURem(lhs, rhs);
+                    case arith_kind::frem:
+                        return is_signed ? irb.CreateSRem(lhs, rhs) : irb.CreateURem(lhs, rhs);
+                    case arith_kind::band: return irb.CreateAnd(lhs, rhs);
+                    case arith_kind::bor: return irb.CreateOr(lhs, rhs);
+                    case arith_kind::bxor: return irb.CreateXor(lhs, rhs);
+                    case arith_kind::shl:
+                    case arith_kind::shr: {
+                        // Operands of shifts are not converted to a common type.
+                        rhs = irb.CreateIntCast(rhs, lhs->getType(), false);
+                        if (kind == arith_kind::shl)
+                            return irb.CreateShl(lhs, rhs);
+                        return is_signed ? irb.CreateAShr(lhs, rhs) : irb.CreateLShr(lhs, rhs);
+                    }
+                }
+                return nullptr;
+            }
+
+            llvm::Value *binary(mlir::Operation *op, arith_kind kind)
+            {
+                auto lhs = op->getOperand(0);
+                auto rhs = op->getOperand(1);
+                return arith(kind, lookup(lhs), lookup(rhs), lhs.getType(), rhs.getType(),
+                             op->getResult(0).getType());
+            }
+
+            llvm::Value *compare(CmpOp op)
+            {
+                auto lhs = lookup(op.getLhs());
+                auto rhs = lookup(op.getRhs());
+                auto type = convert(op.getType());
+                if (!lhs || !rhs || !type)
+                    return nullptr;
+
+                if (lhs->getType()->isPointerTy())
+                    rhs = irb.CreatePointerCast(rhs, lhs->getType());
+
+                auto predicate = [&] () -> std::optional< llvm::CmpInst::Predicate > {
+                    auto floating = lhs->getType()->isFloatingPointTy();
+                    switch (op.getPredicate()) {
+                        case Predicate::eq:
+                            return floating ? llvm::CmpInst::FCMP_OEQ : llvm::CmpInst::ICMP_EQ;
+                        case Predicate::ne:
+                            return floating ? llvm::CmpInst::FCMP_UNE : llvm::CmpInst::ICMP_NE;
+                        case Predicate::slt:
+                            return floating ? llvm::CmpInst::FCMP_OLT : llvm::CmpInst::ICMP_SLT;
+                        case Predicate::sle:
+                            return floating ? llvm::CmpInst::FCMP_OLE : llvm::CmpInst::ICMP_SLE;
+                        case Predicate::sgt:
+                            return floating ? llvm::CmpInst::FCMP_OGT : llvm::CmpInst::ICMP_SGT;
+                        case Predicate::sge:
+                            return floating ? llvm::CmpInst::FCMP_OGE : llvm::CmpInst::ICMP_SGE;
+                        case Predicate::ult: return llvm::CmpInst::ICMP_ULT;
+                        case Predicate::ule: return llvm::CmpInst::ICMP_ULE;
+                        case Predicate::ugt: return llvm::CmpInst::ICMP_UGT;
+                        case Predicate::uge: return llvm::CmpInst::ICMP_UGE;
+                    }
+                    return std::nullopt;
+                } ();
+
+                if (!predicate)
+                    return nullptr;
+                return irb.CreateZExt(irb.CreateCmp(*predicate, lhs, rhs), type);
+            }
+
+            //
+            // Lvalues
+            //
+            llvm::Value *subscript(SubscriptOp op)
+            {
+                auto base = lookup(op.getArray());
+                auto idx = lookup(op.getIndex());
+                auto element = convert(value_type(op.getType()));
+                if (!base || !idx || !element)
+                    return nullptr;
+
+                idx = irb.CreateIntCast(idx, irb.getInt64Ty(), unit.is_signed(op.getIndex().getType()));
+                return irb.CreateInBoundsGEP(element, cast_pointer(base, element), idx);
+            }
+
+            // Members of unions share the address of the union.
+            llvm::Value *record_member(RecordMemberOp op)
+            {
+                auto base = lookup(op.getRecord());
+                auto decl = unit.record_decl(op.getRecord().getType());
+                if (!base || !decl)
+                    return nullptr;
+
+                auto idx = unit.field_index(decl, op.getName());
+                auto type = convert(value_type(op.getRecord().getType()));
+                auto element = convert(value_type(op.getType()));
+                if (!idx || !type || !element)
+                    return nullptr;
+
+                if (mlir::isa< UnionDeclOp >(decl))
+                    return cast_pointer(base, element);
+                return irb.CreateStructGEP(type, cast_pointer(base, type), *idx);
+            }
+
+            llvm::Value *emit_assign(AssignOp op)
+            {
+                auto value = lookup(op.getSrc());
+                auto addr = lookup(op.getDst());
+                if (!fn || !value || !addr)
+                    return nullptr;
+                store(value, addr, unit.is_volatile(op.getDst().getType()));
+                return value;
+            }
+
+            // The operation is computed in the type of the source operand and
+            // its result converted back to the type of the destination.
+            llvm::Value *compound_assign(mlir::Operation *op, arith_kind kind)
+            {
+                auto src = op->getOperand(0);
+                auto dst = op->getOperand(1);
+                auto dst_type = value_type(dst.getType());
+
+                auto type = convert(dst_type);
+                auto addr = lookup(dst);
+                auto is_volatile = unit.is_volatile(dst.getType());
+                auto current = load(type, addr, is_volatile);
+                auto value = lookup(src);
+                if (!current || !value)
+                    return nullptr;
+
+                llvm::Value *result = nullptr;
+                if (type->isPointerTy() || kind == arith_kind::shl || kind == arith_kind::shr) {
+                    result = arith(kind, current, value, dst_type, src.getType(), dst_type);
+                } else if (auto lhs = convert_scalar(current, dst_type, value->getType(), src.getType())) {
+                    auto computed = arith(kind, lhs, value, src.getType(), src.getType(), src.getType());
+                    if (computed)
+                        result = convert_scalar(computed, src.getType(), type, dst_type);
+                }
+
+                if (!result)
+                    return nullptr;
+                store(result, addr, is_volatile);
+                return result;
+            }
+
+            llvm::Value *inc_dec(mlir::Operation *op)
+            {
+                auto arg = op->getOperand(0);
+                auto arg_type = value_type(arg.getType());
+                auto type = convert(arg_type);
+                auto addr = lookup(arg);
+                auto is_volatile = unit.is_volatile(arg.getType());
+                auto old = load(type, addr, is_volatile);
+                if (!old)
+                    return nullptr;
+
+                auto inc = mlir::isa< PreIncOp, PostIncOp >(op);
+                llvm::Value *updated = nullptr;
+                if (type->isPointerTy()) {
+                    auto element = unit.pointee(arg_type);
+                    updated = irb.CreateInBoundsGEP(element, cast_pointer(old, element),
+                                                    irb.getInt64(inc ? 1 : -1));
+                } else if (type->isFloatingPointTy()) {
+                    updated = irb.CreateFAdd(old, llvm::ConstantFP::get(type, inc ? 1.0 : -1.0));
+                } else {
+                    auto one = llvm::ConstantInt::get(type, 1);
+                    updated = inc ? irb.CreateAdd(old, one) : irb.CreateSub(old, one);
+                }
+
+                store(updated, addr, is_volatile);
+                return mlir::isa< PostIncOp, PostDecOp >(op) ? old : updated;
+            }
+
+            // Calls through a prototype that does not match the arguments,
+            // e.g., of functions declared without parameters, are made
+            // through the type of the passed arguments.
+            llvm::Value *emit_call(llvm::FunctionType *type, llvm::Value *callee,
+                                   mlir::ValueRange operands)
+            {
+                if (!fn || !type || !callee)
+                    return nullptr;
+
+                llvm::SmallVector< llvm::Value * > args;
+                for (auto operand : operands) {
+                    auto arg = lookup(operand);
+                    if (!arg)
+                        return nullptr;
+                    args.push_back(arg);
+                }
+
+                auto matches = type->getNumParams() == args.size();
+                for (unsigned i = 0; matches && i < args.size(); ++i) {
+                    auto param = type->getParamType(i);
+                    if (args[i]->getType() == param)
+                        continue;
+                    if (args[i]->getType()->isPointerTy() && param->isPointerTy())
+                        args[i] = irb.CreatePointerCast(args[i], param);
+                    else
+                        matches = false;
+                }
+
+                if (!matches) {
+                    llvm::SmallVector< llvm::Type * > params;
+                    for (auto arg : args)
+                        params.push_back(arg->getType());
+                    type = llvm::FunctionType::get(type->getReturnType(), params, false);
+                }
+
+                return irb.CreateCall(type, cast_pointer(callee, type), args);
+            }
+
+            //
+            // Variables
+            //
+            mlir::LogicalResult emit_var(VarDeclOp var)
+            {
+                // Static and extern locals are globals, the former named after
+                // their function the same way clang does.
+                auto sc = var.getStorageClass();
+                if (sc && *sc == StorageClass::sc_static) {
+                    auto name = (fn->getName() + "." + var.getName()).str();
+                    return bind(var, unit.define_global(var, name));
+                }
+                if (sc && *sc == StorageClass::sc_extern)
+                    return bind(var, unit.define_global(var, var.getName()));
+
+                auto type = convert(value_type(var.getType()));
+                if (!type)
+                    return var.emitError("unsupported type of variable");
+
+                llvm::Value *addr = nullptr;
+                auto &size = var.getAllocationSize();
+                if (!size.empty()) {
+                    // Variable length arrays are allocated where declared.
+                    if (mlir::failed(emit(size)))
+                        return mlir::failure();
+                    auto count = lookup(yield_of(size));
+                    if (!count || !type->isArrayTy())
+                        return var.emitError("unsupported variable length array");
+                    addr = irb.CreateAlloca(type->getArrayElementType(), count, var.getName());
+                } else {
+                    auto alloca = make_alloca(type, var.getName());
+                    if (auto aligned = var->getAttrOfType< AlignedAttr >(AlignedAttr::getMnemonic()))
+                        alloca->setAlignment(llvm::Align(aligned.getAlignment()));
+                    addr = alloca;
+                }
+
+                values[var.getResult()] = addr;
+
+                auto &init = var.getInitializer();
+                if (init.empty())
+                    return mlir::success();
+                if (mlir::failed(emit(init)))
+                    return mlir::failure();
+                return initialize(addr, type, yield_of(init), unit.is_volatile(var.getType()));
+            }
+
+            // Initializer lists are stored element by element, elements they
+            // do not cover are zeroed beforehand.
+            mlir::LogicalResult initialize(llvm::Value *addr, llvm::Type *type,
+                                           mlir::Value init, bool is_volatile)
+            {
+                if (!init)
+                    return mlir::failure();
+
+                if (auto list = init.getDefiningOp< InitListExpr >()) {
+                    auto elements = list.getElements();
+                    if (!type->isAggregateType()) {
+                        if (elements.size() != 1)
+                            return list.emitError("unexpected initializer of scalar");
+                        return initialize(addr, type, elements[0], is_volatile);
+                    }
+
+                    if (unit.is_union(list->getResult(0).getType()))
+                        return list.emitError("unsupported initializer of union");
+
+                    auto count = type->isArrayTy() ? type->getArrayNumElements()
+                                                   : type->getStructNumElements();
+                    if (elements.size() < count)
+                        store(llvm::Constant::getNullValue(type), addr, is_volatile);
+
+                    auto base = cast_pointer(addr, type);
+                    for (unsigned idx = 0; idx < elements.size(); ++idx) {
+                        auto element = type->isArrayTy()
+                            ? irb.CreateConstInBoundsGEP2_32(type, base, 0, idx)
+                            : irb.CreateStructGEP(type, base, idx);
+                        auto element_type = type->isArrayTy() ? type->getArrayElementType()
+                                                              : type->getStructElementType(idx);
+                        if (mlir::failed(initialize(element, element_type, elements[idx], is_volatile)))
+                            return mlir::failure();
+                    }
+                    return mlir::success();
+                }
+
+                auto value = lookup(init);
+                if (!value)
+                    return mlir::failure();
+
+                // Character arrays are initialized by a copy of the string literal.
+                auto init_type = unit.resolve(value_type(init.getType()));
+                if (type->isArrayTy() && init_type.isa< ArrayType >()) {
+                    auto &layout = unit.target_layout();
+                    auto source = convert(init_type);
+                    auto bytes = std::min(uint64_t(layout.getTypeAllocSize(type)),
+                                          uint64_t(layout.getTypeAllocSize(source)));
+                    if (bytes < layout.getTypeAllocSize(type))
+                        store(llvm::Constant::getNullValue(type), addr, is_volatile);
+                    irb.CreateMemCpy(addr, llvm::MaybeAlign(), value, llvm::MaybeAlign(),
+                                     bytes, is_volatile);
+                    return mlir::success();
+                }
+
+                if (value->getType() != type && value->getType()->isPointerTy() && type->isPointerTy())
+                    value = irb.CreatePointerCast(value, type);
+                store(value, addr, is_volatile);
+                return mlir::success();
+            }
+
+            // Constant initializer of a global, its operations are folded by
+            // the builder as it has no insertion point.
+            llvm::Constant *constant_initializer(llvm::Type *type, mlir::Value init)
+            {
+                if (!init)
+                    return nullptr;
+
+                if (auto list = init.getDefiningOp< InitListExpr >()) {
+                    auto elements = list.getElements();
+                    if (!type->isAggregateType())
+                        return elements.size() == 1 ? constant_initializer(type, elements[0]) : nullptr;
+                    if (unit.is_union(list->getResult(0).getType())) {
+                        list.emitError("unsupported initializer of union");
+                        return nullptr;
+                    }
+
+                    llvm::SmallVector< llvm::Constant * > members;
+                    for (unsigned idx = 0; idx < elements.size(); ++idx) {
+                        auto element_type = type->isArrayTy() ? type->getArrayElementType()
+                                                              : type->getStructElementType(idx);
+                        auto member = constant_initializer(element_type, elements[idx]);
+                        if (!member)
+                            return nullptr;
+                        members.push_back(member);
+                    }
+
+                    if (auto arr = llvm::dyn_cast< llvm::ArrayType >(type)) {
+                        members.resize(arr->getNumElements(),
+                                       llvm::Constant::getNullValue(arr->getElementType()));
+                        return llvm::ConstantArray::get(arr, members);
+                    }
+
+                    auto record = llvm::cast< llvm::StructType >(type);
+                    for (auto idx = members.size(); idx < record->getNumElements(); ++idx)
+                        members.push_back(llvm::Constant::getNullValue(record->getElementType(idx)));
+                    return llvm::ConstantStruct::get(record, members);
+                }
+
+                auto value = llvm::dyn_cast_or_null< llvm::Constant >(lookup(init));
+                if (!value) {
+                    mlir::emitError(init.getLoc(), "expected constant initializer");
+                    return nullptr;
+                }
+
+                // Character arrays are initialized by the string literal itself.
+                if (auto arr = llvm::dyn_cast< llvm::ArrayType >(type)) {
+                    auto literal = llvm::dyn_cast< llvm::GlobalVariable >(value);
+                    auto data = literal ? llvm::dyn_cast_or_null< llvm::ConstantDataSequential >(
+                        literal->getInitializer()
+                    ) : nullptr;
+                    if (!data || !arr->getElementType()->isIntegerTy(8))
+                        return nullptr;
+                    return unit.string_literal(data->getRawDataValues(), arr)->getInitializer();
+                }
+
+                if (value->getType() != type && value->getType()->isPointerTy() && type->isPointerTy())
+                    return llvm::ConstantExpr::getPointerCast(value, type);
+                return value;
+            }
+
+            //
+            // Control flow
+            //
+            mlir::LogicalResult emit_if(IfOp op)
+            {
+                auto cond = emit_condition(op.getCondRegion());
+                if (!cond)
+                    return mlir::failure();
+
+                auto then_bb = block("if.then");
+                auto end_bb = block("if.end");
+                auto else_bb = op.hasElse() ? block("if.else") : end_bb;
+                irb.CreateCondBr(cond, then_bb, else_bb, branch_weights(op));
+
+                start(then_bb);
+                if (mlir::failed(emit(op.getThenRegion())))
+                    return mlir::failure();
+                branch(end_bb);
+
+                if (op.hasElse()) {
+                    start(else_bb);
+                    if (mlir::failed(emit(op.getElseRegion())))
+                        return mlir::failure();
+                    branch(end_bb);
+                }
+
+                start(end_bb);
+                return mlir::success();
+            }
+
+            mlir::LogicalResult emit_while(WhileOp op)
+            {
+                auto cond_bb = block("while.cond");
+                auto body_bb = block("while.body");
+                auto end_bb = block("while.end");
+
+                fall_through(cond_bb);
+                auto cond = emit_condition(op.getCondRegion());
+                if (!cond)
+                    return mlir::failure();
+                irb.CreateCondBr(cond, body_bb, end_bb, branch_weights(op));
+
+                targets[op] = { end_bb, cond_bb };
+                start(body_bb);
+                if (mlir::failed(emit(op.getBodyRegion())))
+                    return mlir::failure();
+                attach_loop_hints(op, branch(cond_bb));
+
+                start(end_bb);
+                return mlir::success();
+            }
+
+            mlir::LogicalResult emit_for(ForOp op)
+            {
+                auto cond_bb = block("for.cond");
+                auto body_bb = block("for.body");
+                auto inc_bb = block("for.inc");
+                auto end_bb = block("for.end");
+
+                fall_through(cond_bb);
+                auto cond = emit_condition(op.getCondRegion());
+                if (!cond)
+                    return mlir::failure();
+                irb.CreateCondBr(cond, body_bb, end_bb, branch_weights(op));
+
+                targets[op] = { end_bb, inc_bb };
+                start(body_bb);
+                if (mlir::failed(emit(op.getBodyRegion())))
+                    return mlir::failure();
+
+                fall_through(inc_bb);
+                if (mlir::failed(emit(op.getIncrRegion())))
+                    return mlir::failure();
+                attach_loop_hints(op, branch(cond_bb));
+
+                start(end_bb);
+                return mlir::success();
+            }
+
+            mlir::LogicalResult emit_do(DoOp op)
+            {
+                auto body_bb = block("do.body");
+                auto cond_bb = block("do.cond");
+                auto end_bb = block("do.end");
+
+                targets[op] = { end_bb, cond_bb };
+                fall_through(body_bb);
+                if (mlir::failed(emit(op.getBodyRegion())))
+                    return mlir::failure();
+
+                fall_through(cond_bb);
+                auto cond = emit_condition(op.getCondRegion());
+                if (!cond)
+                    return mlir::failure();
+                attach_loop_hints(op, irb.CreateCondBr(cond, body_bb, end_bb, branch_weights(op)));
+
+                start(end_bb);
+                return mlir::success();
+            }
+
+            // Blocks of cases are created upfront, so that the switch
+            // instruction can refer to them. Cases of nested switches belong
+            // to those.
+            void collect_cases(mlir::Region &region, llvm::SmallVectorImpl< mlir::Operation * > &result)
+            {
+                for (auto &block : region)
+                    for (auto &op : block) {
+                        if (mlir::isa< SwitchOp >(op))
+                            continue;
+                        if (mlir::isa< CaseOp, DefaultOp >(op))
+                            result.push_back(&op);
+                        for (auto &nested : op.getRegions())
+                            collect_cases(nested, result);
+                    }
+            }
+
+            mlir::LogicalResult emit_switch(SwitchOp op)
+            {
+                if (mlir::failed(emit(op.getCondRegion())))
+                    return mlir::failure();
+                auto cond = lookup(yield_of(op.getCondRegion()));
+                if (!cond || !cond->getType()->isIntegerTy())
+                    return op.emitError("unsupported condition of switch");
+
+                llvm::SmallVector< mlir::Operation * > labels_of_cases;
+                for (auto &region : op.getCases())
+                    collect_cases(region, labels_of_cases);
+
+                auto end_bb = block("sw.epilog");
+                auto default_bb = end_bb;
+                for (auto label : labels_of_cases) {
+                    auto is_default = mlir::isa< DefaultOp >(label);
+                    auto bb = block(is_default ? "sw.default" : "sw.bb");
+                    cases[label] = bb;
+                    if (is_default)
+                        default_bb = bb;
+                }
+
+                auto width = cond->getType()->getIntegerBitWidth();
+                auto sw = irb.CreateSwitch(cond, default_bb, unsigned(labels_of_cases.size()));
+                for (auto label : labels_of_cases) {
+                    auto stmt = mlir::dyn_cast< CaseOp >(label);
+                    if (!stmt)
+                        continue;
+                    auto value = case_value(stmt, width);
+                    if (!value)
+                        return stmt.emitError("non-constant case value");
+                    sw->addCase(llvm::ConstantInt::get(lctx, *value), cases.lookup(label));
+                }
+                if (auto weights = branch_weights(op, sw->getNumCases() + 1))
+                    sw->setMetadata(llvm::LLVMContext::MD_prof, weights);
+
+                targets[op] = { end_bb, nullptr };
+                start_unreachable();
+                for (auto &region : op.getCases())
+                    if (mlir::failed(emit(region)))
+                        return mlir::failure();
+
+                fall_through(end_bb);
+                return mlir::success();
+            }
+
+            mlir::LogicalResult emit_jump(mlir::Operation *op)
+            {
+                auto target = targets.find(jump_target(op));
+                if (target == targets.end())
+                    return op->emitError("unknown target of jump");
+
+                auto bb = mlir::isa< BreakOp >(op) ? target->second.exit : target->second.next;
+                if (!bb)
+                    return op->emitError("unknown target of jump");
+
+                branch(bb);
+                start_unreachable();
+                return mlir::success();
+            }
+
+            mlir::LogicalResult emit_return(ReturnOp op)
+            {
+                auto type = fn->getReturnType();
+                auto operands = op.getResult();
+                auto value = operands.empty() ? nullptr : lookup(operands.front());
+
+                if (type->isVoidTy())
+                    irb.CreateRetVoid();
+                else if (!value)
+                    irb.CreateRet(llvm::UndefValue::get(type));
+                else if (value->getType() != type && value->getType()->isPointerTy())
+                    irb.CreateRet(irb.CreatePointerCast(value, type));
+                else
+                    irb.CreateRet(value);
+
+                start_unreachable();
+                return mlir::success();
+            }
+
+            // Reaching the end of a function returns, `main` returns zero.
+            void emit_default_return()
+            {
+                auto type = fn->getReturnType();
+                if (type->isVoidTy())
+                    irb.CreateRetVoid();
+                else if (fn->getName() == "main" && type->isIntegerTy())
+                    irb.CreateRet(llvm::ConstantInt::get(type, 0));
+                else
+                    irb.CreateRet(llvm::UndefValue::get(type));
+            }
+
+            void finalize()
+            {
+                for (auto &bb : *fn)
+                    if (!bb.getTerminator()) {
+                        irb.SetInsertPoint(&bb);
+                        emit_default_return();
+                    }
+
+                llvm::df_iterator_default_set< llvm::BasicBlock * > reachable;
+                for (auto bb : llvm::depth_first_ext(&fn->getEntryBlock(), reachable))
+                    (void) bb;
+
+                llvm::SmallVector< llvm::BasicBlock * > dead;
+                for (auto &bb : *fn)
+                    if (!reachable.count(&bb))
+                        dead.push_back(&bb);
+
+                for (auto bb : dead)
+                    bb->dropAllReferences();
+                for (auto bb : dead)
+                    bb->eraseFromParent();
+            }
+
+            mlir::LogicalResult emit_function(mlir::func::FuncOp op, llvm::Function *lfn)
+            {
+                auto &body = op.getBody();
+                if (!body.hasOneBlock())
+                    return op.emitError("expected structured control flow in translation to llvm ir");
+
+                fn = lfn;
+                start(llvm::BasicBlock::Create(lctx, "entry", fn));
+
+                // Parameters are spilled to stack slots, as they are lvalues.
+                for (auto [arg, param] : llvm::zip(body.getArguments(), fn->args())) {
+                    auto addr = make_alloca(param.getType());
+                    store(&param, addr, false);
+                    values[arg] = addr;
+                }
+
+                if (mlir::failed(emit(body)))
+                    return mlir::failure();
+
+                finalize();
+                return mlir::success();
+            }
+        };
+
+        llvm::GlobalVariable *unit_translator::define_global(VarDeclOp var, llvm::StringRef name)
+        {
+            auto type = convert(value_type(var.getType()));
+            if (!type) {
+                var.emitError("unsupported type of variable");
+                return nullptr;
+            }
+
+            // Extern declarations have no initializer at all.
+            auto sc = var.getStorageClass();
+            auto &init = var.getInitializer();
+            if (sc && *sc == StorageClass::sc_extern && init.empty())
+                return global(name, type, false);
+
+            auto gv = global(name, type, true);
+            if (sc && *sc == StorageClass::sc_static)
+                gv->setLinkage(llvm::GlobalValue::InternalLinkage);
+            gv->setConstant(var->hasAttr(const_attr_name));
+
+            if (!init.empty()) {
+                emitter constant(*this);
+                if (mlir::failed(constant.emit(init)))
+                    return nullptr;
+                auto value = constant.constant_initializer(type, emitter::yield_of(init));
+                if (!value)
+                    return nullptr;
+                gv->setInitializer(value);
+            } else if (!gv->hasInitializer()) {
+                // Tentative definitions are zero initialized.
+                gv->setInitializer(llvm::Constant::getNullValue(type));
+            }
+
+            if (auto section = var->getAttrOfType< SectionAttr >(SectionAttr::getMnemonic()))
+                gv->setSection(section.getName().getValue());
+            if (auto aligned = var->getAttrOfType< AlignedAttr >(AlignedAttr::getMnemonic()))
+                gv->setAlignment(llvm::Align(aligned.getAlignment()));
+            return gv;
+        }
+
+        mlir::LogicalResult unit_translator::define_function(mlir::func::FuncOp op)
+        {
+            auto fn = declare(op, !op.isDeclaration());
+            if (!fn)
+                return op.emitError("unsupported type of function");
+            if (op.isDeclaration())
+                return mlir::success();
+            if (!fn->empty())
+                return op.emitError("redefinition of function");
+
+            if (auto count = op->getAttrOfType< mlir::IntegerAttr >(entry_count_attr_name))
+                fn->setEntryCount(uint64_t(count.getInt()));
+
+            emitter body(*this);
+            return body.emit_function(op, fn);
+        }
+
+        mlir::LogicalResult unit_translator::translate(mlir::Operation *op)
+        {
+            return llvm::TypeSwitch< mlir::Operation *, mlir::LogicalResult >(op)
+                .Case([&] (TranslationUnitOp unit) {
+                    for (auto &block : unit.getBody())
+                        for (auto &nested : block)
+                            if (mlir::failed(translate(&nested)))
+                                return mlir::failure();
+                    return mlir::success();
+                })
+                .Case([&] (mlir::func::FuncOp fn) { return define_function(fn); })
+                .Case([&] (VarDeclOp var) {
+                    return mlir::success(define_global(var, var.getName()) != nullptr);
+                })
+                .Case< TypeDefOp, TypeDeclOp, StructDeclOp, UnionDeclOp, EnumDeclOp >([] (auto) {
+                    return mlir::success();
+                })
+                .Default([] (mlir::Operation *unknown) {
+                    return unknown->emitError("unsupported operation in translation to llvm ir");
+                });
+        }
+
+    } // namespace
+
+    mlir::LogicalResult translate_to_llvm_ir(mlir::Operation *op,
+                                             mlir::LLVM::ModuleTranslation &state)
+    {
+        auto mod = op->getParentOfType< mlir::ModuleOp >();
+        if (!mod)
+            return op->emitError("expected operation nested in module");
+
+        unit_translator unit(mod, *state.getLLVMModule());
+        return unit.translate(op);
+    }
+
+    mlir::LogicalResult translate_to_llvm_ir(mlir::ModuleOp mod, llvm::Module &lmod)
+    {
+        unit_translator unit(mod, lmod);
+        for (auto &op : *mod.getBody())
+            if (mlir::failed(unit.translate(&op)))
+                return mlir::failure();
+        return mlir::success();
+    }
+
+} // namespace vast::hl
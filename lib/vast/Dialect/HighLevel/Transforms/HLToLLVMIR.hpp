@@ -0,0 +1,30 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/BuiltinAttributes.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/IR/Operation.h>
+#include <mlir/Target/LLVMIR/ModuleTranslation.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::hl
+{
+    // Builds the distinct `llvm.loop` metadata of `hl.loop_hints`.
+    llvm::MDNode *make_loop_id(llvm::LLVMContext &lctx, mlir::DictionaryAttr hints);
+
+    // Translates `hl.translation_unit` of high-level operations into the llvm
+    // module of `state` without any intermediate dialect.
+    mlir::LogicalResult translate_to_llvm_ir(mlir::Operation *op,
+                                             mlir::LLVM::ModuleTranslation &state);
+
+    // Translates a module of high-level operations, as emitted by vast-cc,
+    // into `lmod` without any intermediate dialect.
+    mlir::LogicalResult translate_to_llvm_ir(mlir::ModuleOp mod, llvm::Module &lmod);
+
+} // namespace vast::hl
@@ -5,6 +5,7 @@
 VAST_RELAX_WARNINGS
 #include <mlir/Analysis/DataLayoutAnalysis.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Conversion/LLVMCommon/Pattern.h>
 #include <mlir/Conversion/LLVMCommon/TypeConverter.h>
@@ -47,6 +48,15 @@ namespace vast::hl
         return mlir::dyn_cast< T >(*std::prev(mlir::Block::iterator(src)));
     }
 
+    // Branch weights and loop hints are kept as discardable attributes of the
+    // structured operations.
+    void forward_hints(mlir::Operation *from, mlir::Operation *to)
+    {
+        for (auto name : { loop_hints_attr_name, branch_weights_attr_name })
+            if (auto attr = from->getAttr(name))
+                to->setAttr(name, attr);
+    }
+
     namespace pattern
     {
         auto coerce_condition(auto op, mlir::ConversionPatternRewriter &rewriter)
@@ -191,6 +201,7 @@ namespace vast::hl
                 mlir::scf::IfOp scf_if_op = rewriter.create< mlir::scf::IfOp >(
                         op.getLoc(), std::vector< mlir::Type >{}, *coerced,
                         op.hasElse());
+                forward_hints(op, scf_if_op);
                 auto then_result = make_if_block(op.getThenRegion(), scf_if_op.getThenRegion());
                 auto else_result = [&]()
                 {
@@ -258,6 +269,7 @@ namespace vast::hl
                         op.getLoc(),
                         std::vector< mlir::Type >{},
                         std::vector< mlir::Value >{});
+                forward_hints(op, scf_while_op);
                 auto &before = do_inline(op.getCondRegion(), scf_while_op.getBefore());
                 auto &after = do_inline(op.getBodyRegion(), scf_while_op.getAfter());
 
@@ -311,6 +323,252 @@ namespace vast::hl
     } // namespace pattern
 
 
+    //
+    // Switch lowering
+    //
+    // `hl.switch` is lowered into a control flow graph inside of
+    // `scf.execute_region`, where a single `cf.switch` dispatches to the blocks
+    // of its cases. Statements of the switch body are split into segments,
+    // each starting at a case label; a segment falls through into the next
+    // one, `hl.break` branches to the exit block.
+    //
+    namespace
+    {
+        // Case value or `std::nullopt` for the default label.
+        using switch_label = std::optional< llvm::APInt >;
+
+        struct switch_segment
+        {
+            llvm::SmallVector< switch_label > labels;
+            llvm::SmallVector< mlir::Operation * > ops;
+        };
+
+        struct switch_lowering
+        {
+            hl::SwitchOp op;
+            unsigned width;
+
+            // The first segment precedes all labels and is never executed.
+            std::vector< switch_segment > segments = { switch_segment{} };
+
+            mlir::LogicalResult flatten(mlir::Region &region)
+            {
+                for (auto &block : region)
+                    for (auto &nested : block)
+                        if (mlir::failed(flatten(&nested)))
+                            return mlir::failure();
+                return mlir::success();
+            }
+
+            mlir::LogicalResult flatten(mlir::Operation *nested)
+            {
+                if (auto case_op = mlir::dyn_cast< hl::CaseOp >(nested)) {
+                    auto value = hl::case_value(case_op, width);
+                    if (!value)
+                        return mlir::failure();
+                    label(*value);
+                    return flatten(case_op.getBody());
+                }
+
+                if (auto default_op = mlir::dyn_cast< hl::DefaultOp >(nested)) {
+                    label(std::nullopt);
+                    return flatten(default_op.getBody());
+                }
+
+                // Scopes are dissolved, so that labels and breaks nested in
+                // compound statements end up in the switch body.
+                if (auto scope = mlir::dyn_cast< hl::ScopeOp >(nested))
+                    return flatten(scope.getBody());
+
+                if (mlir::isa< hl::BreakOp >(nested)) {
+                    segments.back().ops.push_back(nested);
+                    return mlir::success();
+                }
+
+                if (mlir::isa< hl::ContinueOp >(nested) || has_unstructured_jumps(nested))
+                    return mlir::failure();
+
+                segments.back().ops.push_back(nested);
+                return mlir::success();
+            }
+
+            void label(switch_label value)
+            {
+                auto &last = segments.back();
+                if (last.labels.empty() || !last.ops.empty())
+                    segments.emplace_back();
+                segments.back().labels.push_back(value);
+            }
+
+            // Labels and jumps nested in other statements (e.g., `break` from
+            // `if`) cannot be expressed by structured control flow.
+            bool has_unstructured_jumps(mlir::Operation *nested) const
+            {
+                auto result = nested->walk([&] (mlir::Operation *inner) {
+                    if (mlir::isa< hl::CaseOp, hl::DefaultOp >(inner)
+                        && inner->getParentOfType< hl::SwitchOp >() == op
+                    ) {
+                        return mlir::WalkResult::interrupt();
+                    }
+
+                    if (mlir::isa< hl::BreakOp, hl::ContinueOp >(inner)) {
+                        auto target = hl::jump_target(inner);
+                        if (!target || !nested->isAncestor(target))
+                            return mlir::WalkResult::interrupt();
+                    }
+
+                    return mlir::WalkResult::advance();
+                });
+
+                return result.wasInterrupted();
+            }
+
+            // Values cannot be used across segments, as a segment is entered
+            // directly from the dispatch.
+            bool is_segment_local() const
+            {
+                llvm::DenseMap< mlir::Operation *, std::size_t > segment_of;
+                for (std::size_t i = 0; i < segments.size(); ++i)
+                    for (auto seg_op : segments[i].ops)
+                        segment_of[seg_op] = i;
+
+                auto top_level = [&] (mlir::Operation *user) -> mlir::Operation * {
+                    for (; user; user = user->getParentOp())
+                        if (segment_of.count(user))
+                            return user;
+                    return nullptr;
+                };
+
+                for (const auto &[seg_op, idx] : segment_of) {
+                    for (auto user : seg_op->getUsers()) {
+                        auto user_op = top_level(user);
+                        if (!user_op || segment_of.lookup(user_op) != idx)
+                            return false;
+                    }
+                }
+
+                return true;
+            }
+
+            mlir::LogicalResult lower(mlir::OpBuilder &bld)
+            {
+                auto loc = op.getLoc();
+                auto &cond_block = op.getCondRegion().front();
+                auto yield = mlir::cast< hl::ValueYieldOp >(cond_block.back());
+
+                // Evaluate condition in front of the switch.
+                auto &ops = op->getBlock()->getOperations();
+                ops.splice(mlir::Block::iterator(op), cond_block.getOperations(),
+                           cond_block.begin(), mlir::Block::iterator(yield));
+
+                bld.setInsertionPoint(op);
+                auto region_op = bld.create< mlir::scf::ExecuteRegionOp >(loc, mlir::TypeRange{});
+                auto &region = region_op.getRegion();
+
+                auto entry = bld.createBlock(&region);
+                std::vector< mlir::Block * > blocks;
+                for (std::size_t i = 1; i < segments.size(); ++i)
+                    blocks.push_back(bld.createBlock(&region, region.end()));
+                auto exit = bld.createBlock(&region, region.end());
+                bld.create< mlir::scf::YieldOp >(loc);
+
+                mlir::Block *default_dest = exit;
+                llvm::SmallVector< llvm::APInt > values;
+                llvm::SmallVector< mlir::Block * > dests;
+
+                for (std::size_t i = 1; i < segments.size(); ++i) {
+                    auto block = blocks[i - 1];
+                    auto next  = i < blocks.size() ? blocks[i] : exit;
+
+                    for (const auto &value : segments[i].labels) {
+                        if (value) {
+                            values.push_back(*value);
+                            dests.push_back(block);
+                        } else {
+                            default_dest = block;
+                        }
+                    }
+
+                    fill(block, segments[i].ops, next, exit, bld);
+                }
+
+                bld.setInsertionPointToEnd(entry);
+                llvm::SmallVector< mlir::ValueRange > operands(values.size(), mlir::ValueRange{});
+                auto sw = bld.create< mlir::cf::SwitchOp >(
+                    loc, yield.getResult(), default_dest, mlir::ValueRange{},
+                    values, dests, operands
+                );
+                forward_hints(op, sw);
+
+                // Remaining unreachable operations are erased together with the
+                // switch.
+                op->erase();
+                return mlir::success();
+            }
+
+            // Moves statements of a segment into the block, up to the first
+            // terminator or break.
+            void fill(
+                mlir::Block *block, llvm::ArrayRef< mlir::Operation * > seg_ops,
+                mlir::Block *next, mlir::Block *exit, mlir::OpBuilder &bld
+            ) {
+                bld.setInsertionPointToEnd(block);
+                for (auto seg_op : seg_ops) {
+                    if (mlir::isa< hl::BreakOp >(seg_op)) {
+                        bld.create< mlir::cf::BranchOp >(seg_op->getLoc(), exit);
+                        return;
+                    }
+
+                    seg_op->moveBefore(block, block->end());
+                    if (seg_op->hasTrait< mlir::OpTrait::IsTerminator >())
+                        return;
+                }
+
+                bld.create< mlir::cf::BranchOp >(op.getLoc(), next);
+            }
+        };
+
+        mlir::LogicalResult lower_switch(hl::SwitchOp op)
+        {
+            auto &cond = op.getCondRegion();
+            if (cond.empty() || cond.front().empty())
+                return mlir::failure();
+
+            auto yield = mlir::dyn_cast< hl::ValueYieldOp >(cond.front().back());
+            if (!yield)
+                return mlir::failure();
+
+            auto type = yield.getResult().getType().dyn_cast< mlir::IntegerType >();
+            if (!type)
+                return mlir::failure();
+
+            switch_lowering lowering{ op, type.getWidth() };
+            for (auto &region : op.getCases())
+                if (mlir::failed(lowering.flatten(region)))
+                    return mlir::failure();
+
+            if (!lowering.is_segment_local())
+                return mlir::failure();
+
+            mlir::OpBuilder bld(op);
+            return lowering.lower(bld);
+        }
+
+        // Returns the number of lowered switches.
+        unsigned lower_switches(mlir::Operation *root)
+        {
+            // Inner switches first, the outer ones see them as plain statements.
+            llvm::SmallVector< hl::SwitchOp > switches;
+            root->walk([&] (hl::SwitchOp op) { switches.push_back(op); });
+
+            unsigned lowered = 0;
+            for (auto op : switches)
+                if (mlir::succeeded(lower_switch(op)))
+                    ++lowered;
+            return lowered;
+        }
+    } // namespace
+
     struct HLToSCFPass : HLToSCFBase< HLToSCFPass >
     {
         void runOnOperation() override;
@@ -321,12 +579,20 @@ namespace vast::hl
         auto op = this->getOperation();
         auto &mctx = this->getContext();
 
+        auto switches = lower_switches(op);
+        switches_lowered += switches;
+        op->walk([&] (hl::SwitchOp) { ++switches_kept; });
+
         mlir::ConversionTarget trg(mctx);
         trg.addLegalDialect< mlir::scf::SCFDialect >();
 
         trg.addIllegalOp< hl::IfOp,
-                          hl::WhileOp,
-                          hl::CondYieldOp >();
+                          hl::WhileOp >();
+
+        // Conditions of loops that are not lowered, e.g., `hl.for`, stay.
+        trg.addDynamicallyLegalOp< hl::CondYieldOp >([] (hl::CondYieldOp yield) {
+            return !mlir::isa< hl::IfOp, hl::WhileOp >(yield->getParentOp());
+        });
 
         trg.markUnknownOpDynamicallyLegal([](auto) { return true; });
 
@@ -338,6 +604,12 @@ namespace vast::hl
         auto tc = mlir::LLVMTypeConverter(&mctx, llvm_opts, &dl_analysis);
         patterns.add< pattern::l_ifop,
                       pattern::l_while >(tc);
+
+        op->walk([&] (mlir::Operation *nested) {
+            if (mlir::isa< hl::IfOp, hl::WhileOp >(nested))
+                ++ops_converted;
+        });
+
         if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns))))
             return signalPassFailure();
     }
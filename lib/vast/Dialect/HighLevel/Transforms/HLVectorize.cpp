@@ -0,0 +1,288 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Affine/IR/AffineOps.h>
+#include <mlir/Dialect/Arithmetic/IR/Arithmetic.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/Vector/IR/VectorOps.h>
+#include <mlir/IR/BlockAndValueMapping.h>
+#include <mlir/IR/FunctionInterfaces.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
+#include <llvm/ADT/TypeSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "PassesDetails.hpp"
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+namespace vast::hl
+{
+    namespace
+    {
+        bool is_elementwise(mlir::Operation *op)
+        {
+            return mlir::isa< AddIOp, SubIOp, MulIOp, AddFOp, SubFOp, MulFOp, DivFOp >(op);
+        }
+
+        mlir::Value make_elementwise(
+            mlir::Operation *op, mlir::Value lhs, mlir::Value rhs, mlir::OpBuilder &bld
+        ) {
+            auto loc = op->getLoc();
+            return llvm::TypeSwitch< mlir::Operation *, mlir::Value >(op)
+                .Case([&] (AddIOp) { return bld.create< mlir::arith::AddIOp >(loc, lhs, rhs); })
+                .Case([&] (SubIOp) { return bld.create< mlir::arith::SubIOp >(loc, lhs, rhs); })
+                .Case([&] (MulIOp) { return bld.create< mlir::arith::MulIOp >(loc, lhs, rhs); })
+                .Case([&] (AddFOp) { return bld.create< mlir::arith::AddFOp >(loc, lhs, rhs); })
+                .Case([&] (SubFOp) { return bld.create< mlir::arith::SubFOp >(loc, lhs, rhs); })
+                .Case([&] (MulFOp) { return bld.create< mlir::arith::MulFOp >(loc, lhs, rhs); })
+                .Case([&] (DivFOp) { return bld.create< mlir::arith::DivFOp >(loc, lhs, rhs); })
+                .Default([] (auto) { return mlir::Value(); });
+        }
+
+        enum class access_kind { invariant, unit_stride, other };
+
+        //
+        // Vectorization of innermost affine loops produced from counted
+        // `hl.for` loops. The loop body may consist only of loads, stores,
+        // constants and element-wise arithmetic of scalars of the same width.
+        // Arrays are allocated by distinct `memref.alloca`, hence they do not
+        // alias; a loop-carried dependency can arise only from accesses to
+        // different elements of the same array.
+        //
+        struct loop_vectorizer
+        {
+            mlir::AffineForOp loop;
+            unsigned vector_bits;
+            unsigned lanes = 0;
+            // Leftovers of the affine lowering, e.g., casts of the induction
+            // value used only by replaced subscripts.
+            llvm::SmallPtrSet< mlir::Operation *, 8 > dead;
+
+            mlir::Value iv() { return loop.getInductionVar(); }
+
+            void collect_dead_ops()
+            {
+                auto is_dead = [&] (mlir::Operation *user) { return dead.contains(user); };
+                for (auto &op : llvm::reverse(*loop.getBody()))
+                    if (llvm::all_of(op.getUsers(), is_dead) && mlir::wouldOpBeTriviallyDead(&op))
+                        dead.insert(&op);
+            }
+
+            // Accesses with unit stride in the innermost dimension vary only
+            // in it, with the coefficient of the induction value one.
+            access_kind classify(mlir::AffineMap map, mlir::ValueRange operands)
+            {
+                auto uses = llvm::count(operands, iv());
+                if (uses == 0)
+                    return access_kind::invariant;
+                if (uses != 1 || map.getNumResults() == 0)
+                    return access_kind::other;
+
+                auto pos = unsigned(llvm::find(operands, iv()) - operands.begin());
+                if (pos >= map.getNumDims())
+                    return access_kind::other;
+
+                auto results = map.getResults();
+                for (auto expr : results.drop_back())
+                    if (expr.isFunctionOfDim(pos))
+                        return access_kind::other;
+
+                auto rest = mlir::simplifyAffineExpr(
+                    results.back() - mlir::getAffineDimExpr(pos, map.getContext()),
+                    map.getNumDims(), map.getNumSymbols()
+                );
+                return rest.isFunctionOfDim(pos) ? access_kind::other : access_kind::unit_stride;
+            }
+
+            static bool is_alloca(mlir::Value memref)
+            {
+                return memref.getDefiningOp< mlir::memref::AllocaOp >();
+            }
+
+            static bool same_access(mlir::AffineLoadOp load, mlir::AffineStoreOp store)
+            {
+                return load.getAffineMap() == store.getAffineMap()
+                    && llvm::equal(load.getMapOperands(), store.getMapOperands());
+            }
+
+            mlir::LogicalResult analyze()
+            {
+                if (loop.getStep() != 1 || !loop.hasConstantBounds() || loop.getNumIterOperands() != 0)
+                    return mlir::failure();
+
+                // Dead operations are ignored, the loop is left untouched
+                // unless it is vectorized.
+                collect_dead_ops();
+                auto body = loop.getBody();
+
+                unsigned width = 0;
+                auto element = [&] (mlir::Type type) {
+                    if (!type.isa< mlir::IntegerType, mlir::FloatType >())
+                        return false;
+                    auto bits = type.getIntOrFloatBitWidth();
+                    if (width && width != bits)
+                        return false;
+                    width = bits;
+                    return true;
+                };
+
+                llvm::SmallVector< mlir::AffineLoadOp > loads;
+                llvm::DenseMap< mlir::Value, mlir::AffineStoreOp > stores;
+
+                for (auto &op : body->without_terminator()) {
+                    if (dead.contains(&op))
+                        continue;
+
+                    if (auto load = mlir::dyn_cast< mlir::AffineLoadOp >(op)) {
+                        auto kind = classify(load.getAffineMap(), load.getMapOperands());
+                        if (kind == access_kind::other || !is_alloca(load.getMemRef()))
+                            return mlir::failure();
+                        if (kind == access_kind::unit_stride && !element(load.getType()))
+                            return mlir::failure();
+                        loads.push_back(load);
+                    } else if (auto store = mlir::dyn_cast< mlir::AffineStoreOp >(op)) {
+                        auto kind = classify(store.getAffineMap(), store.getMapOperands());
+                        if (kind != access_kind::unit_stride || !is_alloca(store.getMemRef()))
+                            return mlir::failure();
+                        if (!element(store.getValueToStore().getType()))
+                            return mlir::failure();
+                        if (!stores.try_emplace(store.getMemRef(), store).second)
+                            return mlir::failure();
+                    } else if (is_elementwise(&op)) {
+                        if (!element(op.getResult(0).getType()))
+                            return mlir::failure();
+                    } else if (!mlir::isa< ConstantOp >(op)) {
+                        return mlir::failure();
+                    }
+                }
+
+                // The induction value is used only to address memory.
+                for (auto user : iv().getUsers())
+                    if (!dead.contains(user) && !mlir::isa< mlir::AffineLoadOp, mlir::AffineStoreOp >(user))
+                        return mlir::failure();
+
+                // An iteration may read only the element it writes.
+                for (auto load : loads) {
+                    auto store = stores.lookup(load.getMemRef());
+                    if (store && !same_access(load, store))
+                        return mlir::failure();
+                }
+
+                if (width == 0 || vector_bits % width != 0)
+                    return mlir::failure();
+
+                lanes = vector_bits / width;
+                auto trip = loop.getConstantUpperBound() - loop.getConstantLowerBound();
+                return mlir::success(lanes >= 2 && trip >= int64_t(lanes));
+            }
+
+            // Emits the vector loop in front of the scalar one, which is kept
+            // for the remaining iterations.
+            void vectorize(mlir::OpBuilder &bld)
+            {
+                for (auto &op : llvm::make_early_inc_range(llvm::reverse(*loop.getBody())))
+                    if (dead.contains(&op))
+                        op.erase();
+
+                auto lb = loop.getConstantLowerBound();
+                auto ub = loop.getConstantUpperBound();
+                auto main_ub = lb + (ub - lb) / lanes * lanes;
+
+                bld.setInsertionPoint(loop);
+                auto vloop = bld.create< mlir::AffineForOp >(loop.getLoc(), lb, main_ub, lanes);
+                bld.setInsertionPoint(vloop.getBody()->getTerminator());
+
+                mlir::BlockAndValueMapping scalars;
+                scalars.map(iv(), vloop.getInductionVar());
+                llvm::DenseMap< mlir::Value, mlir::Value > vectors;
+
+                auto vector_type = [&] (mlir::Type type) {
+                    return mlir::VectorType::get({ int64_t(lanes) }, type);
+                };
+
+                // Scalars (constants, invariant loads or values defined out of
+                // the loop) are broadcast.
+                auto vector_of = [&] (mlir::Value value) {
+                    auto &vec = vectors[value];
+                    if (!vec)
+                        vec = bld.create< mlir::vector::BroadcastOp >(
+                            value.getLoc(), vector_type(value.getType()), scalars.lookupOrDefault(value)
+                        );
+                    return vec;
+                };
+
+                auto indices = [&] (mlir::AffineMap map, mlir::ValueRange operands, mlir::Location loc) {
+                    llvm::SmallVector< mlir::Value > mapped;
+                    for (auto operand : operands)
+                        mapped.push_back(scalars.lookupOrDefault(operand));
+
+                    llvm::SmallVector< mlir::Value > result;
+                    for (unsigned i = 0; i < map.getNumResults(); ++i)
+                        result.push_back(bld.create< mlir::AffineApplyOp >(loc, map.getSubMap({ i }), mapped));
+                    return result;
+                };
+
+                for (auto &op : loop.getBody()->without_terminator()) {
+                    auto loc = op.getLoc();
+                    if (auto load = mlir::dyn_cast< mlir::AffineLoadOp >(op)) {
+                        if (classify(load.getAffineMap(), load.getMapOperands()) == access_kind::invariant) {
+                            bld.clone(op, scalars);
+                            continue;
+                        }
+
+                        auto idx = indices(load.getAffineMap(), load.getMapOperands(), loc);
+                        vectors[load.getResult()] = bld.create< mlir::vector::LoadOp >(
+                            loc, vector_type(load.getType()), load.getMemRef(), idx
+                        );
+                    } else if (auto store = mlir::dyn_cast< mlir::AffineStoreOp >(op)) {
+                        auto idx = indices(store.getAffineMap(), store.getMapOperands(), loc);
+                        bld.create< mlir::vector::StoreOp >(
+                            loc, vector_of(store.getValueToStore()), store.getMemRef(), idx
+                        );
+                    } else if (is_elementwise(&op)) {
+                        vectors[op.getResult(0)] = make_elementwise(
+                            &op, vector_of(op.getOperand(0)), vector_of(op.getOperand(1)), bld
+                        );
+                    } else {
+                        bld.clone(op, scalars);
+                    }
+                }
+
+                if (main_ub == ub)
+                    loop->erase();
+                else
+                    loop.setConstantLowerBound(main_ub);
+            }
+        };
+
+    } // namespace
+
+    struct HLVectorizePass : HLVectorizeBase< HLVectorizePass >
+    {
+        void runOnOperation() override
+        {
+            mlir::OpBuilder bld(&getContext());
+
+            llvm::SmallVector< mlir::AffineForOp > loops;
+            getOperation().walk([&] (mlir::AffineForOp loop) { loops.push_back(loop); });
+
+            // Only innermost loops are vectorized, outer loops are rejected
+            // by the analysis as they contain other operations than
+            // arithmetic and memory accesses.
+            for (auto loop : loops) {
+                loop_vectorizer vectorizer{ loop, vector_bits };
+                if (mlir::succeeded(vectorizer.analyze()))
+                    vectorizer.vectorize(bld);
+            }
+        }
+    };
+
+} // namespace vast::hl
+
+
+std::unique_ptr< mlir::Pass > vast::hl::createHLVectorizePass()
+{
+    return std::make_unique< HLVectorizePass >();
+}
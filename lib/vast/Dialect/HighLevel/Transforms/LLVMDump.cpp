@@ -6,6 +6,7 @@ VAST_RELAX_WARNINGS
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Rewrite/PatternApplicator.h>
 
+#include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
 #include <mlir/Conversion/LLVMCommon/TypeConverter.h>
 #include <mlir/Conversion/LLVMCommon/Pattern.h>
@@ -14,8 +15,10 @@ VAST_RELAX_WARNINGS
 #include <mlir/Target/LLVMIR/Export.h>
 #include <mlir/Target/LLVMIR/Dialect/All.h>
 #include <mlir/Target/LLVMIR/LLVMTranslationInterface.h>
+#include <mlir/Target/LLVMIR/ModuleTranslation.h>
 #include <mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h>
 
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Target/TargetMachine.h>
@@ -23,13 +26,96 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 
+#include <vast/Dialect/HighLevel/HighLevelAttributes.hpp>
 #include <vast/Dialect/HighLevel/HighLevelDialect.hpp>
 #include <vast/Dialect/HighLevel/HighLevelOps.hpp>
 
 #include "PassesDetails.hpp"
+#include "HLToLLVMIR.hpp"
 
 namespace vast::hl
 {
+    namespace
+    {
+        // Translates a single hint of `hl.loop_hints` to its `llvm.loop.*`
+        // property, returns null for hints that have no llvm counterpart.
+        llvm::MDNode *make_loop_property(llvm::LLVMContext &lctx, mlir::NamedAttribute hint)
+        {
+            auto state = [&] () -> llvm::StringRef {
+                if (auto str = hint.getValue().dyn_cast< mlir::StringAttr >())
+                    return str.getValue();
+                return {};
+            } ();
+
+            auto property = [&] (llvm::StringRef name, llvm::Constant *value = nullptr) {
+                llvm::SmallVector< llvm::Metadata * > ops = { llvm::MDString::get(lctx, name) };
+                if (value)
+                    ops.push_back(llvm::ConstantAsMetadata::get(value));
+                return llvm::MDNode::get(lctx, ops);
+            };
+
+            auto flag = [&] (bool value) {
+                return llvm::ConstantInt::get(llvm::Type::getInt1Ty(lctx), value);
+            };
+
+            auto count = [&] () -> llvm::Constant * {
+                if (auto value = hint.getValue().dyn_cast< mlir::IntegerAttr >())
+                    return llvm::ConstantInt::get(llvm::Type::getInt32Ty(lctx), value.getInt());
+                return nullptr;
+            };
+
+            auto enabled = state != "disable";
+
+            auto name = hint.getName().getValue();
+            if (name == "unroll")
+                return property(("llvm.loop.unroll." + state).str());
+            if (name == "unroll_count")
+                return property("llvm.loop.unroll.count", count());
+            if (name == "unroll_and_jam")
+                return property(enabled ? "llvm.loop.unroll_and_jam.enable"
+                                        : "llvm.loop.unroll_and_jam.disable");
+            if (name == "unroll_and_jam_count")
+                return property("llvm.loop.unroll_and_jam.count", count());
+            if (name == "vectorize")
+                return property("llvm.loop.vectorize.enable", flag(enabled));
+            if (name == "vectorize_width") {
+                if (auto width = count())
+                    return property("llvm.loop.vectorize.width", width);
+                return property("llvm.loop.vectorize.scalable.enable", flag(state == "scalable"));
+            }
+            if (name == "vectorize_scalable")
+                return property("llvm.loop.vectorize.scalable.enable", flag(true));
+            if (name == "vectorize_predicate")
+                return property("llvm.loop.vectorize.predicate.enable", flag(enabled));
+            if (name == "interleave_count")
+                return property("llvm.loop.interleave.count", count());
+            if (name == "interleave" && !enabled)
+                return property("llvm.loop.interleave.count",
+                                llvm::ConstantInt::get(llvm::Type::getInt32Ty(lctx), 1));
+            if (name == "distribute")
+                return property("llvm.loop.distribute.enable", flag(enabled));
+            if (name == "pipeline" && !enabled)
+                return property("llvm.loop.pipeline.disable", flag(true));
+            if (name == "pipeline_initiation_interval")
+                return property("llvm.loop.pipeline.initiationinterval", count());
+            return nullptr;
+        }
+
+    } // namespace
+
+    llvm::MDNode *make_loop_id(llvm::LLVMContext &lctx, mlir::DictionaryAttr hints)
+    {
+        // The first operand of a loop id refers to itself.
+        llvm::SmallVector< llvm::Metadata * > ops = { nullptr };
+        for (auto hint : hints)
+            if (auto property = make_loop_property(lctx, hint))
+                ops.push_back(property);
+
+        auto loop = llvm::MDNode::getDistinct(lctx, ops);
+        loop->replaceOperandWith(0, loop);
+        return loop;
+    }
+
     class ToLLLVMIR : public mlir::LLVMTranslationDialectInterface
     {
       public:
@@ -39,16 +125,186 @@ namespace vast::hl
         mlir::LogicalResult convertOperation(mlir::Operation *op, llvm::IRBuilderBase &irb,
                                              mlir::LLVM::ModuleTranslation &state) const final
         {
+            // The module translation converts only functions and globals of
+            // the llvm dialect by itself, hence a unit of high-level operations
+            // is translated as a whole.
             return llvm::TypeSwitch< mlir::Operation *, mlir::LogicalResult >(op)
-                .Case([&](hl::TypeDefOp) {
+                .Case([&](hl::TranslationUnitOp) {
+                    return translate_to_llvm_ir(op, state);
+                })
+                .Case< hl::TypeDefOp, hl::TypeDeclOp >([&](auto) {
                     return mlir::success();
                 })
                 .Default([&](mlir::Operation *) {
                     return mlir::failure();
                 });
         }
+
+        mlir::LogicalResult amendOperation(mlir::Operation *op, mlir::NamedAttribute attr,
+                                           mlir::LLVM::ModuleTranslation &state) const final
+        {
+            auto name = attr.getName().getValue();
+            if (name == tbaa_attr_name)
+                return attach_tbaa(op, attr.getValue().dyn_cast< mlir::StringAttr >(), state);
+            if (name == branch_weights_attr_name)
+                return attach_branch_weights(op, attr.getValue().dyn_cast< mlir::ArrayAttr >(), state);
+            if (name == loop_hints_attr_name)
+                return attach_loop_hints(op, attr.getValue().dyn_cast< mlir::DictionaryAttr >(), state);
+            if (name == section_attr_name || name == aligned_attr_name)
+                return apply_placement(op, attr, state);
+            if (name == entry_count_attr_name)
+                return apply_entry_count(op, attr.getValue().dyn_cast< mlir::IntegerAttr >(), state);
+            return mlir::success();
+        }
+
+      private:
+        static llvm::Instruction *lookup_instruction(mlir::Operation *op,
+                                                     mlir::LLVM::ModuleTranslation &state)
+        {
+            if (mlir::isa< mlir::LLVM::LoadOp >(op))
+                return llvm::dyn_cast_or_null< llvm::Instruction >(
+                        state.lookupValue(op->getResult(0)));
+
+            // Stores and branches produce no value to be looked up, but attributes
+            // are amended right after the operation is translated, hence it is the
+            // last instruction of its block.
+            if (mlir::isa< mlir::LLVM::StoreOp, mlir::LLVM::BrOp, mlir::LLVM::CondBrOp,
+                           mlir::LLVM::SwitchOp >(op))
+                if (auto block = state.lookupBlock(op->getBlock()); block && !block->empty())
+                    return &block->back();
+
+            return nullptr;
+        }
+
+        // Scalar type descriptors hang directly under the omnipotent char, the
+        // same way clang builds them. Descriptors are derived from lowered types
+        // and do not match names of clang, hence they live under their own root,
+        // which llvm treats as may-alias with accesses of clang compiled code.
+        // Metadata nodes are uniqued by the context, so repeated requests for
+        // the same type yield the same node.
+        static llvm::MDNode *make_tbaa_tag(llvm::LLVMContext &lctx, llvm::StringRef name)
+        {
+            llvm::MDBuilder mdb(lctx);
+            auto root = mdb.createTBAARoot("VAST C TBAA");
+            auto type = mdb.createTBAAScalarTypeNode("omnipotent char", root);
+            if (name != "omnipotent char")
+                type = mdb.createTBAAScalarTypeNode(name, type);
+            return mdb.createTBAAStructTagNode(type, type, 0);
+        }
+
+        static mlir::LogicalResult attach_tbaa(mlir::Operation *op, mlir::StringAttr name,
+                                               mlir::LLVM::ModuleTranslation &state)
+        {
+            if (!name)
+                return op->emitError("expected string type descriptor in ") << tbaa_attr_name;
+
+            auto inst = lookup_instruction(op, state);
+            if (!inst)
+                return op->emitError("unexpected memory access with ") << tbaa_attr_name;
+
+            inst->setMetadata(llvm::LLVMContext::MD_tbaa,
+                              make_tbaa_tag(state.getLLVMContext(), name.getValue()));
+            return mlir::success();
+        }
+
+        // Llvm dialect of llvm-15 has no section and alignment of functions.
+        static mlir::LogicalResult apply_placement(mlir::Operation *op, mlir::NamedAttribute attr,
+                                                   mlir::LLVM::ModuleTranslation &state)
+        {
+            auto fn = mlir::dyn_cast< mlir::LLVM::LLVMFuncOp >(op);
+            if (!fn)
+                return op->emitError("unexpected ") << attr.getName() << " on non-function";
+
+            auto lfn = state.lookupFunction(fn.getName());
+            if (!lfn)
+                return mlir::failure();
+
+            if (auto section = attr.getValue().dyn_cast< mlir::StringAttr >())
+                lfn->setSection(section.getValue());
+            else if (auto align = attr.getValue().dyn_cast< mlir::IntegerAttr >())
+                lfn->setAlignment(llvm::Align(align.getInt()));
+            else
+                return op->emitError("unexpected value of ") << attr.getName();
+            return mlir::success();
+        }
+
+        static mlir::LogicalResult apply_entry_count(mlir::Operation *op, mlir::IntegerAttr count,
+                                                     mlir::LLVM::ModuleTranslation &state)
+        {
+            auto fn = mlir::dyn_cast< mlir::LLVM::LLVMFuncOp >(op);
+            if (!fn || !count)
+                return op->emitError("expected count of function in ") << entry_count_attr_name;
+
+            auto lfn = state.lookupFunction(fn.getName());
+            if (!lfn)
+                return mlir::failure();
+
+            lfn->setEntryCount(uint64_t(count.getInt()));
+            return mlir::success();
+        }
+
+        // Switches have the weight of the default destination followed by
+        // weights of cases.
+        static unsigned successor_weights(mlir::Operation *op)
+        {
+            if (mlir::isa< mlir::LLVM::CondBrOp >(op))
+                return 2;
+            if (auto sw = mlir::dyn_cast< mlir::LLVM::SwitchOp >(op))
+                return unsigned(sw.getCaseDestinations().size()) + 1;
+            return 0;
+        }
+
+        static mlir::LogicalResult attach_branch_weights(mlir::Operation *op, mlir::ArrayAttr weights,
+                                                         mlir::LLVM::ModuleTranslation &state)
+        {
+            if (!weights || weights.size() != successor_weights(op))
+                return op->emitError("expected weight of each successor of branch in ")
+                    << branch_weights_attr_name;
+
+            auto inst = lookup_instruction(op, state);
+            if (!inst)
+                return op->emitError("unexpected branch with ") << branch_weights_attr_name;
+
+            llvm::SmallVector< uint32_t > values;
+            for (auto weight : weights.getAsRange< mlir::IntegerAttr >())
+                values.push_back(uint32_t(weight.getInt()));
+
+            llvm::MDBuilder mdb(state.getLLVMContext());
+            inst->setMetadata(llvm::LLVMContext::MD_prof, mdb.createBranchWeights(values));
+            return mlir::success();
+        }
+
+        // Loop hints are expected on the latch branch of the lowered loop.
+        static mlir::LogicalResult attach_loop_hints(mlir::Operation *op, mlir::DictionaryAttr hints,
+                                                     mlir::LLVM::ModuleTranslation &state)
+        {
+            if (!hints)
+                return op->emitError("expected dictionary of hints in ") << loop_hints_attr_name;
+
+            auto inst = lookup_instruction(op, state);
+            if (!inst || !inst->isTerminator())
+                return op->emitError("unexpected loop latch with ") << loop_hints_attr_name;
+
+            inst->setMetadata(llvm::LLVMContext::MD_loop,
+                              make_loop_id(state.getLLVMContext(), hints));
+            return mlir::success();
+        }
     };
 
+    // Llvm dialect of llvm-15 does not translate `readonly` argument attributes.
+    void apply_readonly_args(mlir::ModuleOp mod, llvm::Module &lmodule)
+    {
+        mod.walk([&](mlir::LLVM::LLVMFuncOp fn) {
+            auto lfn = lmodule.getFunction(fn.getName());
+            if (!lfn)
+                return;
+
+            for (unsigned i = 0; i < fn.getNumArguments(); ++i)
+                if (fn.getArgAttr(i, readonly_attr_name))
+                    lfn->addParamAttr(i, llvm::Attribute::ReadOnly);
+        });
+    }
+
     struct LLVMDump : LLVMDumpBase< LLVMDump >
     {
         void runOnOperation() override;
@@ -64,14 +320,31 @@ namespace vast::hl
         mlir::registerAllToLLVMIRTranslations(registry);
         mctx.appendDialectRegistry(registry);
 
-        llvm::LLVMContext lctx;
-        auto lmodule = mlir::translateModuleToLLVMIR(op, lctx);
-        if (!lmodule)
-            return signalPassFailure();
-
-
+        // Direct translation of high-level operations queries the data layout
+        // of the target, hence it has to be available upfront.
         llvm::InitializeNativeTarget();
         llvm::InitializeNativeTargetAsmPrinter();
+
+        // Modules emitted by vast-cc hold functions and globals of the
+        // high-level dialect directly, those are not visited by the module
+        // translation, which converts only operations of the llvm dialect.
+        auto is_high_level = [] (mlir::Operation &nested) {
+            return mlir::isa< mlir::func::FuncOp, VarDeclOp >(nested);
+        };
+
+        llvm::LLVMContext lctx;
+        std::unique_ptr< llvm::Module > lmodule;
+        if (llvm::any_of(*op.getBody(), is_high_level)) {
+            lmodule = std::make_unique< llvm::Module >("LLVMDialectModule", lctx);
+            if (mlir::failed(translate_to_llvm_ir(op, *lmodule)))
+                return signalPassFailure();
+        } else {
+            lmodule = mlir::translateModuleToLLVMIR(op, lctx);
+            if (!lmodule)
+                return signalPassFailure();
+        }
+
+        apply_readonly_args(op, *lmodule);
         mlir::ExecutionEngine::setupTargetTriple(lmodule.get());
 
         auto dump = [&](auto &stream)
@@ -93,6 +366,9 @@ namespace vast::hl
 void vast::hl::registerHLToLLVMIR(mlir::DialectRegistry &registry)
 {
     registry.insert< HighLevelDialect >();
+    registry.addExtension(+[](mlir::MLIRContext *, HighLevelDialect *dialect) {
+        dialect->addInterfaces< ToLLLVMIR >();
+    });
 }
 void vast::hl::registerHLToLLVMIR(mlir::MLIRContext &ctx)
 {
@@ -6,10 +6,17 @@
 
 VAST_RELAX_WARNINGS
 #include <mlir/IR/BuiltinOps.h>
+#include <mlir/Dialect/Affine/IR/AffineOps.h>
+#include <mlir/Dialect/Arithmetic/IR/Arithmetic.h>
+#include <mlir/Dialect/ControlFlow/IR/ControlFlow.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/Vector/IR/VectorOps.h>
 #include <mlir/Pass/Pass.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
+
 #include <memory>
 
 namespace vast::hl
@@ -18,4 +25,16 @@ namespace vast::hl
     #define GEN_PASS_CLASSES
     #include "vast/Dialect/HighLevel/Passes.h.inc"
 
+    // Access type descriptor attached to lowered memory accesses, translated
+    // into `!tbaa` metadata when exported to llvm ir.
+    static constexpr llvm::StringLiteral tbaa_attr_name = "hl.tbaa";
+
+    // Placement of lowered functions that the llvm dialect cannot express,
+    // applied when exported to llvm ir.
+    static constexpr llvm::StringLiteral section_attr_name = "hl.section";
+    static constexpr llvm::StringLiteral aligned_attr_name = "hl.aligned";
+
+    // Upstream llvm dialect name of the `readonly` argument attribute.
+    static constexpr llvm::StringLiteral readonly_attr_name = "llvm.readonly";
+
 } // namespace vast::hl
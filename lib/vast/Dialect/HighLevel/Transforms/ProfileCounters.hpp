@@ -0,0 +1,103 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/Location.h>
+#include <mlir/IR/Operation.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/SmallPtrSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+#include <algorithm>
+
+namespace vast::hl
+{
+    // Operations emitted from clang are located either by a file location or
+    // by a fused location of a meta identifier.
+    inline mlir::FileLineColLoc file_location(mlir::Location loc)
+    {
+        if (auto file = loc.dyn_cast< mlir::FileLineColLoc >())
+            return file;
+        if (auto fused = loc.dyn_cast< mlir::FusedLoc >())
+            for (auto nested : fused.getLocations())
+                if (auto file = file_location(nested))
+                    return file;
+        return {};
+    }
+
+    //
+    // Counters are numbered the same way clang maps regions of a function
+    // to counters: the body of the function has the first counter, the
+    // rest is assigned to labels, loops, switches and their labels, `if`
+    // statements and logical operators in preorder of the ast.
+    //
+    struct counter_numbering
+    {
+        // Operations in the order of their counters.
+        llvm::MapVector< mlir::Operation *, unsigned > counters;
+        llvm::SmallPtrSet< mlir::Operation *, 16 > visited;
+        unsigned next = 1;
+
+        static bool has_counter(mlir::Operation *op)
+        {
+            return mlir::isa< LabelStmt, WhileOp, DoOp, ForOp, SwitchOp, CaseOp, DefaultOp,
+                              IfOp, BinLAndOp, BinLOrOp >(op);
+        }
+
+        static bool is_assign(mlir::Operation *op)
+        {
+            return mlir::isa<
+                AssignOp, AddIAssignOp, AddFAssignOp, SubIAssignOp, SubFAssignOp,
+                MulIAssignOp, MulFAssignOp, DivSAssignOp, DivUAssignOp, DivFAssignOp,
+                RemSAssignOp, RemUAssignOp, RemFAssignOp, BinAndAssignOp, BinOrAssignOp,
+                BinXorAssignOp, BinShlAssignOp, BinShrAssignOp
+            >(op);
+        }
+
+        // Operands are evaluated before their users, whereas clang visits
+        // an expression before its subexpressions. Hence operations used
+        // in the same block are numbered as subtrees of their first user.
+        void number(mlir::Region &region)
+        {
+            for (auto &block : region)
+                for (auto &op : block)
+                    if (is_root(&op))
+                        number(&op);
+        }
+
+        static bool is_root(mlir::Operation *op)
+        {
+            for (auto user : op->getUsers())
+                if (user->getBlock() == op->getBlock())
+                    return false;
+            return true;
+        }
+
+        void number(mlir::Operation *op)
+        {
+            if (!visited.insert(op).second)
+                return;
+
+            if (has_counter(op))
+                counters[op] = next++;
+
+            // Assignments take the assigned value first.
+            auto operands = llvm::to_vector(op->getOperands());
+            if (is_assign(op))
+                std::reverse(operands.begin(), operands.end());
+
+            for (auto operand : operands)
+                if (auto def = operand.getDefiningOp(); def && def->getBlock() == op->getBlock())
+                    number(def);
+
+            for (auto &region : op->getRegions())
+                number(region);
+        }
+    };
+
+} // namespace vast::hl
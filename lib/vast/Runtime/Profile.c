@@ -0,0 +1,48 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Runtime/Profile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *profile_path(const char *path)
+{
+    if (path)
+        return path;
+    const char *env = getenv("VAST_PROFILE_FILE");
+    return env ? env : "default.proftext";
+}
+
+// Names list functions with the number of their counters, separated by
+// spaces, in the order of the counter array.
+int __vast_prof_write(const char *path, const unsigned long long *counters, const char *names)
+{
+    FILE *out = fopen(profile_path(path), "w");
+    if (!out)
+        return -1;
+
+    const char *it = names;
+    while (*it) {
+        size_t length = strcspn(it, " ");
+        const char *name = it;
+        it += length;
+
+        char *end = NULL;
+        unsigned long size = strtoul(it, &end, 10);
+        if (end == it) {
+            fclose(out);
+            return -1;
+        }
+        it = end + strspn(end, " ");
+
+        // The hash of the function is not used by the annotation.
+        fprintf(out, "%.*s\n# Func Hash:\n0\n# Num Counters:\n%lu\n# Counter Values:\n",
+                (int)length, name, size);
+        for (unsigned long i = 0; i < size; ++i)
+            fprintf(out, "%llu\n", *counters++);
+        fputc('\n', out);
+    }
+
+    return fclose(out) == 0 ? 0 : -1;
+}
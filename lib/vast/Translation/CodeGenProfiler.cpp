@@ -0,0 +1,121 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Translation/CodeGenProfiler.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/JSON.h>
+VAST_UNRELAX_WARNINGS
+
+#include <algorithm>
+
+namespace vast::hl
+{
+    namespace
+    {
+        double milliseconds(CodeGenProfiler::duration time) {
+            return std::chrono::duration< double, std::milli >(time).count();
+        }
+
+        int64_t microseconds(CodeGenProfiler::duration time) {
+            return std::chrono::duration_cast< std::chrono::microseconds >(time).count();
+        }
+
+    } // namespace
+
+    void CodeGenProfiler::leave(llvm::StringRef name, llvm::StringRef category) {
+        auto end = clock::now();
+        auto current = frames.pop_back_val();
+
+        auto time = end - current.start;
+        auto ops  = current.ops + current.nested_ops;
+
+        if (!frames.empty()) {
+            frames.back().nested_time += time;
+            frames.back().nested_ops  += ops;
+        }
+
+        if (category == "top-level") {
+            decls.push_back({ name.str(), time, ops });
+        } else {
+            auto &stats = nodes[name];
+            ++stats.count;
+            stats.time += time - current.nested_time;
+            stats.ops  += current.ops;
+        }
+
+        events.push_back({ name.str(), category, current.start, time, ops });
+    }
+
+    void CodeGenProfiler::record_phase(llvm::StringRef name, time_point start, time_point end) {
+        phases.push_back({ name.str(), end - start });
+        events.push_back({ name.str(), "phase", start, end - start, 0 });
+    }
+
+    void CodeGenProfiler::print_summary(llvm::raw_ostream &os) const {
+        for (const auto &phase : phases) {
+            os << llvm::format("%-32s %12.3f ms\n", phase.name.c_str(), milliseconds(phase.time));
+        }
+
+        std::vector< const llvm::StringMapEntry< node_stats > * > sorted;
+        for (const auto &entry : nodes) {
+            sorted.push_back(&entry);
+        }
+
+        llvm::sort(sorted, [] (const auto *lhs, const auto *rhs) {
+            if (lhs->second.time != rhs->second.time)
+                return lhs->second.time > rhs->second.time;
+            return lhs->first() < rhs->first();
+        });
+
+        os << llvm::format("\n%-32s %10s %12s %10s\n", "node", "count", "self ms", "self ops");
+        for (const auto *entry : sorted) {
+            const auto &stats = entry->second;
+            os << llvm::format("%-32s %10llu %12.3f %10llu\n",
+                entry->first().str().c_str(), (unsigned long long)stats.count,
+                milliseconds(stats.time), (unsigned long long)stats.ops
+            );
+        }
+
+        auto top_level = decls;
+        llvm::stable_sort(top_level, [] (const auto &lhs, const auto &rhs) {
+            return lhs.time > rhs.time;
+        });
+
+        os << llvm::format("\n%-32s %12s %10s\n", "top-level decl", "ms", "ops");
+        for (const auto &decl : top_level) {
+            os << llvm::format("%-32s %12.3f %10llu\n",
+                decl.name.c_str(), milliseconds(decl.time), (unsigned long long)decl.ops
+            );
+        }
+    }
+
+    void CodeGenProfiler::write_trace(llvm::raw_ostream &os) const {
+        if (events.empty()) {
+            os << llvm::json::Value(llvm::json::Object{ { "traceEvents", llvm::json::Array() } });
+            return;
+        }
+
+        auto origin = std::min_element(events.begin(), events.end(), [] (const auto &lhs, const auto &rhs) {
+            return lhs.start < rhs.start;
+        })->start;
+
+        llvm::json::Array trace;
+        for (const auto &event : events) {
+            trace.push_back(llvm::json::Object{
+                { "name", event.name },
+                { "cat",  event.category },
+                { "ph",   "X" },
+                { "ts",   microseconds(event.start - origin) },
+                { "dur",  microseconds(event.time) },
+                { "pid",  1 },
+                { "tid",  1 },
+                { "args", llvm::json::Object{ { "ops", int64_t(event.ops) } } }
+            });
+        }
+
+        os << llvm::json::Value(llvm::json::Object{ { "traceEvents", std::move(trace) } });
+    }
+
+} // namespace vast::hl
@@ -0,0 +1,72 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Translation/CodeGenStreamer.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/IR/Verifier.h>
+VAST_UNRELAX_WARNINGS
+
+#include <iterator>
+#include <string>
+
+namespace vast::hl
+{
+    LogicalResult CodeGenStreamer::stream(CodeGenContext &ctx) {
+        auto &block = ctx.mod->getBodyRegion().front();
+        auto begin  = last ? std::next(mlir::Block::iterator(last)) : block.begin();
+
+        for (auto &op : llvm::make_range(begin, block.end())) {
+            if (mlir::failed(print(ctx, &op)))
+                return mlir::failure();
+            last = &op;
+        }
+
+        return mlir::success();
+    }
+
+    LogicalResult CodeGenStreamer::flush(CodeGenContext &ctx) {
+        for (auto &op : ctx.mod->getBodyRegion().front()) {
+            if (!printed.contains(&op) && mlir::failed(print(ctx, &op)))
+                return mlir::failure();
+        }
+
+        return mlir::success();
+    }
+
+    LogicalResult CodeGenStreamer::print(CodeGenContext &ctx, Operation *op) {
+        if (mlir::failed(mlir::verify(op)))
+            return mlir::failure();
+
+        // Operations are nested in the module, hence indented.
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        op->print(os, flags);
+
+        llvm::StringRef rest = os.str();
+        while (!rest.empty()) {
+            auto [line, tail] = rest.split('\n');
+            body << "  " << line << "\n";
+            rest = tail;
+        }
+
+        printed.insert(op);
+
+        if (auto fn = mlir::dyn_cast< mlir::func::FuncOp >(op); fn && !fn.isDeclaration()) {
+            fn.eraseBody();
+            fn.setVisibility(mlir::func::FuncOp::Visibility::Private);
+            ctx.released.insert(fn);
+        }
+
+        return mlir::success();
+    }
+
+    void CodeGenStreamer::finish(Module mod, llvm::StringRef printed_body, llvm::raw_ostream &os) {
+        os << "module";
+        if (auto attrs = mod->getAttrDictionary(); !attrs.empty()) {
+            os << " attributes " << attrs;
+        }
+        os << " {\n" << printed_body << "}\n";
+    }
+
+} // namespace vast::hl
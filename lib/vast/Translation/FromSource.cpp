@@ -9,6 +9,7 @@ VAST_RELAX_WARNINGS
 #include <clang/Frontend/FrontendAction.h>
 #include <clang/Tooling/Tooling.h>
 #include <llvm/Support/ErrorHandling.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/SourceMgr.h>
 #include <mlir/Dialect/DLTI/DLTI.h>
@@ -29,7 +30,10 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Translation/CodeGen.hpp"
+#include "vast/Translation/CodeGenProfiler.hpp"
+#include "vast/Translation/PreambleCache.hpp"
 #include "vast/Util/Common.hpp"
+#include "vast/Util/MemoryReport.hpp"
 
 namespace vast::hl
 {
@@ -41,15 +45,90 @@ namespace vast::hl
         "id-meta", llvm::cl::desc("Attach ids to nodes as metadata")
     );
 
+    static llvm::cl::opt< bool > codegen_profile_flag(
+        "codegen-profile", llvm::cl::desc("Print time and emitted operations of codegen per node kind")
+    );
+
+    static llvm::cl::opt< std::string > codegen_trace_file(
+        "codegen-trace", llvm::cl::desc("Write profile of codegen as chrome trace to the file"),
+        llvm::cl::value_desc("filename")
+    );
+
+    static llvm::cl::opt< bool > memory_report_flag(
+        "memory-report", llvm::cl::desc("Print uniqued objects and operations kept alive by the module")
+    );
+
+    static llvm::cl::opt< std::string > preamble_cache_dir(
+        "preamble-cache", llvm::cl::desc("Reuse precompiled preambles of sources stored in the directory"),
+        llvm::cl::value_desc("directory")
+    );
+
+    // Shared by all sources translated by the process, e.g., by chunks of
+    // `--split-input-file`.
+    static PreambleCache &preamble_cache() {
+        static PreambleCache cache(preamble_cache_dir);
+        return cache;
+    }
+
+    static bool profile_codegen() {
+        return codegen_profile_flag || !codegen_trace_file.empty();
+    }
+
+    static void report_profile(const CodeGenProfiler &profiler) {
+        if (codegen_profile_flag) {
+            profiler.print_summary(llvm::errs());
+        }
+
+        if (!codegen_trace_file.empty()) {
+            std::error_code ec;
+            llvm::raw_fd_ostream out(codegen_trace_file, ec, llvm::sys::fs::OF_Text);
+            if (ec) {
+                llvm::errs() << "unable to write codegen trace: " << ec.message() << "\n";
+                return;
+            }
+            profiler.write_trace(out);
+        }
+    }
+
+    template< typename MetaGenerator >
+    static OwningModuleRef emit_profiled_module(
+        clang::ASTUnit *unit, mlir::MLIRContext *mctx,
+        CodeGenProfiler::time_point parse_start, CodeGenProfiler::time_point parse_end
+    ) {
+        DefaultCodeGen< DefaultCodeGenVisitorConfig, MetaGenerator, CodeGenProfiler > codegen(
+            &unit->getASTContext(), mctx
+        );
+        codegen.profiler.record_phase("clang parse", parse_start, parse_end);
+
+        auto codegen_start = CodeGenProfiler::clock::now();
+        auto mod = codegen.emit_module(unit);
+        codegen.profiler.record_phase("codegen", codegen_start, CodeGenProfiler::clock::now());
+
+        report_profile(codegen.profiler);
+        return mod;
+    }
+
     static OwningModuleRef from_source_parser(
         const llvm::MemoryBuffer *input, mlir::MLIRContext *mctx
     ) {
-        auto ast = clang::tooling::buildASTFromCodeWithArgs(
-            input->getBuffer(), compiler_args
-        );
+        auto parse_start = CodeGenProfiler::clock::now();
+        auto ast = preamble_cache().build_ast(input->getBuffer(), compiler_args);
+        auto parse_end = CodeGenProfiler::clock::now();
+        if (!ast) {
+            mlir::emitError(mlir::UnknownLoc::get(mctx), "unable to parse source");
+            return {};
+        }
 
         auto actx = &ast->getASTContext();
 
+        if (profile_codegen()) {
+            if (id_meta_flag) {
+                return emit_profiled_module< IDMetaGenerator >(ast.get(), mctx, parse_start, parse_end);
+            } else {
+                return emit_profiled_module< DefaultMetaGenerator >(ast.get(), mctx, parse_start, parse_end);
+            }
+        }
+
         if (id_meta_flag) {
             return CodeGenWithMetaIDs(actx, mctx).emit_module(ast.get());
         } else {
@@ -57,13 +136,51 @@ namespace vast::hl
         }
     }
 
+    static mlir::LogicalResult from_source_streamed(
+        const llvm::MemoryBuffer *input, llvm::raw_ostream &os, mlir::MLIRContext *mctx
+    ) {
+        // The streamed module is never complete in memory to be reported,
+        // and the streaming codegen is not profiled.
+        if (profile_codegen() || memory_report_flag) {
+            return mlir::emitError(mlir::UnknownLoc::get(mctx),
+                "--codegen-profile, --codegen-trace and --memory-report "
+                "are not supported with --from-source-stream"
+            );
+        }
+
+        auto ast = preamble_cache().build_ast(input->getBuffer(), compiler_args);
+        if (!ast) {
+            return mlir::emitError(mlir::UnknownLoc::get(mctx), "unable to parse source");
+        }
+
+        auto actx = &ast->getASTContext();
+
+        if (id_meta_flag) {
+            return CodeGenWithMetaIDs(actx, mctx).emit_module_streamed(ast.get(), os);
+        } else {
+            return DefaultCodeGen(actx, mctx).emit_module_streamed(ast.get(), os);
+        }
+    }
+
     mlir::LogicalResult registerFromSourceParser() {
         mlir::TranslateToMLIRRegistration from_source(
             "from-source",
             [](llvm::SourceMgr &mgr, mlir::MLIRContext *ctx) -> OwningModuleRef {
                 VAST_CHECK(mgr.getNumBuffers() == 1,    "expected single input buffer");
                 auto buffer = mgr.getMemoryBuffer(mgr.getMainFileID());
-                return from_source_parser(buffer, ctx);
+                auto mod = from_source_parser(buffer, ctx);
+                if (memory_report_flag && mod) {
+                    util::memory_report(mod->getOperation()).print(llvm::errs());
+                }
+                return mod;
+            });
+
+        mlir::TranslateRegistration from_source_stream(
+            "from-source-stream",
+            [](llvm::SourceMgr &mgr, llvm::raw_ostream &os, mlir::MLIRContext *ctx) {
+                VAST_CHECK(mgr.getNumBuffers() == 1,    "expected single input buffer");
+                auto buffer = mgr.getMemoryBuffer(mgr.getMainFileID());
+                return from_source_streamed(buffer, os, ctx);
             });
 
         return mlir::success();
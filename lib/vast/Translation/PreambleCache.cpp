@@ -0,0 +1,349 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Translation/PreambleCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/DiagnosticIDs.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/Version.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendActions.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Lex/Lexer.h>
+#include <clang/Tooling/ArgumentsAdjusters.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::hl
+{
+    namespace
+    {
+        //
+        // File with contents owned by `CachingFileSystem`.
+        //
+        struct cached_file : llvm::vfs::File {
+            cached_file(llvm::vfs::Status stat, const llvm::MemoryBuffer &buffer)
+                : stat(std::move(stat)), buffer(buffer)
+            {}
+
+            llvm::ErrorOr< llvm::vfs::Status > status() override { return stat; }
+
+            llvm::ErrorOr< std::unique_ptr< llvm::MemoryBuffer > > getBuffer(
+                const llvm::Twine &, int64_t, bool, bool
+            ) override {
+                return llvm::MemoryBuffer::getMemBuffer(
+                    buffer.getBuffer(), buffer.getBufferIdentifier()
+                );
+            }
+
+            std::error_code close() override { return {}; }
+
+            llvm::vfs::Status stat;
+            const llvm::MemoryBuffer &buffer;
+        };
+
+        //
+        // Builds ast unit of the invocation as `buildASTFromCodeWithArgs`.
+        //
+        struct ast_builder_action : clang::tooling::ToolAction {
+            bool runInvocation(
+                std::shared_ptr< clang::CompilerInvocation > invocation, clang::FileManager *files,
+                std::shared_ptr< clang::PCHContainerOperations > pch_ops,
+                clang::DiagnosticConsumer *diags
+            ) override {
+                unit = clang::ASTUnit::LoadFromCompilerInvocation(
+                    invocation, std::move(pch_ops),
+                    clang::CompilerInstance::createDiagnostics(
+                        &invocation->getDiagnosticOpts(), diags, /* ShouldOwnClient */ false
+                    ),
+                    files
+                );
+                return bool(unit);
+            }
+
+            std::unique_ptr< clang::ASTUnit > unit;
+        };
+
+        //
+        // Prints diagnostics of the unit unless the precompiled preamble
+        // fails to load, e.g., because one of its headers was modified.
+        //
+        struct preamble_diagnostics : clang::DiagnosticConsumer {
+            preamble_diagnostics()
+                : options(new clang::DiagnosticOptions()), printer(llvm::errs(), options.get())
+            {}
+
+            void BeginSourceFile(const clang::LangOptions &opts, const clang::Preprocessor *pp) override {
+                printer.BeginSourceFile(opts, pp);
+            }
+
+            void EndSourceFile() override { printer.EndSourceFile(); }
+
+            void HandleDiagnostic(
+                clang::DiagnosticsEngine::Level level, const clang::Diagnostic &info
+            ) override {
+                DiagnosticConsumer::HandleDiagnostic(level, info);
+
+                auto category = clang::DiagnosticIDs::getCategoryNumberForDiag(info.getID());
+                if (level >= clang::DiagnosticsEngine::Error
+                    && clang::DiagnosticIDs::getCategoryNameFromID(category) == "AST Deserialization Issue"
+                ) {
+                    stale = true;
+                }
+
+                if (!stale) {
+                    printer.HandleDiagnostic(level, info);
+                }
+            }
+
+            llvm::IntrusiveRefCntPtr< clang::DiagnosticOptions > options;
+            clang::TextDiagnosticPrinter printer;
+            bool stale = false;
+        };
+
+        llvm::StringRef header_language(const std::vector< std::string > &args, llvm::StringRef filename) {
+            llvm::StringRef lang = filename.endswith(".c") ? "c" : "c++";
+            for (size_t i = 0; i < args.size(); ++i) {
+                llvm::StringRef arg = args[i];
+                if (arg == "-x" && i + 1 < args.size()) {
+                    lang = args[++i];
+                } else if (arg.consume_front("-x")) {
+                    lang = arg;
+                }
+            }
+            return lang == "c" ? "c-header" : "c++-header";
+        }
+
+        std::vector< std::string > tool_args(
+            const std::vector< std::string > &args, llvm::StringRef filename
+        ) {
+            auto adjusted = clang::tooling::getClangStripDependencyFileAdjuster()(args, filename);
+            std::vector< std::string > cmd = { "clang-tool" };
+            cmd.insert(cmd.end(), adjusted.begin(), adjusted.end());
+            return cmd;
+        }
+
+    } // namespace
+
+    bool CachingFileSystem::is_cached(llvm::StringRef path) const {
+        return uncached.empty() || !path.startswith(uncached);
+    }
+
+    llvm::ErrorOr< llvm::vfs::Status > CachingFileSystem::status(const llvm::Twine &path) {
+        auto name = path.str();
+        if (!is_cached(name)) {
+            return ProxyFileSystem::status(path);
+        }
+
+        auto it = statuses.find(name);
+        if (it == statuses.end()) {
+            it = statuses.try_emplace(name, ProxyFileSystem::status(path)).first;
+        }
+        return it->second;
+    }
+
+    llvm::ErrorOr< std::unique_ptr< llvm::vfs::File > >
+    CachingFileSystem::openFileForRead(const llvm::Twine &path) {
+        auto name = path.str();
+        if (!is_cached(name)) {
+            return ProxyFileSystem::openFileForRead(path);
+        }
+
+        auto content = contents.find(name);
+        if (content == contents.end()) {
+            auto file = ProxyFileSystem::openFileForRead(path);
+            if (!file) {
+                return file.getError();
+            }
+
+            auto stat = (*file)->status();
+            if (!stat) {
+                return stat.getError();
+            }
+
+            auto buffer = (*file)->getBuffer(name);
+            if (!buffer) {
+                return buffer.getError();
+            }
+
+            statuses.erase(name);
+            statuses.try_emplace(name, *stat);
+            content = contents.try_emplace(name, std::move(*buffer)).first;
+        }
+
+        return std::unique_ptr< llvm::vfs::File >(
+            std::make_unique< cached_file >(*statuses.find(name)->second, *content->second)
+        );
+    }
+
+    PreambleCache::PreambleCache(std::string dir) : directory(std::move(dir)) {
+        llvm::SmallString< 128 > cwd;
+        if (!llvm::sys::fs::current_path(cwd)) {
+            working_directory = cwd.str().str();
+        }
+
+        if (!directory.empty()) {
+            llvm::SmallString< 128 > path(directory);
+            llvm::sys::fs::make_absolute(path);
+            directory = path.str().str();
+
+            if (auto ec = llvm::sys::fs::create_directories(directory)) {
+                llvm::errs() << "warning: unable to create preamble cache '" << directory
+                             << "': " << ec.message() << "\n";
+                directory.clear();
+            }
+        }
+
+        fs = llvm::makeIntrusiveRefCnt< CachingFileSystem >(
+            llvm::vfs::getRealFileSystem(), directory
+        );
+    }
+
+    std::unique_ptr< clang::ASTUnit > PreambleCache::build_ast(
+        llvm::StringRef code, const std::vector< std::string > &args, llvm::StringRef filename
+    ) {
+        auto bounds = clang::Lexer::ComputePreamble(code, clang::LangOptions());
+        if (directory.empty() || bounds.Size == 0) {
+            return parse(code, args, filename, nullptr);
+        }
+
+        // The preamble is blanked out of the source, so that locations of
+        // the rest of the source stay the same.
+        auto preamble = code.take_front(bounds.Size);
+        std::string rest = code.str();
+        for (size_t i = 0; i < bounds.Size; ++i) {
+            if (rest[i] != '\n' && rest[i] != '\r') {
+                rest[i] = ' ';
+            }
+        }
+
+        for (bool rebuild : { false, true }) {
+            auto pch = precompiled_preamble(preamble, args, filename, rebuild);
+            if (pch.empty()) {
+                break;
+            }
+
+            auto with_pch = args;
+            with_pch.push_back("-include-pch");
+            with_pch.push_back(pch);
+
+            bool stale = false;
+            if (auto unit = parse(rest, with_pch, filename, &stale); !stale) {
+                return unit;
+            }
+        }
+
+        return parse(code, args, filename, nullptr);
+    }
+
+    std::string PreambleCache::precompiled_preamble(
+        llvm::StringRef preamble, const std::vector< std::string > &args,
+        llvm::StringRef filename, bool rebuild
+    ) {
+        auto lang = header_language(args, filename);
+
+        llvm::MD5 hash;
+        hash.update(clang::getClangFullVersion());
+        hash.update(working_directory);
+        hash.update(lang);
+        for (const auto &arg : args) {
+            hash.update(arg);
+            hash.update(llvm::ArrayRef< uint8_t >{ 0 });
+        }
+        hash.update(preamble);
+
+        llvm::MD5::MD5Result digest;
+        hash.final(digest);
+        auto key = digest.digest().str().str();
+
+        if (!rebuild) {
+            if (auto it = built.find(key); it != built.end()) {
+                return it->second;
+            }
+        }
+
+        llvm::SmallString< 128 > pch(directory);
+        llvm::sys::path::append(pch, key + ".pch");
+
+        if (!rebuild && llvm::sys::fs::exists(pch)) {
+            return built[key] = pch.str().str();
+        }
+
+        // The precompiled header refers to the header of the preamble,
+        // which has to outlive it.
+        llvm::SmallString< 128 > header(directory);
+        llvm::sys::path::append(header, key + ".h");
+        if (!llvm::sys::fs::exists(header)) {
+            std::error_code ec;
+            llvm::raw_fd_ostream os(header, ec, llvm::sys::fs::OF_Text);
+            if (ec) {
+                return {};
+            }
+            os << preamble;
+        }
+
+        // Written to a unique file first, so that concurrent invocations
+        // never see an incomplete header.
+        llvm::SmallString< 128 > tmp;
+        if (llvm::sys::fs::createUniqueFile(llvm::Twine(pch) + "-%%%%%%%%", tmp)) {
+            return {};
+        }
+
+        // Quoted includes of the preamble are relative to the source.
+        auto cmd = tool_args(args, filename);
+        cmd.insert(cmd.end(), {
+            "-iquote", working_directory, "-x", lang.str(), header.str().str(), "-o", tmp.str().str()
+        });
+
+        auto files = llvm::makeIntrusiveRefCnt< clang::FileManager >(clang::FileSystemOptions(), fs);
+        clang::tooling::ToolInvocation invocation(
+            cmd, std::make_unique< clang::GeneratePCHAction >(), files.get()
+        );
+
+        // Errors of the preamble are reported by the parse of the source.
+        clang::DiagnosticConsumer silent;
+        invocation.setDiagnosticConsumer(&silent);
+
+        if (!invocation.run() || llvm::sys::fs::rename(tmp, pch)) {
+            llvm::sys::fs::remove(tmp);
+            return {};
+        }
+
+        return built[key] = pch.str().str();
+    }
+
+    std::unique_ptr< clang::ASTUnit > PreambleCache::parse(
+        llvm::StringRef code, const std::vector< std::string > &args, llvm::StringRef filename,
+        bool *stale_preamble
+    ) {
+        auto overlay   = llvm::makeIntrusiveRefCnt< llvm::vfs::OverlayFileSystem >(fs);
+        auto in_memory = llvm::makeIntrusiveRefCnt< llvm::vfs::InMemoryFileSystem >();
+        overlay->pushOverlay(in_memory);
+        in_memory->addFile(filename, 0, llvm::MemoryBuffer::getMemBufferCopy(code));
+
+        auto cmd = tool_args(args, filename);
+        cmd.push_back("-fsyntax-only");
+        cmd.push_back(filename.str());
+
+        auto files = llvm::makeIntrusiveRefCnt< clang::FileManager >(clang::FileSystemOptions(), overlay);
+        ast_builder_action action;
+        clang::tooling::ToolInvocation invocation(cmd, &action, files.get());
+
+        preamble_diagnostics diagnostics;
+        if (stale_preamble) {
+            invocation.setDiagnosticConsumer(&diagnostics);
+        }
+
+        auto ok = invocation.run();
+        if (stale_preamble) {
+            *stale_preamble = diagnostics.stale;
+        }
+
+        return ok ? std::move(action.unit) : nullptr;
+    }
+
+} // namespace vast::hl
@@ -4,6 +4,7 @@ import os
 import platform
 import re
 import subprocess
+import sys
 import tempfile
 
 import lit.formats
@@ -48,8 +49,14 @@ config.test_exec_root = os.path.join(config.vast_obj_root, 'test')
 config.vast_test_util = os.path.join(config.vast_src_root, 'test/utils')
 config.vast_tools_dir = os.path.join(config.vast_obj_root, 'bin')
 
-tools = [ 'vast-opt', 'vast-cc', 'vast-query' ]
+tools = [ 'vast-opt', 'vast-cc', 'vast-query', 'vast-repl' ]
 utils = [ 'ignore-test' ]
 
 llvm_config.add_tool_substitutions(tools, config.vast_tools_dir)
 llvm_config.add_tool_substitutions(utils, config.vast_test_util)
+
+# Generator of synthetic inputs, e.g., of deep operator chains.
+config.substitutions.append(('%gen-corpus', '"%s" "%s"' % (
+    config.python_executable or sys.executable,
+    os.path.join(config.vast_test_util, 'gen-corpus.py')
+)))
@@ -0,0 +1,3 @@
+int helper(int x) { return x + 1; }
+
+int compute(int x) { double d = x; return helper(x) + (int)(d * 0.5); }
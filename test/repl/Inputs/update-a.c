@@ -0,0 +1,3 @@
+int helper(int x) { return x + 1; }
+
+int compute(int x) { return helper(x) * 2; }
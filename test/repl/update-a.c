@@ -0,0 +1,12 @@
+// RUN: printf 'meta add 7 helper\nload %S/Inputs/update-a-edited.c\nshow module\nexit\n' | vast-repl %S/Inputs/update-a.c | FileCheck %s
+
+// Only the body of compute changed, hence it alone is emitted again and
+// spliced into the module, which keeps metadata of other functions.
+
+// CHECK: module attributes {dlti.dl_spec = #dlti.dl_spec<
+// CHECK-SAME: #dlti.dl_entry<!hl.double
+// CHECK: func @helper
+// CHECK-SAME: meta_identifier = #meta.id<7>
+// CHECK: func @compute
+// CHECK: hl.var "d" : !hl.lvalue<!hl.double>
+// CHECK: hl.call @helper
@@ -0,0 +1,122 @@
+# Copyright (c) 2022 Trail of Bits, Inc.
+
+import argparse
+import sys
+
+# Generators of synthetic C programs. Each of them stresses a single
+# dimension of the input, whose size is given by `n`, so that the cost of
+# vast tools can be measured as a function of it.
+
+def functions(n):
+    out = []
+    for i in range(n):
+        out.append(f'int fn_{i}(int x) {{ return x + {i}; }}')
+    calls = ' + '.join(f'fn_{i}(x)' for i in range(min(n, 16)))
+    out.append(f'int entry(int x) {{ return {calls or "x"}; }}')
+    return '\n'.join(out)
+
+def nesting(n):
+    out = ['int entry(int x) {', '    int acc = 0;']
+    for i in range(n):
+        indent = '    ' * (i + 1)
+        out.append(f'{indent}if (x > {i}) {{')
+        out.append(f'{indent}    int v_{i} = x - {i};')
+        out.append(f'{indent}    acc += v_{i};')
+    for i in reversed(range(n)):
+        out.append('    ' * (i + 1) + '}')
+    out += ['    return acc;', '}']
+    return '\n'.join(out)
+
+def expression(n):
+    ops = ['+', '-', '*', '^', '|', '&']
+    terms = ['x']
+    for i in range(n):
+        terms.append(f' {ops[i % len(ops)]} {i % 7 + 1}')
+    return f'int entry(int x) {{ return {"".join(terms)}; }}'
+
+# Left-deep chain of a single operator, i.e., an expression of depth `n`.
+def chain(n):
+    terms = ''.join(f' + {i % 7 + 1}' for i in range(n))
+    return f'int entry(int x) {{ return x{terms}; }}'
+
+def switch(n):
+    out = ['int entry(int x) {', '    int r = 0;', '    switch (x) {']
+    for i in range(n):
+        out.append(f'        case {i}: r = {i * 3}; break;')
+    out += ['        default: r = -1;', '    }', '    return r;', '}']
+    return '\n'.join(out)
+
+def initializer(n):
+    values = ', '.join(str(i % 251) for i in range(max(n, 1)))
+    return '\n'.join([
+        f'int table[{max(n, 1)}] = {{ {values} }};',
+        'int entry(int x) { return table[x]; }'
+    ])
+
+def structs(n):
+    out = ['struct s_0 { int a; int b; };']
+    for i in range(1, n):
+        out.append(f'struct s_{i} {{ struct s_{i - 1} prev; int v_{i}; }};')
+    field = f'v_{n - 1}' if n > 1 else 'a'
+    out.append(f'int entry(struct s_{max(n, 1) - 1} *s) {{ return s->{field}; }}')
+    return '\n'.join(out)
+
+def typedefs(n):
+    out = ['typedef int t_0;']
+    for i in range(1, n):
+        out.append(f'typedef t_{i - 1} t_{i};')
+    out.append(f't_{max(n, 1) - 1} entry(t_0 x) {{ return x; }}')
+    return '\n'.join(out)
+
+def globals(n):
+    out = [f'int g_{i} = {i};' for i in range(n)]
+    uses = ' + '.join(f'g_{i}' for i in range(0, n, max(n // 16, 1)))
+    out.append(f'int entry(void) {{ return {uses or "0"}; }}')
+    return '\n'.join(out)
+
+shapes = {
+    'functions'   : functions,
+    'nesting'     : nesting,
+    'expression'  : expression,
+    'chain'       : chain,
+    'switch'      : switch,
+    'initializer' : initializer,
+    'structs'     : structs,
+    'typedefs'    : typedefs,
+    'globals'     : globals,
+}
+
+def generate(shape, size):
+    header = f'// Generated by gen-corpus.py --shape={shape} --size={size}\n\n'
+    return header + shapes[shape](size) + '\n'
+
+def main():
+    main_desc = """Generates a synthetic C program of a given shape and size to stress-test vast tools."""
+
+    args_p = argparse.ArgumentParser(formatter_class=argparse.RawDescriptionHelpFormatter,
+                                     description=main_desc)
+    args_p.add_argument('--shape',
+                        help='Dimension of the program that grows with its size',
+                        choices=sorted(shapes.keys()),
+                        required=True)
+    args_p.add_argument('--size',
+                        help='Number of generated entities, e.g., functions or cases',
+                        type=int,
+                        required=True)
+    args_p.add_argument('-o', '--output',
+                        help='Output file, stdout by default')
+
+    args = args_p.parse_args()
+
+    source = generate(args.shape, args.size)
+    if args.output:
+        with open(args.output, 'w') as out:
+            out.write(source)
+    else:
+        sys.stdout.write(source)
+
+    return 0
+
+if __name__ == "__main__":
+    return_code = main()
+    sys.exit(return_code)
@@ -0,0 +1,187 @@
+# Copyright (c) 2022 Trail of Bits, Inc.
+
+import argparse
+import importlib.util
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+# Expected to be in PATH, as in compile.py.
+vast_cc = 'vast-cc'
+vast_opt = 'vast-opt'
+vast_query = 'vast-query'
+
+def load_generator():
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'gen-corpus.py')
+    spec = importlib.util.spec_from_file_location('gen_corpus', path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+gen_corpus = load_generator()
+
+class StageFail(Exception):
+    def __init__(self, stage, shape, size, err):
+        self._stage = stage
+        self._shape = shape
+        self._size = size
+        self._err = err
+
+    def brief(self):
+        return f'{self._stage} failed on {self._shape} of size {self._size}'
+
+    def __str__(self):
+        return f'{self.brief()}:\n{self._err}'
+
+# Runs a tool and returns its wall time in seconds, its peak memory in KB
+# and its error output in case of failure.
+def measure(args, timeout):
+    with tempfile.TemporaryFile(mode='w+') as err:
+        start = time.perf_counter()
+        proc = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=err)
+        timer = threading.Timer(timeout, proc.kill)
+        timer.start()
+        # Waits for the process directly to get usage of this child alone.
+        _, status, usage = os.wait4(proc.pid, 0)
+        seconds = time.perf_counter() - start
+        timed_out = not timer.is_alive()
+        timer.cancel()
+        proc.returncode = os.waitstatus_to_exitcode(status)
+
+        if timed_out:
+            return None, None, 'Timeout'
+        if proc.returncode != 0:
+            err.seek(0)
+            return None, None, 'Ret code is ' + str(proc.returncode) + '\n' + err.read()
+
+    rss = usage.ru_maxrss // 1024 if sys.platform == 'darwin' else usage.ru_maxrss
+    return seconds, rss, None
+
+def stages(source, size, workdir):
+    mlir = os.path.join(workdir, 'out.mlir')
+    # Nesting shapes exceed the default bracket depth of clang (256).
+    depth = '-fbracket-depth=' + str(size + 16)
+    return [
+        ('vast-cc', [vast_cc, '--ccopts', '-xc', '--ccopts', depth,
+                     '--from-source', source, '-o=' + mlir]),
+        ('vast-opt', [vast_opt, '--vast-hl-lower-types', '--vast-hl-to-scf',
+                      '--vast-hl-to-ll', mlir]),
+        ('vast-query', [vast_query, '--show-symbols=all', mlir]),
+    ]
+
+# Least squares fit of `time = c * size ^ exponent` in log-log scale.
+def fit_exponent(points):
+    points = [(size, t) for size, t in points if size > 0 and t and t > 0]
+    if len(points) < 2:
+        return None
+    xs = [math.log(size) for size, _ in points]
+    ys = [math.log(t) for _, t in points]
+    mx = sum(xs) / len(xs)
+    my = sum(ys) / len(ys)
+    var = sum((x - mx) ** 2 for x in xs)
+    if var == 0:
+        return None
+    return sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / var
+
+# Measures the shape up to the first failing size, results of smaller sizes
+# are kept.
+def run_shape(shape, sizes, args):
+    results = {}
+    with tempfile.TemporaryDirectory() as workdir:
+        source = os.path.join(workdir, shape + '.c')
+        for size in sizes:
+            with open(source, 'w') as out:
+                out.write(gen_corpus.generate(shape, size))
+
+            for stage, cmd in stages(source, size, workdir):
+                samples = []
+                for _ in range(args.repeat):
+                    seconds, rss, err = measure(cmd, args.timeout)
+                    if err is not None:
+                        return results, StageFail(stage, shape, size, err)
+                    samples.append((seconds, rss))
+                best = min(samples)
+                results.setdefault(stage, []).append({
+                    'size': size, 'seconds': best[0], 'peak_rss_kb': best[1]
+                })
+    return results, None
+
+def report(shape, results, args, out):
+    flagged = []
+    for stage, points in results.items():
+        exponent = fit_exponent([(p['size'], p['seconds']) for p in points])
+        superlinear = exponent is not None and exponent > args.threshold
+        if superlinear:
+            flagged.append((shape, stage, exponent))
+
+        out.write(f'{shape:<12} {stage:<11}')
+        for p in points:
+            out.write(f' {p["size"]:>7}:{p["seconds"] * 1000:>9.1f}ms')
+        fitted = 'n/a' if exponent is None else f'{exponent:.2f}'
+        out.write(f'  exponent {fitted}{"  SUPERLINEAR" if superlinear else ""}\n')
+    return flagged
+
+def main():
+    main_desc = """Runs vast-cc, vast-opt and vast-query on synthetic programs of growing sizes and fits their time as `c * size ^ exponent`. Stages whose exponent exceeds the threshold are reported as superlinear. It is expected vast tools are in PATH."""
+
+    args_p = argparse.ArgumentParser(formatter_class=argparse.RawDescriptionHelpFormatter,
+                                     description=main_desc)
+    args_p.add_argument('--shapes',
+                        help='Shapes of generated programs, all by default',
+                        choices=sorted(gen_corpus.shapes.keys()),
+                        action='extend',
+                        nargs='+')
+    args_p.add_argument('--sizes',
+                        help='Sizes of generated programs',
+                        type=int,
+                        nargs='+',
+                        default=[250, 500, 1000, 2000, 4000])
+    args_p.add_argument('--repeat',
+                        help='Number of runs of a stage, the fastest is kept',
+                        type=int,
+                        default=3)
+    args_p.add_argument('--threshold',
+                        help='Largest exponent considered linear',
+                        type=float,
+                        default=1.3)
+    args_p.add_argument('--timeout',
+                        help='Timeout of a single run in seconds',
+                        type=int,
+                        default=300)
+    args_p.add_argument('--json',
+                        help='Write measurements to the file')
+
+    args = args_p.parse_args()
+    shapes = args.shapes or sorted(gen_corpus.shapes.keys())
+
+    measurements = {}
+    flagged = []
+    failures = []
+    for shape in shapes:
+        results, fail = run_shape(shape, sorted(args.sizes), args)
+        if fail is not None:
+            print(fail, file=sys.stderr)
+            failures.append(fail)
+        measurements[shape] = results
+        flagged += report(shape, results, args, sys.stdout)
+
+    if args.json:
+        with open(args.json, 'w') as out:
+            json.dump(measurements, out, indent=2)
+
+    for shape, stage, exponent in flagged:
+        print(f'superlinear: {stage} on {shape} grows as size ^ {exponent:.2f}', file=sys.stderr)
+
+    for fail in failures:
+        print(fail.brief(), file=sys.stderr)
+
+    return 1 if flagged or failures else 0
+
+if __name__ == "__main__":
+    return_code = main()
+    sys.exit(return_code)
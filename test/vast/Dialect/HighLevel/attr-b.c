@@ -0,0 +1,17 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK: hl.var "table" {aligned = #hl.aligned<64>, section = #hl<section ".data.hot">} : !hl.lvalue<!hl.array<16, !hl.int>>
+int table[16] __attribute__((aligned(64), section(".data.hot")));
+
+// CHECK: func @hot_path() -> !hl.void attributes {hot = #hl.hot, noinline = #hl.noinline}
+__attribute__((hot, noinline)) void hot_path(void) {}
+
+// CHECK: func @cold_path() -> !hl.void attributes {cold = #hl.cold, noreturn = #hl.noreturn}
+__attribute__((cold, noreturn)) void cold_path(void) { for (;;) {} }
+
+// CHECK: func @square({{.*}}) -> !hl.int attributes {always_inline = #hl.always_inline, const = #hl.const}
+__attribute__((always_inline, const)) int square(int x) { return x * x; }
+
+// CHECK: func @lookup({{.*}}) -> !hl.int attributes {annotation = [#hl<annotation "first">, #hl<annotation "second">], pure = #hl.pure}
+__attribute__((pure, annotate("first"), annotate("second"))) int lookup(int i) { return table[i]; }
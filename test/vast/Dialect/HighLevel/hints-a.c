@@ -0,0 +1,36 @@
+// RUN: vast-cc --from-source %s | FileCheck %s
+// RUN: vast-cc --from-source %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK-LABEL: func @loop_pragmas
+void loop_pragmas(int *a, int n)
+{
+    // CHECK: hl.for {
+    // CHECK: } incr {
+    // CHECK: } {hl.loop_hints = {unroll_count = 4 : i32}} do {
+    #pragma unroll 4
+    for (int i = 0; i < n; i++) a[i] = 0;
+
+    // CHECK: } {hl.loop_hints = {vectorize = "enable", vectorize_width = 8 : i32}}
+    #pragma clang loop vectorize(enable) vectorize_width(8)
+    while (n--) a[n] = 1;
+
+    // CHECK: } {hl.loop_hints = {unroll = "disable"}}
+    #pragma nounroll
+    do { --n; } while (n > 0);
+}
+
+// CHECK-LABEL: func @branch_hints
+int branch_hints(int x)
+{
+    // CHECK: hl.if {
+    // CHECK: } then {
+    // CHECK: } {hl.branch_weights = [1 : i32, 2000 : i32]}
+    if (__builtin_expect(x == 0, 0))
+        return 0;
+
+    // CHECK: hl.while {
+    // CHECK: } {hl.branch_weights = [2000 : i32, 1 : i32]}
+    while (__builtin_expect(x > 10, 1))
+        --x;
+    return x;
+}
@@ -0,0 +1,28 @@
+// RUN: vast-cc --ccopts -xc --from-source %s --id-meta --memory-report 2>&1 >/dev/null | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --memory-report 2>&1 >/dev/null | FileCheck %s --check-prefix=OPT
+
+// CHECK: peak rss KB
+// CHECK: data layout entries {{ +}}{{[1-9][0-9]*}}
+// CHECK: dialect {{ +}}ops {{ +}}est. bytes
+// CHECK-DAG: hl {{ +}}{{[1-9][0-9]*}}
+// CHECK-DAG: builtin {{ +}}1
+// CHECK: type {{ +}}distinct {{ +}}uses
+// CHECK-DAG: hl.lvalue
+// CHECK-DAG: hl.int
+// CHECK: attribute {{ +}}distinct {{ +}}uses
+// CHECK-DAG: meta.id
+// CHECK: location {{ +}}distinct {{ +}}uses
+// CHECK-DAG: loc.fused
+
+// OPT: dialect {{ +}}ops {{ +}}est. bytes
+// OPT: type {{ +}}distinct {{ +}}uses
+// OPT: builtin.integer
+// OPT: location {{ +}}distinct {{ +}}uses
+// OPT: loc.file_line_col
+
+int add(int a, int b) { return a + b; }
+
+int main() {
+    int x = add(1, 2);
+    return x;
+}
@@ -0,0 +1,34 @@
+// RUN: vast-cc --from-source %s | FileCheck %s
+// RUN: vast-cc --from-source %s > %t && vast-opt %t | diff -B %t -
+
+// CHECK: func @chain() -> !hl.void
+void chain()
+{
+    // CHECK: hl.var "v" : !hl.lvalue<!hl.int> = {
+    // CHECK:   [[V1:%[0-9]+]] = hl.const #hl.integer<1> : !hl.int
+    // CHECK:   [[V2:%[0-9]+]] = hl.const #hl.integer<2> : !hl.int
+    // CHECK:   [[V3:%[0-9]+]] = hl.add [[V1]], [[V2]] : !hl.int
+    // CHECK:   [[V4:%[0-9]+]] = hl.const #hl.integer<3> : !hl.int
+    // CHECK:   [[V5:%[0-9]+]] = hl.sub [[V3]], [[V4]] : !hl.int
+    // CHECK:   [[V6:%[0-9]+]] = hl.const #hl.integer<4> : !hl.int
+    // CHECK:   [[V7:%[0-9]+]] = hl.add [[V5]], [[V6]] : !hl.int
+    // CHECK:   hl.value.yield [[V7]]
+    int v = 1 + 2 - 3 + 4;
+}
+
+// CHECK: func @mixed([[A1:%arg[0-9]+]]: !hl.lvalue<!hl.int>, [[A2:%arg[0-9]+]]: !hl.lvalue<!hl.int>) -> !hl.int
+int mixed(int a, int b)
+{
+    // CHECK: [[V1:%[0-9]+]] = hl.ref [[A1]] : !hl.lvalue<!hl.int>
+    // CHECK: [[V2:%[0-9]+]] = hl.implicit_cast [[V1]] LValueToRValue : !hl.lvalue<!hl.int> -> !hl.int
+    // CHECK: [[V3:%[0-9]+]] = hl.ref [[A2]] : !hl.lvalue<!hl.int>
+    // CHECK: [[V4:%[0-9]+]] = hl.implicit_cast [[V3]] LValueToRValue : !hl.lvalue<!hl.int> -> !hl.int
+    // CHECK: [[V5:%[0-9]+]] = hl.const #hl.integer<2> : !hl.int
+    // CHECK: [[V6:%[0-9]+]] = hl.mul [[V4]], [[V5]] : !hl.int
+    // CHECK: [[V7:%[0-9]+]] = hl.add [[V2]], [[V6]] : !hl.int
+    // CHECK: [[V8:%[0-9]+]] = hl.const #hl.integer<7> : !hl.int
+    // CHECK: [[V9:%[0-9]+]] = hl.cmp slt [[V7]], [[V8]] : !hl.int, !hl.int -> !hl.int
+    // CHECK: [[V10:%[0-9]+]] = hl.const #hl.integer<1> : !hl.int
+    // CHECK: hl.bin.xor [[V9]], [[V10]] : !hl.int
+    return a + b * 2 < 7 ^ 1;
+}
@@ -0,0 +1,8 @@
+// RUN: %gen-corpus --shape=chain --size=20000 -o %t.c
+// RUN: vast-cc --ccopts -xc --from-source %t.c | FileCheck %s
+
+// The chain is deeper than the stack would allow to emit recursively.
+// CHECK-LABEL: func @entry
+// CHECK-COUNT-20000: hl.add
+// CHECK-NOT: hl.add
+// CHECK: hl.return
@@ -0,0 +1,15 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: vast-cc --ccopts -xc --from-source %s > %t/plain.mlir
+// RUN: vast-cc --ccopts -xc --preamble-cache=%t/cache --from-source %s > %t/cold.mlir
+// RUN: vast-cc --ccopts -xc --preamble-cache=%t/cache --from-source %s > %t/warm.mlir
+// RUN: diff %t/plain.mlir %t/cold.mlir
+// RUN: diff %t/plain.mlir %t/warm.mlir
+// RUN: ls %t/cache | FileCheck %s
+
+// CHECK: .pch
+
+#include <stddef.h>
+
+#define SCALE 4
+
+size_t scaled(size_t v) { return v * SCALE; }
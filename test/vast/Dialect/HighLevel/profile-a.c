@@ -0,0 +1,25 @@
+// RUN: vast-cc --ccopts -xc --from-source %s --codegen-profile --codegen-trace=%t.json 2>&1 >/dev/null | FileCheck %s
+// RUN: FileCheck %s --check-prefix=TRACE < %t.json
+
+// CHECK: clang parse
+// CHECK: codegen
+// CHECK: node {{ +}}count {{ +}}self ms {{ +}}self ops
+// CHECK-DAG: FunctionDecl
+// CHECK-DAG: ReturnStmt {{ +}}1
+// CHECK-DAG: BinaryOperator {{ +}}3
+// CHECK: top-level decl
+// CHECK-DAG: square
+// CHECK-DAG: main
+
+// TRACE: "traceEvents":[
+// TRACE-DAG: "cat":"phase"
+// TRACE-DAG: "cat":"top-level"
+// TRACE-DAG: "name":"square"
+// TRACE-DAG: "name":"ReturnStmt"
+
+int square(int x) { return x * x; }
+
+int main() {
+    int y = square(3);
+    y = y + 1;
+}
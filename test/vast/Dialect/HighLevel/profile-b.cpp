@@ -0,0 +1,12 @@
+// RUN: vast-cc --from-source %s --codegen-profile 2>&1 >/dev/null | FileCheck %s
+
+// Operators have no identifier as their name.
+// CHECK: top-level decl
+// CHECK-DAG: operator+
+// CHECK-DAG: add
+
+enum color { red, green };
+
+int operator+(color c, int v) { return v; }
+
+int add(int v) { return red + v; }
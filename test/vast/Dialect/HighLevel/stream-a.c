@@ -0,0 +1,30 @@
+// RUN: vast-cc --ccopts -xc --from-source-stream %s | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt > %t && vast-cc --ccopts -xc --from-source-stream %s | vast-opt | diff -B %t -
+// RUN: (vast-cc --ccopts -xc --from-source-stream %s --memory-report 2>&1 >/dev/null || true) | FileCheck %s --check-prefix=UNSUPPORTED
+// RUN: (vast-cc --ccopts -xc --from-source-stream %s --codegen-profile 2>&1 >/dev/null || true) | FileCheck %s --check-prefix=UNSUPPORTED
+
+// CHECK: module attributes {dlti.dl_spec = #dlti.dl_spec<
+
+// UNSUPPORTED: error: --codegen-profile, --codegen-trace and --memory-report are not supported with --from-source-stream
+
+struct point { int x; int y; };
+
+int counter = 0;
+
+// The definition is emitted in place of the first declaration.
+// CHECK: func @square
+// CHECK: hl.mul
+int square(int v);
+
+// CHECK: func @sum
+// CHECK: hl.call @square
+int sum(struct point p) { return square(p.x) + square(p.y); }
+
+int square(int v) { return v * v; }
+
+// CHECK: func @main
+int main() {
+    struct point p = { 1, 2 };
+    counter = sum(p);
+    return counter;
+}
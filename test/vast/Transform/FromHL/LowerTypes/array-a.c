@@ -4,16 +4,16 @@
 // CHECK: hl.var "ai" : !hl.lvalue<memref<10xi32>>
 int ai[10];
 
-// CHECK: hl.var "aci" : !hl.lvalue<memref<5xi32>>
+// CHECK: hl.var "aci" {hl.const} : !hl.lvalue<memref<5xi32>>
 const int aci[5];
 
-// CHECK: hl.var "avi" : !hl.lvalue<memref<5xi32>>
+// CHECK: hl.var "avi" {hl.volatile} : !hl.lvalue<memref<5xi32>>
 volatile int avi[5];
 
-// CHECK: hl.var "acvi" : !hl.lvalue<memref<5xi32>>
+// CHECK: hl.var "acvi" {hl.const, hl.volatile} : !hl.lvalue<memref<5xi32>>
 const volatile int acvi[5];
 
-// CHECK: hl.var "acvui" : !hl.lvalue<memref<5xi32>>
+// CHECK: hl.var "acvui" {hl.const, hl.volatile} : !hl.lvalue<memref<5xi32>>
 const volatile unsigned int acvui[5];
 
 // CHECK: hl.var "af" : !hl.lvalue<memref<10xf32>>
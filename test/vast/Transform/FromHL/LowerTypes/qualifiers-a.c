@@ -0,0 +1,20 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types | FileCheck %s
+// REQUIRES: type-lowering
+
+// CHECK: func @read(%arg0: !hl.lvalue<!hl.ptr<i32>> {llvm.readonly}) -> i32
+int read(const int *p) { return *p; }
+
+// CHECK: func @escape(%arg0: !hl.lvalue<!hl.ptr<i32>>) -> !hl.ptr<i32>
+int *escape(const int *p) { return (int *)p; }
+
+// CHECK: func @write(%arg0: !hl.lvalue<!hl.ptr<i32>>)
+void write(int *p) { *p = 0; }
+
+// CHECK-LABEL: func @access
+void access(volatile int *p)
+{
+    // CHECK: hl.implicit_cast {{.*}} LValueToRValue {hl.volatile}
+    int v = *p;
+    // CHECK: hl.assign {{.*}} {hl.volatile}
+    *p = v;
+}
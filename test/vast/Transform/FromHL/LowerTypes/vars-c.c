@@ -12,7 +12,7 @@ int main()
     // CHECK:   [[V2:%[0-9]+]] = hl.const #hl.integer<0> : i32
     // CHECK:   hl.value.yield [[V2]] : i32
     const int cx = 0;
-    // CHECK: hl.var "cvx" : !hl.lvalue<i32> =  {
+    // CHECK: hl.var "cvx" {hl.volatile} : !hl.lvalue<i32> =  {
     // CHECK:   [[V3:%[0-9]+]] = hl.const #hl.integer<0> : i32
     // CHECK:   hl.value.yield [[V3]] : i32
     const volatile int cvx = 0;
@@ -0,0 +1,44 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-profile-annotate="profile=%S/Inputs/profile-a.proftext" | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-profile-annotate="profile=%S/Inputs/profile-a.proftext" --vast-llvm-dump | FileCheck %s -check-prefix=LLVM
+
+// CHECK-LABEL: func @count
+// CHECK-SAME: hl.entry_count = 10 : i64
+// LLVM-LABEL: define i32 @count
+// LLVM-SAME: !prof [[COUNT_ENTRY:![0-9]+]]
+int count(int *data, int n)
+{
+    int s = 0;
+    // CHECK: hl.for {
+    // CHECK: } incr {
+    // CHECK: } {hl.branch_weights = [1001 : i32, 11 : i32]} do {
+    // LLVM: br i1 {{%[0-9a-z.]+}}, label %for.body, label %for.end, !prof [[FOR:![0-9]+]]
+    for (int i = 0; i < n; ++i) {
+        // CHECK: hl.if {
+        // CHECK: } {hl.branch_weights = [251 : i32, 751 : i32]}
+        // LLVM: br i1 {{%[0-9a-z.]+}}, label %if.then, label %if.end, !prof [[IF:![0-9]+]]
+        if (data[i] > 0)
+            s += data[i];
+    }
+    return s;
+}
+
+// CHECK-LABEL: func @classify
+// CHECK-SAME: hl.entry_count = 100 : i64
+// LLVM-LABEL: define i32 @classify
+int classify(int v)
+{
+    // CHECK: hl.switch {
+    // CHECK: } {hl.branch_weights = [11 : i32, 61 : i32, 31 : i32]}
+    // LLVM: switch i32 {{%[0-9a-z.]+}}, label %sw.default [
+    // LLVM: ], !prof [[SWITCH:![0-9]+]]
+    switch (v) {
+        case 0: return 10;
+        case 1: return 20;
+        default: return 30;
+    }
+}
+
+// LLVM: [[COUNT_ENTRY]] = !{!"function_entry_count", i64 10}
+// LLVM: [[FOR]] = !{!"branch_weights", i32 1001, i32 11}
+// LLVM: [[IF]] = !{!"branch_weights", i32 251, i32 751}
+// LLVM: [[SWITCH]] = !{!"branch_weights", i32 11, i32 61, i32 31}
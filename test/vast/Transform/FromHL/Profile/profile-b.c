@@ -0,0 +1,15 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-profile-annotate="profile=%S/Inputs/profile-b.proftext" | FileCheck %s
+
+// Counts above the range of signed 32 bit weights are scaled down.
+// CHECK-LABEL: func @count
+int count(int *data, int n)
+{
+    int s = 0;
+    // CHECK: } {hl.branch_weights = [1500000001 : i32, 6 : i32]} do {
+    for (int i = 0; i < n; ++i) {
+        // CHECK: } {hl.branch_weights = [1000000001 : i32, 2000000001 : i32]}
+        if (data[i] > 0)
+            s += data[i];
+    }
+    return s;
+}
@@ -0,0 +1,53 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-affine | FileCheck %s
+
+// CHECK-LABEL: func @shift
+void shift(void)
+{
+    // CHECK: [[B:%[0-9]+]] = memref.alloca() : memref<64xf32>
+    // CHECK: [[A:%[0-9]+]] = memref.alloca() : memref<64xf32>
+    float a[64], b[64];
+    // CHECK-NOT: hl.for
+    // CHECK: affine.for [[I:%arg[0-9]+]] = 0 to 63 {
+    // CHECK:   [[V:%[0-9]+]] = affine.load [[B]]{{\[}}[[I]] + 1] : memref<64xf32>
+    // CHECK:   [[W:%[0-9]+]] = hl.fmul {{%[0-9]+}}, [[V]] : f32
+    // CHECK:   affine.store [[W]], [[A]]{{\[}}[[I]]] : memref<64xf32>
+    // CHECK: }
+    for (int i = 0; i < 63; ++i)
+        a[i] = 2.0f * b[i + 1];
+}
+
+// CHECK-LABEL: func @transpose
+void transpose(void)
+{
+    // CHECK: [[T:%[0-9]+]] = memref.alloca() : memref<8x8xi32>
+    // CHECK: [[M:%[0-9]+]] = memref.alloca() : memref<8x8xi32>
+    int m[8][8], t[8][8];
+    // CHECK: affine.for [[I:%arg[0-9]+]] = 0 to 8 {
+    // CHECK:   affine.for [[J:%arg[0-9]+]] = 0 to 8 step 2 {
+    // CHECK:     [[V:%[0-9]+]] = affine.load [[M]]{{\[}}[[I]], [[J]]] : memref<8x8xi32>
+    // CHECK:     affine.store [[V]], [[T]]{{\[}}[[J]], [[I]]] : memref<8x8xi32>
+    for (int i = 0; i < 8; ++i)
+        for (int j = 0; j < 8; j += 2)
+            t[j][i] = m[i][j];
+}
+
+void consume(int *data);
+
+// CHECK-LABEL: func @squares
+int squares(void)
+{
+    // The address of the array escapes.
+    // CHECK: hl.var "escaped"
+    int escaped[4];
+    consume(escaped);
+
+    int lut[16];
+    // CHECK: affine.for [[I:%arg[0-9]+]] = 0 to 4 {
+    // CHECK:   [[IDX:%[0-9]+]] = arith.index_cast {{%[0-9]+}} : i32 to index
+    // CHECK:   memref.store {{%[0-9]+}}, [[LUT:%[0-9]+]]{{\[}}[[IDX]]] : memref<16xi32>
+    for (int i = 0; i < 4; ++i)
+        lut[i * i] = i;
+
+    // CHECK: affine.load [[LUT]][1] : memref<16xi32>
+    return lut[1];
+}
@@ -0,0 +1,37 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-affine | FileCheck %s
+
+// Variables without a storage class specifier have local storage.
+// CHECK-LABEL: func @plain
+void plain(void)
+{
+    // CHECK: [[A:%[0-9]+]] = memref.alloca() : memref<8xi32>
+    int a[8];
+    // CHECK: affine.for [[I:%arg[0-9]+]] = 0 to 8 {
+    // CHECK:   affine.store {{%[0-9]+}}, [[A]]{{\[}}[[I]]] : memref<8xi32>
+    for (int i = 0; i < 8; ++i)
+        a[i] = 1;
+}
+
+// CHECK-LABEL: func @automatic
+void automatic(void)
+{
+    // CHECK: [[A:%[0-9]+]] = memref.alloca() : memref<8xi32>
+    register int a[8];
+    // CHECK: affine.for [[I:%arg[0-9]+]] = 0 to 8 {
+    // CHECK:   affine.store {{%[0-9]+}}, [[A]]{{\[}}[[I]]] : memref<8xi32>
+    for (register int i = 0; i < 8; ++i)
+        a[i] = 1;
+}
+
+// CHECK-LABEL: func @persistent
+void persistent(void)
+{
+    // CHECK-NOT: memref.alloca
+    // CHECK: hl.var "a" sc_static
+    static int a[8];
+    // CHECK: affine.for [[I:%arg[0-9]+]] = 0 to 8 {
+    // CHECK:   hl.subscript
+    // CHECK-NOT: affine.store
+    for (int i = 0; i < 8; ++i)
+        a[i] = 1;
+}
@@ -0,0 +1,39 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-cf | FileCheck %s
+
+// Pointer conditions are compared against null.
+// CHECK-LABEL: func @length
+int length(const char *s)
+{
+    int n = 0;
+    // CHECK: [[Z:%[0-9]+]] = hl.const {{.*}}0{{.*}} : i32
+    // CHECK: [[N:%[0-9]+]] = hl.implicit_cast [[Z]] NullToPointer : i32 -> !hl.ptr<
+    // CHECK: [[C:%[0-9]+]] = hl.cmp ne {{%[0-9]+}}, [[N]] : !hl.ptr<{{.*}}> -> i1
+    // CHECK: cf.cond_br [[C]]
+    if (s)
+        // CHECK: [[Z:%[0-9]+]] = hl.const {{.*}}0{{.*}} : i32
+        // CHECK: [[N:%[0-9]+]] = hl.implicit_cast [[Z]] NullToPointer
+        // CHECK: [[C:%[0-9]+]] = hl.cmp ne {{%[0-9]+}}, [[N]]
+        // CHECK: cf.cond_br [[C]]
+        while (s) {
+            s = 0;
+            ++n;
+        }
+    return n;
+}
+
+// Floating point conditions are compared against zero, unordered.
+// CHECK-LABEL: func @nonzero
+int nonzero(float f, double d)
+{
+    // CHECK: [[Z:%[a-z0-9_]+]] = arith.constant 0.000000e+00 : f32
+    // CHECK: [[C:%[a-z0-9_]+]] = arith.cmpf une, {{%[0-9]+}}, [[Z]] : f32
+    // CHECK: cf.cond_br [[C]]
+    if (f)
+        return 1;
+    // CHECK: [[Z:%[a-z0-9_]+]] = arith.constant 0.000000e+00 : f64
+    // CHECK: [[C:%[a-z0-9_]+]] = arith.cmpf une, {{%[0-9]+}}, [[Z]] : f64
+    // CHECK: cf.cond_br [[C]]
+    while (d)
+        d = d / 2;
+    return 0;
+}
@@ -0,0 +1,52 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-cf | FileCheck %s
+
+// CHECK-LABEL: func @retry
+int retry(int n)
+{
+    // CHECK-NOT: hl.label
+    // CHECK: cf.br ^[[AGAIN:bb[0-9]+]]
+    int tries = 0;
+    // CHECK: ^[[AGAIN]]:
+    // CHECK:   hl.pre.inc
+again:
+    ++tries;
+    // CHECK:   [[C:%[0-9]+]] = hl.cmp ne {{%[0-9]+}}, {{%[0-9]+}} : i32, i32 -> i1
+    // CHECK:   cf.cond_br [[C]], ^[[THEN:bb[0-9]+]], ^[[CONT:bb[0-9]+]]
+    // CHECK: ^[[THEN]]:
+    // CHECK:   cf.br ^[[AGAIN]]
+    if (tries < n)
+        goto again;
+    // CHECK: ^[[CONT]]:
+    // CHECK:   hl.return
+    return tries;
+}
+
+// CHECK-LABEL: func @find
+int find(int *data, int n, int key)
+{
+    int i = 0;
+    // CHECK-NOT: hl.while
+    // CHECK: cf.br ^[[COND:bb[0-9]+]]
+    // CHECK: ^[[COND]]:
+    // CHECK:   cf.cond_br {{%[0-9]+}}, ^[[BODY:bb[0-9]+]], ^[[EXIT:bb[0-9]+]]
+    // CHECK: ^[[BODY]]:
+    while (i < n) {
+        // CHECK: cf.cond_br {{%[0-9]+}}, ^[[SKIP:bb[0-9]+]]
+        // CHECK: ^[[SKIP]]:
+        // CHECK:   hl.pre.inc
+        // CHECK:   cf.br ^[[COND]]
+        if (data[i] == 0) {
+            ++i;
+            continue;
+        }
+        // CHECK: cf.cond_br {{%[0-9]+}}, ^[[FOUND:bb[0-9]+]]
+        // CHECK: ^[[FOUND]]:
+        // CHECK:   cf.br ^[[EXIT]]
+        if (data[i] == key)
+            break;
+        ++i;
+    }
+    // CHECK: ^[[EXIT]]:
+    // CHECK:   hl.return
+    return i;
+}
@@ -0,0 +1,39 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-cf | FileCheck %s
+
+// Uninitialized locals are hoisted to the function entry.
+// CHECK-LABEL: func @loop
+int loop(int n)
+{
+    // CHECK: hl.var "tmp" : !hl.lvalue<i32>
+    // CHECK: hl.var "sum"
+    int sum = 0;
+    // CHECK: cf.br
+    // CHECK-NOT: hl.var "tmp"
+    // CHECK: hl.return
+    for (int i = 0; i < n; ++i) {
+        int tmp;
+        tmp = i * i;
+        sum += tmp;
+    }
+    return sum;
+}
+
+// CHECK-LABEL: func @cases
+int cases(int c)
+{
+    // CHECK: hl.var "v" : !hl.lvalue<i32>
+    // CHECK: cf.switch
+    // CHECK-NOT: hl.var "v"
+    // CHECK: hl.return
+    switch (c) {
+        case 0:;
+            int v;
+            v = c + 1;
+            return v;
+        case 1:
+            v = 2;
+            return v;
+        default:
+            return 0;
+    }
+}
@@ -0,0 +1,17 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll | FileCheck %s
+
+// CHECK: llvm.mlir.global external @counter({{.*}}alignment = 64 : i64{{.*}}section = ".data.hot"{{.*}} : i32
+int counter __attribute__((aligned(64), section(".data.hot")));
+
+// CHECK: llvm.func @hot_path() attributes {{.*}}hl.section = ".text.hot", passthrough = ["noinline", "hot"]}
+__attribute__((hot, noinline, section(".text.hot"))) void hot_path(void) {}
+
+// CHECK: llvm.func @square({{.*}}) -> i32 attributes {{.*}}passthrough = ["alwaysinline", "readnone", "nounwind"]}
+__attribute__((always_inline, const)) int square(int x) { return x * x; }
+
+// CHECK-LABEL: llvm.func @local
+void local(void)
+{
+    // CHECK: llvm.alloca {{%[0-9]+}} x i32 {alignment = 32 : i64} : (i64) -> !llvm.ptr<i32>
+    int x __attribute__((aligned(32))) = 0;
+}
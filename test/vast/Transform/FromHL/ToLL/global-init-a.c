@@ -0,0 +1,4 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | (vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll 2>&1 >/dev/null || true) | FileCheck %s
+
+// CHECK: error: unsupported aggregate initializer of global
+int table[3] = { 1, 2, 3 };
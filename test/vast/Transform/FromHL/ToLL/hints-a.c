@@ -0,0 +1,37 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-profile-annotate="profile=%S/Inputs/hints-a.proftext" --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-cf --vast-hl-to-ll --convert-cf-to-llvm --vast-llvm-dump | FileCheck %s
+
+// Branch weights and loop hints survive the lowering through cf and llvm
+// dialects as `!prof` and `!llvm.loop` metadata.
+
+// CHECK-LABEL: define i32 @count
+int count(int n)
+{
+    int s = 0;
+    // CHECK: br i1 {{%[0-9]+}}, label {{%[0-9]+}}, label {{%[0-9]+}}, !prof [[FOR:![0-9]+]]
+    // CHECK: br i1 {{%[0-9]+}}, label {{%[0-9]+}}, label {{%[0-9]+}}, !prof [[IF:![0-9]+]]
+    // CHECK: br label {{%[0-9]+}}, !llvm.loop [[LOOP:![0-9]+]]
+    #pragma clang loop unroll_count(4)
+    for (int i = 0; i < n; i = i + 1) {
+        if (i > 3)
+            s += i;
+    }
+    return s;
+}
+
+// CHECK-LABEL: define i32 @classify
+int classify(int v)
+{
+    // CHECK: switch i32 {{%[0-9]+}}, label {{%[0-9]+}} [
+    // CHECK: ], !prof [[SWITCH:![0-9]+]]
+    switch (v) {
+        case 0: return 10;
+        case 1: return 20;
+        default: return 30;
+    }
+}
+
+// CHECK-DAG: [[FOR]] = !{!"branch_weights", i32 1001, i32 11}
+// CHECK-DAG: [[IF]] = !{!"branch_weights", i32 251, i32 751}
+// CHECK-DAG: [[LOOP]] = distinct !{[[LOOP]], [[COUNT:![0-9]+]]}
+// CHECK-DAG: [[COUNT]] = !{!"llvm.loop.unroll.count", i32 4}
+// CHECK-DAG: [[SWITCH]] = !{!"branch_weights", i32 11, i32 61, i32 31}
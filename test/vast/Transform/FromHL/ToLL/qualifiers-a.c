@@ -0,0 +1,22 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll | FileCheck %s
+
+// CHECK: llvm.mlir.global external constant @limit() : i32
+const int limit = 10;
+
+// CHECK: llvm.mlir.global internal @counter(0 : i32) : i32
+static int counter;
+
+// CHECK: llvm.func @copy(%arg0: !llvm.ptr<i32> {llvm.noalias}, %arg1: !llvm.ptr<i32> {llvm.noalias})
+void copy(int * restrict dst, int * restrict src)
+{
+}
+
+// CHECK-LABEL: llvm.func @poll
+void poll(int v)
+{
+    // CHECK: llvm.store volatile {{.*}} : !llvm.ptr<i32>
+    volatile int flag = v;
+    // CHECK: llvm.load volatile {{.*}} : !llvm.ptr<i32>
+    // CHECK: llvm.mlir.addressof @counter : !llvm.ptr<i32>
+    counter = flag;
+}
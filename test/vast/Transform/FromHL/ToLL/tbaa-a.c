@@ -0,0 +1,22 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll="strict-aliasing=false" | FileCheck %s --check-prefix=NO-STRICT
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll --vast-llvm-dump | FileCheck %s --check-prefix=LLVM
+
+// NO-STRICT-NOT: hl.tbaa
+
+// CHECK: llvm.func @access
+void access(int i, char c, double d)
+{
+    // CHECK: llvm.store {{.*}} {hl.tbaa = "int32"} : !llvm.ptr<i32>
+    int x = i;
+    // CHECK: llvm.store {{.*}} {hl.tbaa = "omnipotent char"} : !llvm.ptr<i8>
+    char y = c;
+    // CHECK: llvm.store {{.*}} {hl.tbaa = "float64"} : !llvm.ptr<f64>
+    double z = d;
+}
+
+// LLVM: store i32 {{.*}}, !tbaa [[INT:![0-9]+]]
+// LLVM: [[INT]] = !{[[INT_TY:![0-9]+]], [[INT_TY]], i64 0}
+// LLVM: [[INT_TY]] = !{!"int32", [[CHAR:![0-9]+]], i64 0}
+// LLVM: [[CHAR]] = !{!"omnipotent char", [[ROOT:![0-9]+]], i64 0}
+// LLVM: [[ROOT]] = !{!"VAST C TBAA"}
@@ -0,0 +1,22 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-ll | FileCheck %s
+
+// CHECK: llvm.func @scoped([[ARG:%arg[0-9]+]]: i32)
+void scoped(int arg)
+{
+    // CHECK: [[C:%[0-9]+]] = llvm.mlir.constant(1 : index) : i64
+    // CHECK: [[ADDR:%[0-9]+]] = llvm.alloca [[C]] x i32 : (i64) -> !llvm.ptr<i32>
+    // CHECK: llvm.store [[ARG]], [[ADDR]] : !llvm.ptr<i32>
+
+    // CHECK: [[V0:%[0-9]+]] = llvm.mlir.constant(1 : index) : i64
+    // CHECK: [[X:%[0-9]+]] = llvm.alloca [[V0]] x i32 : (i64) -> !llvm.ptr<i32>
+    // CHECK-NOT: hl.scope
+    {
+        // CHECK: [[S:%[0-9]+]] = llvm.mlir.constant(4 : i64) : i64
+        // CHECK: llvm.intr.lifetime.start [[S]], [[X]]
+        // CHECK: [[V1:%[0-9]+]] = llvm.load [[ADDR]] {hl.tbaa = "int32"} : !llvm.ptr<i32>
+        // CHECK: llvm.store [[V1]], [[X]] {hl.tbaa = "int32"} : !llvm.ptr<i32>
+        // CHECK: llvm.intr.lifetime.end [[S]], [[X]]
+        int x = arg;
+    }
+    // CHECK: llvm.return
+}
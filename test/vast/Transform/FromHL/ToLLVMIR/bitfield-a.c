@@ -0,0 +1,9 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | (vast-opt --vast-llvm-dump 2>&1 >/dev/null || true) | FileCheck %s
+
+// CHECK: error: unsupported bit-field in translation to llvm ir
+struct flags {
+    unsigned ready : 1;
+    unsigned mode : 3;
+};
+
+struct flags state;
@@ -0,0 +1,33 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-llvm-dump | FileCheck %s
+
+// CHECK: @total = global i32 0
+int total;
+
+// CHECK: declare i32 @add(i32, i32)
+int add(int a, int b);
+
+// CHECK-LABEL: define i32 @sum
+int sum(int *data, int n)
+{
+    // CHECK: entry:
+    // CHECK: alloca i32
+    int s = 0;
+    int i = 0;
+    // CHECK: br label %while.cond
+    // CHECK: while.cond:
+    // CHECK:   br i1 {{%[0-9a-z.]+}}, label %while.body, label %while.end
+    while (i < n) {
+        // CHECK: while.body:
+        // CHECK:   call i32 @add
+        s = add(s, data[i]);
+        // CHECK: if.then:
+        if (s > 100)
+            break;
+        ++i;
+    }
+    // CHECK: while.end:
+    // CHECK:   store i32 {{%[0-9]+}}, {{.*}} @total
+    total = s;
+    // CHECK:   ret i32
+    return s;
+}
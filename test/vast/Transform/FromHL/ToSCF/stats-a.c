@@ -0,0 +1,34 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-scf -mlir-pass-statistics 2>&1 >/dev/null | FileCheck %s --check-prefix=STAT
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-scf --vast-ir-stats=text 2>&1 >/dev/null | FileCheck %s --check-prefix=TEXT
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-scf --vast-ir-stats=json --vast-ir-stats-file=%t.json
+// RUN: FileCheck %s --check-prefix=JSON < %t.json
+
+// STAT: HLLowerTypes
+// STAT: (S) {{[1-9][0-9]*}} ops-lowered
+// STAT: (S) {{[1-9][0-9]*}} types-lowered
+// STAT: HLToSCF
+// STAT: (S) 2 ops-converted
+// STAT: (S) 0 switches-kept
+// STAT: (S) 0 switches-lowered
+
+// TEXT: pass {{ +}}ops before {{ +}}ops after
+// TEXT: vast-hl-lower-types
+// TEXT:   dialect  hl
+// TEXT: vast-hl-to-scf
+// TEXT:   dialect  scf {{ +}}0 {{ +}}{{[1-9][0-9]*}}
+// TEXT:   op {{ +}}hl.if {{ +}}1 {{ +}}0 {{ +}}-1
+// TEXT:   op {{ +}}hl.while {{ +}}1 {{ +}}0 {{ +}}-1
+
+// JSON: "pass": "vast-hl-lower-types"
+// JSON: "pass": "vast-hl-to-scf"
+
+int fn(int n)
+{
+    int s = 0;
+    while (n) {
+        if (n > 10)
+            s = s + n;
+        n = n - 1;
+    }
+    return s;
+}
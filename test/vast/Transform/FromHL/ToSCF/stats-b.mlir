@@ -0,0 +1,25 @@
+// RUN: vast-opt %s --split-input-file --canonicalize --vast-ir-stats=json --vast-ir-stats-file=%t.json
+// RUN: FileCheck %s < %t.json
+// RUN: vast-opt --show-dialects | FileCheck %s --check-prefix=DIALECTS
+
+// Chunks of a split input are reported in a single json array.
+// CHECK: [
+// CHECK-NOT: ]
+// CHECK: "pass": "canonicalize"
+// CHECK-NOT: [
+// CHECK: "pass": "canonicalize"
+// CHECK: ]
+// CHECK-NOT: [
+
+// DIALECTS: Available Dialects:
+// DIALECTS: hl
+
+func.func @first() {
+  return
+}
+
+// -----
+
+func.func @second() {
+  return
+}
@@ -0,0 +1,64 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-structs-to-tuples --vast-hl-to-scf | FileCheck %s
+
+// CHECK-LABEL: func @dispatch
+int dispatch(int op, int acc)
+{
+    // CHECK: scf.execute_region {
+    // CHECK:   cf.switch {{%[0-9]+}} : i32, [
+    // CHECK:     default: ^[[DEFAULT:bb[0-9]+]],
+    // CHECK:     0: ^[[ADD:bb[0-9]+]],
+    // CHECK:     1: ^[[SUB:bb[0-9]+]],
+    // CHECK:     2: ^[[SUB]],
+    // CHECK:     3: ^[[HALT:bb[0-9]+]]
+    // CHECK:   ]
+    // CHECK-NOT: hl.cmp
+    switch (op) {
+        // CHECK: ^[[ADD]]:
+        // CHECK:   hl.assign.add
+        // CHECK:   cf.br ^[[SUB]]
+        case 0: acc += 1;
+        // CHECK: ^[[SUB]]:
+        // CHECK:   hl.assign.sub
+        // CHECK:   cf.br ^[[EXIT:bb[0-9]+]]
+        case 1:
+        case 2: {
+            acc -= 1;
+            break;
+        }
+        // CHECK: ^[[HALT]]:
+        // CHECK:   hl.return
+        case 3: return acc;
+        // CHECK: ^[[DEFAULT]]:
+        // CHECK:   cf.br ^[[EXIT]]
+        default: break;
+    }
+    // CHECK: ^[[EXIT]]:
+    // CHECK:   scf.yield
+    // CHECK: }
+    return acc;
+}
+
+// Jumps out of statements nested in a case keep the switch structured.
+// CHECK-LABEL: func @search
+int search(int op, int n)
+{
+    // CHECK: scf.execute_region {
+    // CHECK:   cf.switch {{%[0-9]+}} : i32, [
+    switch (op) {
+        // CHECK: hl.for {
+        // CHECK:   hl.break
+        // CHECK: }
+        // CHECK: cf.br ^[[EXIT:bb[0-9]+]]
+        case 0:
+            for (int i = 0; i < n; ++i) {
+                n -= i;
+                break;
+            }
+            break;
+        default:
+            n = 0;
+    }
+    // CHECK: ^[[EXIT]]:
+    // CHECK:   scf.yield
+    return n;
+}
@@ -0,0 +1,20 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --canonicalize | FileCheck %s
+
+__attribute__((const)) int square(int x);
+__attribute__((pure)) int lookup(int x);
+int impure(int x);
+
+// CHECK-LABEL: func @unused
+void unused(int a, volatile int v)
+{
+    // CHECK-NOT: hl.call @square
+    square(a);
+    // CHECK-NOT: hl.call @lookup
+    lookup(a);
+    // CHECK: hl.call @impure
+    impure(a);
+    // CHECK: hl.implicit_cast {{.*}} LValueToRValue : !hl.lvalue<!hl.int< volatile >>
+    v;
+    // CHECK-NOT: hl.implicit_cast
+    a;
+}
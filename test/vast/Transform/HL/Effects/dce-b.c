@@ -0,0 +1,71 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --canonicalize | FileCheck %s
+
+// CHECK-LABEL: func @early
+int early(int c, int x)
+{
+    // CHECK: hl.if {
+    // CHECK: } then {
+    // CHECK: [[X:%[0-9]+]] = hl.implicit_cast {{%[0-9]+}} LValueToRValue
+    // CHECK: hl.return [[X]]
+    // CHECK: }
+    // CHECK: hl.return
+    if (c)
+        return x;
+    return 0;
+}
+
+// CHECK-LABEL: func @early_void
+void early_void(int c, int *p)
+{
+    // CHECK: hl.if {
+    // CHECK: } then {
+    // CHECK: hl.return
+    // CHECK: }
+    if (c)
+        return;
+    *p = c;
+}
+
+// CHECK-LABEL: func @loop
+void loop(int n)
+{
+    // CHECK: hl.while {
+    // CHECK: hl.if {
+    // CHECK: hl.break
+    while (1) {
+        if (n)
+            break;
+    }
+
+    // CHECK: hl.for {
+    // CHECK: hl.if {
+    // CHECK: hl.continue
+    for (int i = 0; i < n; i++) {
+        if (i)
+            continue;
+    }
+}
+
+// CHECK-LABEL: func @fallthrough
+int fallthrough(int c)
+{
+    int r = 0;
+    // CHECK: hl.switch {
+    // CHECK: hl.case {
+    // CHECK: hl.default {
+    switch (c) {
+        case 1: ;
+        default: r = 1;
+    }
+    return r;
+}
+
+// CHECK-LABEL: func @jump
+void jump(int c)
+{
+    // CHECK: hl.goto
+    if (c)
+        goto end;
+    // CHECK: hl.label
+end: ;
+}
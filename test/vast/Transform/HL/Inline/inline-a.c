@@ -0,0 +1,24 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --inline | FileCheck %s
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-inline | FileCheck %s
+
+static int square(int x) { return x * x; }
+
+__attribute__((noinline)) static int cube(int x) { return x * x * x; }
+
+static int sign(int x) {
+    if (x < 0)
+        return -1;
+    return 1;
+}
+
+// CHECK-LABEL: func @main
+int main()
+{
+    // CHECK-NOT: hl.call @square
+    // CHECK: hl.var "param" : !hl.lvalue<!hl.int> = {
+    // CHECK: [[SQUARE:%[0-9]+]] = hl.mul
+    // CHECK: [[CUBE:%[0-9]+]] = hl.call @cube
+    // CHECK: hl.add [[SQUARE]], [[CUBE]] : !hl.int
+    // CHECK: hl.call @sign
+    return square(3) + cube(2) + sign(-5);
+}
@@ -0,0 +1,16 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-inline="size-threshold=4" | FileCheck %s
+
+static int square(int x) { return x * x; }
+
+__attribute__((always_inline)) static inline int twice(int x) { return x + x; }
+
+// Functions above the threshold are inlined only when marked always_inline.
+// CHECK-LABEL: func @main
+int main()
+{
+    // CHECK: [[SQUARE:%[0-9]+]] = hl.call @square
+    // CHECK-NOT: hl.call @twice
+    // CHECK: [[TWICE:%[0-9]+]] = hl.add
+    // CHECK: hl.add [[SQUARE]], [[TWICE]] : !hl.int
+    return square(3) + twice(2);
+}
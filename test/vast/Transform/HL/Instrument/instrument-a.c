@@ -0,0 +1,44 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-instrument | FileCheck %s
+
+// CHECK: hl.var "__vast_prof_counters" : !hl.lvalue<!hl.array<5, !hl.longlong< unsigned >>>
+// CHECK: hl.var "__vast_prof_names" : !hl.lvalue<!hl.ptr<!hl.char>>
+// CHECK:   hl.const #hl.str<"sum 3 pick 2">
+
+// CHECK-LABEL: func @sum
+int sum(int *data, int n)
+{
+    // CHECK: hl.globref "__vast_prof_counters"
+    // CHECK: hl.const #hl.integer<0> : !hl.int
+    // CHECK: hl.pre.inc
+    int s = 0;
+    // CHECK: hl.for {
+    // CHECK: } do {
+    // CHECK:   hl.const #hl.integer<1> : !hl.int
+    // CHECK:   hl.pre.inc
+    for (int i = 0; i < n; ++i) {
+        // CHECK: hl.if {
+        // CHECK: } then {
+        // CHECK:   hl.const #hl.integer<2> : !hl.int
+        // CHECK:   hl.pre.inc
+        if (data[i] > 0)
+            s += data[i];
+    }
+    return s;
+}
+
+// CHECK-LABEL: func @pick
+int pick(int v)
+{
+    // CHECK: hl.const #hl.integer<3> : !hl.int
+    // CHECK: hl.pre.inc
+    // Only the backedge of do is counted.
+    // CHECK: hl.const #hl.integer<4> : !hl.int
+    // CHECK: hl.pre.dec
+    // CHECK: hl.do {
+    // CHECK:   hl.const #hl.integer<4> : !hl.int
+    // CHECK:   hl.pre.inc
+    do {
+        --v;
+    } while (v > 0);
+    return v;
+}
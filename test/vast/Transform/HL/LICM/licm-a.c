@@ -0,0 +1,19 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-licm | FileCheck %s
+
+struct point { int x, y; };
+
+// CHECK-LABEL: func @accumulate
+void accumulate(struct point p, int n, int d)
+{
+    // CHECK: hl.const #hl.integer<10>
+    // CHECK: [[P:%[0-9]+]] = hl.ref %arg0
+    // CHECK: hl.member [[P]] at "x"
+    // CHECK: hl.while {
+    // CHECK-NOT: hl.const #hl.integer<10>
+    // CHECK-NOT: hl.member
+    // CHECK: hl.sdiv
+    while (n < 10) {
+        p.x += n / d;
+        n++;
+    }
+}
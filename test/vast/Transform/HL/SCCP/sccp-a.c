@@ -0,0 +1,103 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-sccp | FileCheck %s
+
+#define FEATURE_X 0
+
+void log_value(int v);
+
+// CHECK-LABEL: func @configured
+int configured(int v)
+{
+    int verbose = 1;
+
+    // CHECK-NOT: hl.var "verbose"
+    // CHECK-NOT: hl.if
+    // CHECK-NOT: hl.call @log_value
+    if (FEATURE_X && v) {
+        log_value(v);
+    }
+
+    // CHECK: hl.call @log_value
+    if (!FEATURE_X && verbose) {
+        log_value(1);
+    } else {
+        log_value(2);
+    }
+
+    // CHECK-NOT: hl.do
+    // CHECK: hl.post.inc
+    do {
+        v++;
+    } while (0);
+
+    // CHECK-NOT: hl.while
+    // CHECK-NOT: hl.call @log_value
+    while (FEATURE_X) {
+        log_value(3);
+    }
+
+    // CHECK: hl.return
+    return v;
+}
+
+// Values merged from different branches are constant only if they agree.
+// CHECK-LABEL: func @assigned
+int assigned(int c)
+{
+    // CHECK: hl.var "x"
+    int x = 1;
+    if (c)
+        x = 2;
+    // CHECK: hl.return
+    return x;
+}
+
+// CHECK-LABEL: func @agreed
+int agreed(int c)
+{
+    // CHECK-NOT: hl.var "x"
+    int x = 1;
+    if (c)
+        x = 2;
+    else
+        x = 2;
+    // CHECK: [[C:%[0-9]+]] = hl.const #hl.integer<2>
+    // CHECK: hl.return [[C]]
+    return x;
+}
+
+int poll(void);
+
+// CHECK-LABEL: func @looped
+void looped(void)
+{
+    // CHECK-NOT: hl.var "step"
+    int step = 4;
+    // The value of first differs on the back edge of the loop.
+    // CHECK: hl.var "first"
+    int first = 1;
+    // CHECK: hl.while
+    while (poll()) {
+        // CHECK: hl.if
+        if (first)
+            log_value(0);
+        // CHECK: hl.const #hl.integer<4>
+        // CHECK: hl.call @log_value
+        log_value(step);
+        first = 0;
+    }
+}
+
+// CHECK-LABEL: func @switched
+int switched(int v)
+{
+    // CHECK-NOT: hl.var "r"
+    int r = 0;
+    switch (v) {
+        case 1: r = 5; break;
+        case 2: r = 5; break;
+        default: r = 5;
+    }
+    // CHECK: [[C:%[0-9]+]] = hl.const #hl.integer<5>
+    // CHECK: hl.return [[C]]
+    return r;
+}
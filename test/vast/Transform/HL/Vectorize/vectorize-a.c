@@ -0,0 +1,35 @@
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-affine --vast-hl-vectorize | FileCheck %s --check-prefixes=CHECK,AVX2
+// RUN: vast-cc --ccopts -xc --from-source %s | vast-opt --vast-hl-lower-types --vast-hl-to-affine --vast-hl-vectorize=vector-bits=512 | FileCheck %s --check-prefixes=CHECK,AVX512
+
+// CHECK-LABEL: func @saxpy
+void saxpy(void)
+{
+    float x[100], y[100];
+    // AVX2:   affine.for [[I:%arg[0-9]+]] = 0 to 96 step 8 {
+    // AVX512: affine.for [[I:%arg[0-9]+]] = 0 to 96 step 16 {
+    // AVX2:     [[X:%[0-9]+]] = vector.load {{%[0-9]+}}{{\[}}{{%[0-9]+}}] : memref<100xf32>, vector<8xf32>
+    // AVX512:   [[X:%[0-9]+]] = vector.load {{%[0-9]+}}{{\[}}{{%[0-9]+}}] : memref<100xf32>, vector<16xf32>
+    // CHECK:    [[A:%[0-9]+]] = vector.broadcast {{%[0-9]+}} : f32 to vector<{{8|16}}xf32>
+    // CHECK:    [[AX:%[0-9]+]] = arith.mulf [[A]], [[X]] : vector<{{8|16}}xf32>
+    // CHECK:    [[Y:%[0-9]+]] = vector.load
+    // CHECK:    [[R:%[0-9]+]] = arith.addf [[AX]], [[Y]] : vector<{{8|16}}xf32>
+    // CHECK:    vector.store [[R]], {{%[0-9]+}}{{\[}}{{%[0-9]+}}] : memref<100xf32>, vector<{{8|16}}xf32>
+    // CHECK:  }
+    // CHECK:  affine.for {{%arg[0-9]+}} = 96 to 100 {
+    // CHECK:    hl.fmul
+    // CHECK:    affine.store
+    // CHECK:  }
+    for (int i = 0; i < 100; ++i)
+        y[i] = 3.0f * x[i] + y[i];
+}
+
+// CHECK-LABEL: func @prefix
+void prefix(void)
+{
+    int a[64], b[64];
+    // The loop reads an element written by the previous iteration.
+    // CHECK-NOT: vector.
+    // CHECK: affine.for {{%arg[0-9]+}} = 1 to 64 {
+    for (int i = 1; i < 64; ++i)
+        a[i] = a[i - 1] + b[i];
+}
@@ -0,0 +1,28 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+// Straight-line integer and floating point arithmetic. The benchmark
+// instantiates `VAST_BENCH_UNIT` once per unit of the requested scale.
+
+#define VAST_BENCH_UNIT(id)                                         \
+    int poly_##id(int x) {                                          \
+        int a = x * x;                                              \
+        int b = a * x + 3 * a - 7 * x + 11;                         \
+        b += a;                                                     \
+        b -= x;                                                     \
+        return b % 1024;                                            \
+    }                                                               \
+                                                                    \
+    unsigned bits_##id(unsigned x, unsigned y) {                    \
+        unsigned z = (x & y) | (x ^ y);                             \
+        z = (z << 3) | (z >> 29);                                   \
+        return ~z & 0xffff;                                         \
+    }                                                               \
+                                                                    \
+    double mix_##id(double x, int n) {                              \
+        double y = x * 0.5 + n;                                     \
+        return y * y - x / (n + 1);                                 \
+    }                                                               \
+                                                                    \
+    int cmp_##id(int a, int b) {                                    \
+        return (a < b) + (a <= b) + (a == b) + (a != b);            \
+    }
@@ -0,0 +1,43 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+// Nested loops, conditionals, switches and calls over local arrays. The
+// benchmark instantiates `VAST_BENCH_UNIT` once per unit of the requested
+// scale.
+
+#define VAST_BENCH_UNIT(id)                                         \
+    int sum_##id(int *data, int n) {                                \
+        int s = 0;                                                  \
+        for (int i = 0; i < n; ++i) {                               \
+            if (data[i] > 0)                                        \
+                s += data[i];                                       \
+            else                                                    \
+                s -= data[i];                                       \
+        }                                                           \
+        return s;                                                   \
+    }                                                               \
+                                                                    \
+    int classify_##id(int x) {                                      \
+        switch (x) {                                                \
+            case 0: return 1;                                       \
+            case 1:                                                 \
+            case 2: return 2;                                       \
+            default: break;                                         \
+        }                                                           \
+        return 3;                                                   \
+    }                                                               \
+                                                                    \
+    int search_##id(int key) {                                      \
+        int table[16];                                              \
+        int i = 0;                                                  \
+        while (i < 16) {                                            \
+            table[i] = i * i;                                       \
+            ++i;                                                    \
+        }                                                           \
+        int found = -1;                                             \
+        do {                                                        \
+            --i;                                                    \
+            if (table[i] == key)                                    \
+                found = i;                                          \
+        } while (i > 0 && found < 0);                               \
+        return found + classify_##id(found) + sum_##id(table, 16);  \
+    }
@@ -0,0 +1,479 @@
+// Copyright (c) 2022-present, Trail of Bits, Inc.
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/Stack.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+#include <mlir/IR/Dialect.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/InitAllDialects.h>
+#include <mlir/InitAllPasses.h>
+#include <mlir/Parser/Parser.h>
+#include <mlir/Pass/PassManager.h>
+#include <mlir/Pass/PassRegistry.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/InitLLVM.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/ManagedStatic.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Regex.h>
+#include <llvm/Support/raw_ostream.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Translation/CodeGen.hpp"
+#include "vast/Util/Common.hpp"
+#include "vast/Util/IRStatistics.hpp"
+#include "vast/Util/Symbols.hpp"
+
+#include <chrono>
+#include <ctime>
+
+namespace vast::cl
+{
+    namespace cl = llvm::cl;
+
+    // clang-format off
+    struct vast_bench_options {
+        cl::opt< std::string > corpus{ "corpus",
+            cl::desc("Directory of the benchmark corpus"),
+            cl::value_desc("directory"),
+            cl::init(VAST_BENCH_CORPUS_DIR)
+        };
+        cl::list< unsigned > scales{ "scales",
+            cl::desc("Numbers of units instantiated from every file of the corpus"),
+            cl::CommaSeparated
+        };
+        cl::opt< unsigned > min_iterations{ "min-iterations",
+            cl::desc("Minimal number of iterations of a benchmark"),
+            cl::init(3)
+        };
+        cl::opt< unsigned > min_time{ "min-time",
+            cl::desc("Minimal measured time of a benchmark in milliseconds"),
+            cl::init(200)
+        };
+        cl::opt< std::string > filter{ "filter",
+            cl::desc("Run only benchmarks with names matching the regex"),
+            cl::init("")
+        };
+        cl::opt< std::string > json{ "json",
+            cl::desc("Write results as json to the file"),
+            cl::value_desc("filename"),
+            cl::init("")
+        };
+        cl::list< std::string > compiler_args{ "ccopts",
+            cl::desc("Specify compiler options"),
+            cl::ZeroOrMore
+        };
+    };
+    // clang-format on
+
+    static llvm::ManagedStatic< vast_bench_options > options;
+
+    void register_options() { *options; }
+} // namespace vast::cl
+
+namespace vast::bench
+{
+    using clock    = std::chrono::steady_clock;
+    using duration = clock::duration;
+
+    using ast_unit = std::unique_ptr< clang::ASTUnit >;
+
+    //
+    // result
+    //
+    // Measurements of a single benchmark. Operations are the number of
+    // high-level operations of the benchmarked module, so that throughput of
+    // all stages of the pipeline is comparable.
+    //
+    struct result {
+        std::string name;
+        uint64_t iterations = 0;
+        duration real_time  = {};
+        double cpu_time_ns  = 0;
+        uint64_t ops        = 0;
+        uint64_t peak_rss_kb = 0;
+        std::string error;
+
+        double real_time_ns() const {
+            return iterations ? double(std::chrono::nanoseconds(real_time).count()) / iterations : 0;
+        }
+
+        double ops_per_second() const {
+            auto ns = real_time_ns();
+            return ns > 0 ? double(ops) * 1e9 / ns : 0;
+        }
+    };
+
+    // Measured part of an iteration, or an error that stops the benchmark.
+    using iteration = llvm::Expected< duration >;
+
+    struct runner {
+        std::vector< result > results;
+        llvm::Regex filter;
+
+        explicit runner(llvm::StringRef pattern) : filter(pattern) {}
+
+        bool enabled(llvm::StringRef name) const {
+            return cl::options->filter.empty() || filter.match(name);
+        }
+
+        // Runs the body until both the minimal number of iterations and the
+        // minimal time are reached, setup done by the body is not measured.
+        template< typename Body >
+        void run(llvm::StringRef name, uint64_t ops, Body &&body) {
+            if (!enabled(name)) {
+                return;
+            }
+
+            result res{ .name = name.str(), .ops = ops };
+            auto min_time = std::chrono::milliseconds(cl::options->min_time);
+
+            auto cpu_start = std::clock();
+            while (res.iterations < cl::options->min_iterations || res.real_time < min_time) {
+                auto time = body();
+                if (!time) {
+                    res.error = llvm::toString(time.takeError());
+                    break;
+                }
+                res.real_time += *time;
+                ++res.iterations;
+            }
+            auto cpu = double(std::clock() - cpu_start) / CLOCKS_PER_SEC * 1e9;
+            res.cpu_time_ns = res.iterations ? cpu / res.iterations : 0;
+            res.peak_rss_kb = util::peak_rss_kb();
+
+            report(res);
+            results.push_back(std::move(res));
+        }
+
+        static void report(const result &res) {
+            if (!res.error.empty()) {
+                llvm::outs() << llvm::format("%-56s error: %s\n", res.name.c_str(), res.error.c_str());
+                return;
+            }
+
+            llvm::outs() << llvm::format("%-56s %10llu %14.0f ns %14.0f ops/s %10llu KB\n",
+                res.name.c_str(), (unsigned long long)res.iterations,
+                res.real_time_ns(), res.ops_per_second(), (unsigned long long)res.peak_rss_kb
+            );
+        }
+    };
+
+    template< typename Body >
+    duration timed(Body &&body) {
+        auto start = clock::now();
+        body();
+        return clock::now() - start;
+    }
+
+    llvm::Error error(llvm::Twine msg) {
+        return llvm::createStringError(llvm::inconvertibleErrorCode(), msg);
+    }
+
+    std::unique_ptr< MContext > make_context() {
+        mlir::DialectRegistry registry;
+        vast::registerAllDialects(registry);
+        mlir::registerAllDialects(registry);
+
+        auto mctx = std::make_unique< MContext >(registry);
+        mctx->loadAllAvailableDialects();
+        // Measures a single thread, nested passes would run in parallel.
+        mctx->disableMultithreading();
+        return mctx;
+    }
+
+    ast_unit parse_source(llvm::StringRef source) {
+        std::vector< std::string > args(cl::options->compiler_args.begin(), cl::options->compiler_args.end());
+        if (args.empty()) {
+            args.push_back("-xc");
+        }
+        return clang::tooling::buildASTFromCodeWithArgs(source, args);
+    }
+
+    uint64_t count_ops(mlir::Operation *root) {
+        uint64_t ops = 0;
+        root->walk([&] (mlir::Operation *) { ++ops; });
+        return ops;
+    }
+
+    // Instantiates units of a corpus file, see `corpus/*.c`.
+    std::string scaled_source(llvm::StringRef source, unsigned scale) {
+        std::string result = source.str();
+        for (unsigned unit = 0; unit < scale; ++unit) {
+            result += llvm::formatv("VAST_BENCH_UNIT({0})\n", unit).str();
+        }
+        return result;
+    }
+
+    //
+    // Stages of the pipeline benchmarked on a single scaled source.
+    //
+    struct workload {
+        runner &bench;
+        std::string prefix;
+        std::string source;
+
+        std::string name(llvm::StringRef stage) const {
+            return llvm::formatv("{0}/{1}", stage, prefix).str();
+        }
+
+        void run() {
+            auto ast = parse_source(source);
+            if (!ast) {
+                llvm::errs() << "error: unable to parse " << prefix << "\n";
+                return;
+            }
+
+            auto mctx = make_context();
+            auto mod = hl::DefaultCodeGen(&ast->getASTContext(), mctx.get()).emit_module(ast.get());
+            auto ops = count_ops(mod.get());
+
+            bench.run(name("parse"), ops, [&] () -> iteration {
+                ast_unit unit;
+                auto time = timed([&] { unit = parse_source(source); });
+                if (!unit)
+                    return error("clang parse failed");
+                return time;
+            });
+
+            codegen< hl::DefaultCodeGen<> >("codegen/default", *ast, ops);
+            codegen< hl::CodeGenWithMetaIDs >("codegen/meta-ids", *ast, ops);
+
+            lowering("lower-types", "", "vast-hl-lower-types", *mctx, mod.get(), ops);
+            lowering("to-scf", "vast-hl-lower-types", "vast-hl-to-scf", *mctx, mod.get(), ops);
+            lowering("to-ll", "vast-hl-lower-types", "vast-hl-to-ll", *mctx, mod.get(), ops);
+            export_fn_info(*mctx, mod.get(), ops);
+
+            print_and_parse(*mctx, mod.get(), ops);
+            query(mod.get(), ops);
+        }
+
+        // Every iteration emits into a fresh context, as uniqued types and
+        // attributes of the previous ones would be reused otherwise.
+        template< typename CodeGen >
+        void codegen(llvm::StringRef stage, clang::ASTUnit &ast, uint64_t ops) {
+            bench.run(name(stage), ops, [&] () -> iteration {
+                auto mctx = make_context();
+                CodeGen cg(&ast.getASTContext(), mctx.get());
+                OwningModuleRef result;
+                auto time = timed([&] { result = cg.emit_module(&ast); });
+                if (!result)
+                    return error("codegen failed");
+                return time;
+            });
+        }
+
+        // Runs `pipeline` on a copy of the module prepared by `setup`.
+        void lowering(llvm::StringRef stage, llvm::StringRef setup, llvm::StringRef pipeline,
+                      MContext &mctx, Module mod, uint64_t ops)
+        {
+            bench.run(name(stage), ops, [&] () -> iteration {
+                OwningModuleRef copy(mod.clone());
+
+                std::string diagnostics;
+                llvm::raw_string_ostream errs(diagnostics);
+
+                if (!setup.empty()) {
+                    mlir::PassManager prepare(&mctx);
+                    if (mlir::failed(mlir::parsePassPipeline(setup, prepare, errs)) ||
+                        mlir::failed(prepare.run(copy.get())))
+                        return error("setup '" + setup + "' failed " + errs.str());
+                }
+
+                mlir::PassManager pm(&mctx);
+                if (mlir::failed(mlir::parsePassPipeline(pipeline, pm, errs)))
+                    return error("invalid pipeline '" + pipeline + "' " + errs.str());
+
+                mlir::LogicalResult status = mlir::success();
+                auto time = timed([&] { status = pm.run(copy.get()); });
+                if (mlir::failed(status))
+                    return error("pipeline '" + pipeline + "' failed");
+                return time;
+            });
+        }
+
+        void export_fn_info(MContext &mctx, Module mod, uint64_t ops) {
+            llvm::SmallString< 128 > path;
+            if (llvm::sys::fs::createTemporaryFile("vast-bench", "json", path)) {
+                return;
+            }
+            llvm::FileRemover remover(path);
+
+            auto pipeline = llvm::formatv("vast-export-fn-info{{o={0}}", path).str();
+            lowering("export-fn-info", "", pipeline, mctx, mod, ops);
+        }
+
+        void print_and_parse(MContext &mctx, Module mod, uint64_t ops) {
+            std::string text;
+            bench.run(name("print"), ops, [&] () -> iteration {
+                text.clear();
+                llvm::raw_string_ostream os(text);
+                auto time = timed([&] { mod->print(os); });
+                os.flush();
+                return time;
+            });
+
+            if (text.empty()) {
+                llvm::raw_string_ostream os(text);
+                mod->print(os);
+            }
+
+            bench.run(name("parse-mlir"), ops, [&] () -> iteration {
+                OwningModuleRef parsed;
+                auto time = timed([&] {
+                    parsed = mlir::parseSourceString< mlir::ModuleOp >(text, &mctx);
+                });
+                if (!parsed)
+                    return error("unable to parse printed module");
+                return time;
+            });
+        }
+
+        // Operations of `vast-query`: listing of symbols and users of every
+        // function.
+        void query(Module mod, uint64_t ops) {
+            bench.run(name("query/symbols"), ops, [&] () -> iteration {
+                uint64_t symbols = 0;
+                auto time = timed([&] { util::symbols(mod.getOperation(), [&] (auto) { ++symbols; }); });
+                return time;
+            });
+
+            std::vector< std::string > functions;
+            util::functions(mod, [&] (mlir::func::FuncOp fn) { functions.push_back(fn.getName().str()); });
+
+            bench.run(name("query/symbol-users"), ops, [&] () -> iteration {
+                uint64_t users = 0;
+                auto time = timed([&] {
+                    for (const auto &fn : functions)
+                        util::yield_users(fn, mod.getOperation(), [&] (auto) { ++users; });
+                });
+                return time;
+            });
+        }
+    };
+
+    std::vector< std::string > corpus_files() {
+        std::vector< std::string > files;
+        std::error_code ec;
+        for (llvm::sys::fs::directory_iterator it(cl::options->corpus, ec), end; it != end && !ec; it.increment(ec)) {
+            if (llvm::sys::path::extension(it->path()) == ".c") {
+                files.push_back(it->path());
+            }
+        }
+
+        if (ec) {
+            llvm::errs() << "error: unable to read corpus: " << ec.message() << "\n";
+        }
+
+        llvm::sort(files);
+        return files;
+    }
+
+    llvm::json::Value to_json(const std::vector< result > &results) {
+        llvm::json::Array benchmarks;
+        for (const auto &res : results) {
+            llvm::json::Object entry{
+                { "name", res.name },
+                { "run_name", res.name },
+                { "run_type", "iteration" },
+                { "iterations", int64_t(res.iterations) },
+                { "real_time", res.real_time_ns() },
+                { "cpu_time", res.cpu_time_ns },
+                { "time_unit", "ns" },
+                { "ops", int64_t(res.ops) },
+                { "ops_per_second", res.ops_per_second() },
+                { "peak_rss_kb", int64_t(res.peak_rss_kb) }
+            };
+
+            if (!res.error.empty()) {
+                entry["error_occurred"] = true;
+                entry["error_message"] = res.error;
+            }
+
+            benchmarks.push_back(std::move(entry));
+        }
+
+        llvm::json::Object context{
+            { "executable", "vast-bench" },
+            { "corpus", cl::options->corpus.getValue() },
+            { "min_iterations", int64_t(cl::options->min_iterations) },
+            { "min_time_ms", int64_t(cl::options->min_time) }
+        };
+
+        return llvm::json::Object{
+            { "context", std::move(context) },
+            { "benchmarks", std::move(benchmarks) }
+        };
+    }
+
+    mlir::LogicalResult run() {
+        std::vector< unsigned > scales(cl::options->scales.begin(), cl::options->scales.end());
+        if (scales.empty()) {
+            scales = { 1, 8, 64 };
+        }
+
+        runner bench(cl::options->filter);
+        std::string regex_error;
+        if (!bench.filter.isValid(regex_error)) {
+            llvm::errs() << "error: invalid filter: " << regex_error << "\n";
+            return mlir::failure();
+        }
+
+        auto files = corpus_files();
+        if (files.empty()) {
+            llvm::errs() << "error: empty corpus " << cl::options->corpus << "\n";
+            return mlir::failure();
+        }
+
+        for (const auto &file : files) {
+            auto buffer = llvm::MemoryBuffer::getFile(file);
+            if (!buffer) {
+                llvm::errs() << "error: unable to read " << file << "\n";
+                return mlir::failure();
+            }
+
+            for (auto scale : scales) {
+                auto prefix = llvm::formatv("{0}/{1}", llvm::sys::path::filename(file), scale).str();
+                workload{ bench, prefix, scaled_source((*buffer)->getBuffer(), scale) }.run();
+            }
+        }
+
+        if (!cl::options->json.empty()) {
+            std::error_code ec;
+            llvm::raw_fd_ostream out(cl::options->json, ec, llvm::sys::fs::OF_Text);
+            if (ec) {
+                llvm::errs() << "error: unable to write results: " << ec.message() << "\n";
+                return mlir::failure();
+            }
+            out << llvm::formatv("{0:2}", to_json(bench.results)) << "\n";
+        }
+
+        bool failed = llvm::any_of(bench.results, [] (const auto &res) { return !res.error.empty(); });
+        return mlir::failure(failed);
+    }
+
+} // namespace vast::bench
+
+int main(int argc, char **argv) {
+    llvm::InitLLVM init(argc, argv);
+    clang::noteBottomOfStack();
+
+    mlir::registerAllPasses();
+    vast::hl::registerPasses();
+
+    vast::cl::register_options();
+    llvm::cl::ParseCommandLineOptions(argc, argv, "VAST codegen and lowering benchmarks\n");
+
+    return mlir::failed(vast::bench::run());
+}
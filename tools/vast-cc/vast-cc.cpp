@@ -2,11 +2,13 @@
 
 #include <vast/Translation/Register.hpp>
 
+#include <clang/Basic/Stack.h>
 #include <mlir/Support/LogicalResult.h>
 #include <mlir/Tools/mlir-translate/MlirTranslateMain.h>
 
 int main(int argc, char **argv)
 {
+    clang::noteBottomOfStack();
     vast::registerAllTranslations();
 
     return failed(
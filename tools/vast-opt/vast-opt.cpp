@@ -3,13 +3,17 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/IR/AsmState.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Pass/PassRegistry.h"
+#include "mlir/Support/DebugCounter.h"
 #include "mlir/Support/FileUtilities.h"
+#include "mlir/Support/Timing.h"
 #include "mlir/Tools/mlir-opt/MlirOptMain.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/InitLLVM.h"
@@ -19,6 +23,84 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/HighLevel/Passes.hpp"
 #include "vast/Dialect/Dialects.hpp"
+#include "vast/Util/IRStatistics.hpp"
+#include "vast/Util/MemoryReport.hpp"
+
+namespace cl = llvm::cl;
+
+namespace
+{
+    enum class ir_stats_mode { none, text, json };
+
+    // Options of `mlir::MlirOptMain(argc, argv, ...)`, which offers no hook to
+    // instrument the pass managers it creates, hence the driver parses them
+    // itself and instruments pass managers through the setup callback of the
+    // buffer entry point.
+    struct opt_options {
+        cl::opt< std::string > input_filename{
+            cl::Positional, cl::desc("<input file>"), cl::init("-")
+        };
+
+        cl::opt< std::string > output_filename{
+            "o", cl::desc("Output filename"), cl::value_desc("filename"), cl::init("-")
+        };
+
+        cl::opt< bool > split_input_file{
+            "split-input-file",
+            cl::desc("Split the input file into pieces and process each chunk independently"),
+            cl::init(false)
+        };
+
+        cl::opt< bool > verify_diagnostics{
+            "verify-diagnostics",
+            cl::desc("Check that emitted diagnostics match expected-* lines on the corresponding line"),
+            cl::init(false)
+        };
+
+        cl::opt< bool > verify_passes{
+            "verify-each", cl::desc("Run the verifier after each transformation pass"), cl::init(true)
+        };
+
+        cl::opt< bool > allow_unregistered_dialects{
+            "allow-unregistered-dialect",
+            cl::desc("Allow operation with no registered dialects"), cl::init(false)
+        };
+
+        cl::opt< bool > show_dialects{
+            "show-dialects", cl::desc("Print the list of registered dialects"), cl::init(false)
+        };
+
+        cl::opt< ir_stats_mode > ir_stats{
+            "vast-ir-stats",
+            cl::desc("Report operations per dialect and per name and peak memory around each pass"),
+            cl::init(ir_stats_mode::none),
+            cl::values(
+                clEnumValN(ir_stats_mode::text, "text", "human readable table"),
+                clEnumValN(ir_stats_mode::json, "json", "json array of passes")
+            )
+        };
+
+        cl::opt< bool > memory_report{
+            "memory-report",
+            cl::desc("Print uniqued objects and operations kept alive by the module after the pipeline")
+        };
+
+        cl::opt< std::string > ir_stats_file{
+            "vast-ir-stats-file",
+            cl::desc("Write the report of -vast-ir-stats to the file instead of stderr"),
+            cl::value_desc("filename")
+        };
+    };
+
+    std::string help_header(const mlir::DialectRegistry &registry)
+    {
+        std::string header = "VAST Optimizer driver\nAvailable Dialects: ";
+        llvm::raw_string_ostream os(header);
+        llvm::interleaveComma(registry.getDialectNames(), os);
+        return os.str();
+    }
+
+} // namespace
 
 int main(int argc, char **argv)
 {
@@ -29,7 +111,93 @@ int main(int argc, char **argv)
     mlir::DialectRegistry registry;
     vast::registerAllDialects(registry);
     mlir::registerAllDialects(registry);
-    return failed(
-        mlir::MlirOptMain(argc, argv, "VAST Optimizer driver\n", registry)
+
+    llvm::InitLLVM init(argc, argv);
+
+    opt_options opts;
+
+    mlir::registerAsmPrinterCLOptions();
+    mlir::registerMLIRContextCLOptions();
+    mlir::registerPassManagerCLOptions();
+    mlir::registerDefaultTimingManagerCLOptions();
+    mlir::DebugCounter::registerCLOptions();
+    mlir::PassPipelineCLParser pass_pipeline("", "Compiler passes to run", "p");
+
+    cl::ParseCommandLineOptions(argc, argv, help_header(registry));
+
+    if (opts.show_dialects) {
+        llvm::outs() << "Available Dialects:\n";
+        llvm::interleave(registry.getDialectNames(), llvm::outs(), "\n");
+        return 0;
+    }
+
+    std::string error;
+    auto input = mlir::openInputFile(opts.input_filename, &error);
+    if (!input) {
+        llvm::errs() << error << "\n";
+        return 1;
+    }
+
+    auto output = mlir::openOutputFile(opts.output_filename, &error);
+    if (!output) {
+        llvm::errs() << error << "\n";
+        return 1;
+    }
+
+    // A pass manager is created per chunk of a split input, their
+    // instrumentations record into the same statistics, which are reported
+    // once all chunks are processed.
+    vast::util::ir_statistics stats;
+    std::unique_ptr< llvm::ToolOutputFile > stats_output;
+    if (opts.ir_stats != ir_stats_mode::none && !opts.ir_stats_file.empty()) {
+        stats_output = mlir::openOutputFile(opts.ir_stats_file, &error);
+        if (!stats_output) {
+            llvm::errs() << error << "\n";
+            return 1;
+        }
+    }
+
+    auto setup = [&] (mlir::PassManager &pm) -> mlir::LogicalResult {
+        if (opts.ir_stats != ir_stats_mode::none) {
+            pm.addInstrumentation(
+                std::make_unique< vast::util::ir_statistics_instrumentation >(stats)
+            );
+        }
+
+        if (opts.memory_report) {
+            pm.addInstrumentation(
+                std::make_unique< vast::util::memory_report_instrumentation >(llvm::errs())
+            );
+        }
+
+        auto error_handler = [&] (const llvm::Twine &msg) {
+            mlir::emitError(mlir::UnknownLoc::get(pm.getContext())) << msg;
+            return mlir::failure();
+        };
+        return pass_pipeline.addToPipeline(pm, error_handler);
+    };
+
+    auto result = mlir::MlirOptMain(
+        output->os(), std::move(input), setup, registry,
+        opts.split_input_file, opts.verify_diagnostics, opts.verify_passes,
+        opts.allow_unregistered_dialects
     );
+
+    // Statistics of failed passes are reported as well.
+    if (opts.ir_stats != ir_stats_mode::none) {
+        auto format = opts.ir_stats == ir_stats_mode::json
+            ? vast::util::ir_statistics_format::json
+            : vast::util::ir_statistics_format::text;
+        stats.print(stats_output ? stats_output->os() : llvm::errs(), format);
+        if (stats_output) {
+            stats_output->keep();
+        }
+    }
+
+    if (mlir::failed(result)) {
+        return 1;
+    }
+
+    output->keep();
+    return 0;
 }
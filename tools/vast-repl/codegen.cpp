@@ -7,18 +7,70 @@
 
 #include "vast/Translation/CodeGen.hpp"
 
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/CompilerInvocation.h>
+#include <clang/Lex/Lexer.h>
+#include <clang/Serialization/ASTReader.h>
+#include <clang/Serialization/ModuleFile.h>
+#include <clang/Serialization/PCHContainerOperations.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/xxhash.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/Dialect/Func/IR/FuncOps.h>
+#include <mlir/IR/SymbolTable.h>
+VAST_UNRELAX_WARNINGS
+
 #include <fstream>
+#include <vector>
 
 namespace vast::repl::codegen {
 
+    static constexpr const char *source_name = "input.cc";
+
     std::string slurp(std::ifstream& in) {
         std::ostringstream sstr;
         sstr << in.rdbuf();
         return sstr.str();
     }
 
+    static std::vector< clang::ASTUnit::RemappedFile > remapped_source(const std::string &source) {
+        // The unit takes ownership of remapped buffers.
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(source, source_name);
+        return { { source_name, buffer.release() } };
+    }
+
     std::unique_ptr< clang::ASTUnit > ast_from_source(const std::string &source) {
-        return clang::tooling::buildASTFromCode(source);
+        std::vector< const char * > args = { "clang", "-fsyntax-only", source_name };
+
+        // Builtin headers are located the same way as by clang tooling.
+        static int anchor;
+        auto resources = clang::CompilerInvocation::GetResourcesPath("clang-tool", &anchor);
+
+        auto diags = clang::CompilerInstance::createDiagnostics(new clang::DiagnosticOptions());
+        std::unique_ptr< clang::ASTUnit > unit(clang::ASTUnit::LoadFromCommandLine(
+            args.data(), args.data() + args.size(),
+            std::make_shared< clang::PCHContainerOperations >(), diags, resources,
+            /* OnlyLocalDecls */ false,
+            clang::CaptureDiagsKind::None,
+            remapped_source(source),
+            /* RemappedFilesKeepOriginalName */ true,
+            /* PrecompilePreambleAfterNParses */ 1
+        ));
+
+        if (!unit) {
+            throw std::runtime_error("error: unable to parse source");
+        }
+
+        return unit;
+    }
+
+    void reparse(clang::ASTUnit &unit, const std::string &source) {
+        auto pch = std::make_shared< clang::PCHContainerOperations >();
+        if (unit.Reparse(pch, remapped_source(source))) {
+            throw std::runtime_error("error: unable to parse source");
+        }
     }
 
     std::string get_source(std::filesystem::path source) {
@@ -26,11 +78,182 @@ namespace vast::repl::codegen {
         return slurp(in);
     }
 
-    owning_module_ref emit_module(const std::string &source, MContext *mctx) {
-        auto unit = codegen::ast_from_source(source);
-        auto &actx = unit->getASTContext();
+    owning_module_ref emit_module(clang::ASTUnit &unit, MContext *mctx) {
+        auto &actx = unit.getASTContext();
         vast::hl::DefaultCodeGen codegen(&actx, mctx);
         return codegen.emit_module(actx.getTranslationUnitDecl());
     }
 
+    template< typename Yield >
+    static void function_definitions(clang::ASTUnit &unit, Yield &&yield) {
+        for (auto it = unit.top_level_begin(); it != unit.top_level_end(); ++it) {
+            auto fn = llvm::dyn_cast< clang::FunctionDecl >(*it);
+            if (fn && fn->getIdentifier() && fn->doesThisDeclarationHaveABody()) {
+                yield(fn);
+            }
+        }
+    }
+
+    // Appends names, sizes and modification times of files included by the
+    // source, either directly or through the precompiled preamble.
+    static void included_files(clang::ASTUnit &unit, std::string &out) {
+        auto add = [&] (const clang::FileEntry *file) {
+            if (!file || llvm::sys::path::filename(file->getName()) == source_name) {
+                return;
+            }
+
+            out += file->getName().str();
+            out += ':' + std::to_string(file->getSize());
+            out += ':' + std::to_string(file->getModificationTime()) + '\n';
+        };
+
+        const auto &sm = unit.getSourceManager();
+        for (unsigned i = 0; i < sm.local_sloc_entry_size(); ++i) {
+            const auto &entry = sm.getLocalSLocEntry(i);
+            if (entry.isFile()) {
+                add(entry.getFile().getContentCache().OrigEntry);
+            }
+        }
+
+        if (auto reader = unit.getASTReader()) {
+            for (auto &mf : reader->getModuleManager()) {
+                reader->visitInputFiles(mf, /* IncludeSystem */ true, /* Complain */ false,
+                    [&] (const clang::serialization::InputFile &input, bool /* system */) {
+                        add(input.getFile());
+                    }
+                );
+            }
+        }
+    }
+
+    fingerprint take_fingerprint(clang::ASTUnit &unit) {
+        const auto &sm = unit.getSourceManager();
+        const auto &lo = unit.getLangOpts();
+        auto text = sm.getBufferData(sm.getMainFileID());
+
+        fingerprint result;
+        std::string skeleton;
+        unsigned last = 0;
+
+        function_definitions(unit, [&] (const clang::FunctionDecl *fn) {
+            auto range = sm.getExpansionRange(fn->getBody()->getSourceRange());
+            auto begin = range.getBegin();
+            auto end   = range.isTokenRange()
+                ? clang::Lexer::getLocForEndOfToken(range.getEnd(), 0, sm, lo)
+                : range.getEnd();
+
+            // Bodies outside of the source, e.g., in headers, are covered
+            // by the state of included files.
+            if (!sm.isWrittenInMainFile(begin) || !sm.isWrittenInMainFile(end)) {
+                return;
+            }
+
+            auto from = sm.getFileOffset(begin);
+            auto to   = sm.getFileOffset(end);
+            if (from < last || to < from) {
+                return;
+            }
+
+            skeleton.append(text.begin() + last, text.begin() + from);
+            skeleton.append("{}");
+            result.bodies[fn->getName()] = llvm::xxHash64(text.slice(from, to));
+            last = to;
+        });
+
+        skeleton.append(text.begin() + last, text.end());
+        included_files(unit, skeleton);
+        result.skeleton = llvm::xxHash64(skeleton);
+        return result;
+    }
+
+    std::optional< llvm::StringSet<> > changed_functions(
+        const fingerprint &before, const fingerprint &after
+    ) {
+        if (before.skeleton != after.skeleton) {
+            return std::nullopt;
+        }
+
+        llvm::StringSet<> changed;
+        for (const auto &body : after.bodies) {
+            auto it = before.bodies.find(body.getKey());
+            if (it == before.bodies.end() || it->getValue() != body.getValue()) {
+                changed.insert(body.getKey());
+            }
+        }
+
+        return changed;
+    }
+
+    // Keeps entries of the module and adds the ones of types that appear
+    // only in the newly emitted functions.
+    static void merge_data_layout(Module into, Module from) {
+        auto name  = mlir::DLTIDialect::kDataLayoutAttrName;
+        auto fresh = from->getAttrOfType< mlir::DataLayoutSpecAttr >(name);
+        auto old   = into->getAttrOfType< mlir::DataLayoutSpecAttr >(name);
+        if (!fresh || !old) {
+            return;
+        }
+
+        llvm::SmallVector< mlir::DataLayoutEntryInterface > entries(
+            old.getEntries().begin(), old.getEntries().end()
+        );
+
+        for (auto entry : fresh.getEntries()) {
+            auto known = llvm::any_of(entries, [&] (auto present) {
+                return present.getKey() == entry.getKey();
+            });
+
+            if (!known) {
+                entries.push_back(entry);
+            }
+        }
+
+        into->setAttr(name, mlir::DataLayoutSpecAttr::get(into.getContext(), entries));
+    }
+
+    mlir::LogicalResult emit_functions(
+        clang::ASTUnit &unit, MContext *mctx, Module mod, const llvm::StringSet<> &names
+    ) {
+        if (names.empty()) {
+            return mlir::success();
+        }
+
+        auto &actx = unit.getASTContext();
+        vast::hl::DefaultCodeGen codegen(&actx, mctx);
+
+        // Bodies of other functions are already present in the module.
+        function_definitions(unit, [&] (const clang::FunctionDecl *fn) {
+            if (!names.contains(fn->getName())) {
+                codegen.emit_as_declaration(fn);
+            }
+        });
+
+        auto fresh = codegen.emit_module(actx.getTranslationUnitDecl());
+
+        mlir::SymbolTable from(fresh.get());
+        mlir::SymbolTable into(mod);
+
+        // The module is left untouched unless all functions can be replaced.
+        std::vector< std::pair< mlir::func::FuncOp, mlir::func::FuncOp > > replacements;
+        for (const auto &name : names) {
+            auto fn  = from.lookup< mlir::func::FuncOp >(name.getKey());
+            auto old = into.lookup< mlir::func::FuncOp >(name.getKey());
+            if (!fn || !old) {
+                return mlir::failure();
+            }
+            replacements.emplace_back(fn, old);
+        }
+
+        // The new version takes the place of the old one.
+        for (auto [fn, old] : replacements) {
+            auto pos = std::next(old->getIterator());
+            into.erase(old);
+            fn->remove();
+            into.insert(fn, pos);
+        }
+
+        merge_data_layout(mod, fresh.get());
+        return mlir::success();
+    }
+
 } // namespace vast::repl::codegen
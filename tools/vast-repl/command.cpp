@@ -16,11 +16,34 @@ namespace vast::repl::cmd {
         return state.source.value();
     }
 
+    clang::ASTUnit &get_unit(state_t &state) {
+        check_source(state);
+        if (!state.unit) {
+            state.unit = codegen::ast_from_source(state.source.value());
+        }
+        return *state.unit;
+    }
+
     void check_and_emit_module(state_t &state) {
         if (!state.mod) {
-            const auto &source = get_source(state);
-            state.mod = codegen::emit_module(source, &state.ctx);
+            auto &unit    = get_unit(state);
+            state.mod     = codegen::emit_module(unit, &state.ctx);
+            state.emitted = codegen::take_fingerprint(unit);
+        }
+    }
+
+    // Functions whose bodies changed are emitted again and replaced in the
+    // module, any other change of the source, or a function that cannot be
+    // replaced, emits the whole module.
+    void update_module(state_t &state) {
+        auto current = codegen::take_fingerprint(*state.unit);
+        auto changed = codegen::changed_functions(state.emitted, current);
+        if (!changed || mlir::failed(
+                codegen::emit_functions(*state.unit, &state.ctx, state.mod.get(), *changed)))
+        {
+            state.mod = codegen::emit_module(*state.unit, &state.ctx);
         }
+        state.emitted = std::move(current);
     }
 
     //
@@ -43,6 +66,22 @@ namespace vast::repl::cmd {
     void load::run(state_t &state) const {
         auto source  = get_param< source_param >(params);
         state.source = codegen::get_source(source.path);
+
+        if (!state.unit) {
+            return;
+        }
+
+        try {
+            codegen::reparse(*state.unit, state.source.value());
+        } catch (...) {
+            state.unit = nullptr;
+            state.mod  = nullptr;
+            throw;
+        }
+
+        if (state.mod) {
+            update_module(state);
+        }
     };
 
     //
@@ -52,9 +91,9 @@ namespace vast::repl::cmd {
         llvm::outs() << get_source(state) << "\n";
     }
 
-    void show_ast(const state_t &state) {
-        auto unit = codegen::ast_from_source(get_source(state));
-        unit->getASTContext().getTranslationUnitDecl()->dump(llvm::outs());
+    void show_ast(state_t &state) {
+        auto &unit = get_unit(state);
+        unit.getASTContext().getTranslationUnitDecl()->dump(llvm::outs());
         llvm::outs() << "\n";
     }
 
@@ -3,6 +3,7 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "clang/Basic/Stack.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/InitAllDialects.h"
@@ -81,6 +82,8 @@ namespace vast::repl
 } // namespace vast::repl
 
 int main(int argc, char **argv) try {
+    clang::noteBottomOfStack();
+
     mlir::DialectRegistry registry;
     vast::registerAllDialects(registry);
     mlir::registerAllDialects(registry);